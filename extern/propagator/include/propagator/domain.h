@@ -23,6 +23,22 @@
 // forward declaration
 class DomainState;
 
+/**
+ * Bound change recorded (and not applied) while the domain is deferred
+ */
+
+class BoundChange
+{
+public:
+	enum Type { FixUp, FixDown, Lb, Ub };
+	BoundChange(Type t, int j, double v) : type(t), var(j), value(v) {}
+	Type type;
+	int var;
+	double value;
+};
+
+typedef std::vector<BoundChange> BoundChanges;
+
 /**
  * Stores the domains of a set of variables and their info
  */
@@ -55,6 +71,12 @@ public:
 	{
 		DOMINIQS_ASSERT( dominiqs::equal(ub[j], 1.0) );
 		DOMINIQS_ASSERT( type[j] == 'B' );
+		if (deferred)
+		{
+			DOMINIQS_ASSERT( deferredChanges );
+			deferredChanges->emplace_back(BoundChange::FixUp, j, 1.0);
+			return;
+		}
 		lb[j] = 1.0;
 		fixed[j] = true;
 		if (emitFixedBinUp) emitFixedBinUp(j);
@@ -63,6 +85,12 @@ public:
 	{
 		DOMINIQS_ASSERT( dominiqs::equal(lb[j], 0.0) );
 		DOMINIQS_ASSERT( type[j] == 'B' );
+		if (deferred)
+		{
+			DOMINIQS_ASSERT( deferredChanges );
+			deferredChanges->emplace_back(BoundChange::FixDown, j, 0.0);
+			return;
+		}
 		ub[j] = 0.0;
 		fixed[j] = true;
 		if (emitFixedBinDown) emitFixedBinDown(j);
@@ -70,6 +98,12 @@ public:
 	inline void tightenLb(int j, double newValue)
 	{
 		DOMINIQS_ASSERT( type[j] != 'B' );
+		if (deferred)
+		{
+			DOMINIQS_ASSERT( deferredChanges );
+			if (dominiqs::greaterThan(newValue, lb[j])) deferredChanges->emplace_back(BoundChange::Lb, j, newValue);
+			return;
+		}
 		double oldValue = lb[j];
 		newValue = std::min(newValue, ub[j]);
 		if (dominiqs::greaterThan(newValue, oldValue))
@@ -82,6 +116,12 @@ public:
 	inline void tightenUb(int j, double newValue)
 	{
 		DOMINIQS_ASSERT( type[j] != 'B' );
+		if (deferred)
+		{
+			DOMINIQS_ASSERT( deferredChanges );
+			if (dominiqs::lessThan(newValue, ub[j])) deferredChanges->emplace_back(BoundChange::Ub, j, newValue);
+			return;
+		}
 		double oldValue = ub[j];
 		newValue = std::max(newValue, lb[j]);
 		if (dominiqs::lessThan(newValue, oldValue))
@@ -91,6 +131,16 @@ public:
 			if (emitTightenedUb) emitTightenedUb(j, newValue, oldValue);
 		}
 	}
+	/**
+	 * Change the bounds of a variable outside of propagation (i.e., edit the root domain):
+	 * no event is emitted, so the propagators involving the variable must be rebuilt
+	 */
+	inline void resetBounds(int j, double l, double u)
+	{
+		lb[j] = l;
+		ub[j] = u;
+		fixed[j] = dominiqs::equal(l, u);
+	}
 	//@}
 	//@{
 	// callbacks
@@ -100,6 +150,13 @@ public:
 	std::function<void (int, double, double)> emitTightenedUb;
 	//@}
 	StatePtr getStateMgr();
+	/**
+	 * Deferred mode (parallel bulk propagation): the domain is read-only and the setters
+	 * record the bound changes in the list of the calling thread (deferredChanges) instead
+	 * of applying them, without emitting any event
+	 */
+	bool deferred = false;
+	static thread_local BoundChanges* deferredChanges;
 protected:
 	friend class DomainState;
 	std::vector<std::string> names;
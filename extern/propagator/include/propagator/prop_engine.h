@@ -15,6 +15,7 @@
 #include <deque>
 #include <string>
 #include <iosfwd>
+#include <cstdint>
 
 #include <utils/singleton.h>
 #include <utils/factory.h>
@@ -38,6 +39,20 @@ public:
 	double value;
 };
 
+/**
+ * @brief Propagation statistics
+ * Cumulative counters, reset with PropagationEngine::resetStats()
+ */
+
+class PropagationStats
+{
+public:
+	uint64_t decisions = 0; //< number of branching decisions propagated
+	uint64_t propagatorCalls = 0; //< number of Propagator::propagate() calls
+	uint64_t advisorEvents = 0; //< number of advisor notifications (bound changes x advisors)
+	uint64_t bulkRounds = 0; //< number of parallel rounds of bulk propagation
+};
+
 /**
  * Propagation Engine
  * Coordinates propagators actions, advisors and store the var domains
@@ -51,17 +66,48 @@ public:
 	inline DomainPtr getDomain() { return domain; }
 	void setDomain(DomainPtr d);
 	virtual void pushPropagator(PropagatorPtr prop);
+	/**
+	 * Replace the propagator with the given id (e.g., after its constraint has been edited):
+	 * the advisors of the old propagator are removed and those of the new one are added.
+	 * If prop is null, the old propagator is just removed (its id is not reused).
+	 * State managers obtained before the call are invalidated.
+	 */
+	virtual void replacePropagator(int id, PropagatorPtr prop);
+	/** advisors listening to the domain changes of variable j */
+	const std::vector<AdvisorPtr>& getAdvisors(int j) const { return advisors[j]; }
+	/** mark all the propagators as pending (e.g., to propagate from scratch after a state restore) */
+	void schedulePropagators();
 	virtual bool propagate();
+	/**
+	 * Propagate the pending propagators (e.g., all of them at the root), with at most
+	 * workLimit propagator calls (0 = no limit): what is left is propagated with the next decision.
+	 * Uses bulk propagation (see bulkThreads).
+	 * @return false if infeasible
+	 */
+	bool fixpoint(uint64_t workLimit);
 	virtual bool propagate(int var, double value);
+	/** propagate several decisions at once (uses bulk propagation, see bulkThreads) */
 	virtual bool propagate(const std::vector<int>& vars, const std::vector<double>& values);
 	const std::vector<int>& getLastFixed() const { return lastFixed; }
 	bool failed() const { return hasFailed; }
+	// statistics
+	const PropagationStats& getStats() const { return stats; }
+	void resetStats() { stats = PropagationStats(); }
 	// state handler
 	StatePtr getStateMgr();
 	// remove everything (advisors, propagators...)
 	virtual void clear();
 	// options
 	bool stopPropagationIfFailed;
+	/**
+	 * Bulk (Jacobi) propagation: the pending propagators are run in rounds, each round in parallel
+	 * on bulkThreads threads (0 = one per core, 1 = sequential propagation) against the domain as it was
+	 * at the start of the round; the bound changes are then merged in queue order, so that the result
+	 * does not depend on the number of threads. Rounds are used only while at least bulkMinRound
+	 * propagators are pending: the rest is propagated sequentially.
+	 */
+	int bulkThreads = 1;
+	int bulkMinRound = 1024;
 protected:
 	// signal handlers
 	void fixedBinUp(int j);
@@ -83,9 +129,13 @@ protected:
 	std::vector<Decision> decisions;
 	std::vector<int> lastFixed;
 	bool hasFailed;
+	PropagationStats stats;
 	// helper
 	PropagatorPtr top();
-   void loop();
+   void loop(uint64_t workLimit = 0);
+	void bulkLoop(uint64_t workLimit = 0);
+	/** apply a bound change of a bulk round: @return false if it conflicts with the current domain */
+	bool applyChange(const BoundChange& change);
 };
 
 #endif /* PROP_ENGINE_H */
@@ -10,6 +10,8 @@
 
 using namespace dominiqs;
 
+thread_local BoundChanges* Domain::deferredChanges = nullptr;
+
 void Domain::pushVar(const std::string& name, char t, double l, double u)
 {
 	names.push_back(name);
@@ -8,7 +8,11 @@
  */
 
 #include <functional>
+#include <algorithm>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <exception>
 
 #include <utils/floats.h>
 
@@ -25,6 +29,7 @@ public:
 		domainState = engine.domain->getStateMgr();
 		for (PropagatorPtr p: engine.propagators)
 		{
+			if (!p) continue; // removed
 			StatePtr ps = p->getStateMgr();
 			if (ps) propState.push_back(ps);
 		}
@@ -95,19 +100,169 @@ void PropagationEngine::pushPropagator(PropagatorPtr prop)
 	for (AdvisorPtr adv: advs) advisors[adv->getVar()].push_back(adv);
 }
 
-void PropagationEngine::loop()
+void PropagationEngine::replacePropagator(int id, PropagatorPtr prop)
+{
+	DOMINIQS_ASSERT( (id >= 0) && (id < (int)propagators.size()) );
+	PropagatorPtr old = propagators[id];
+	if (old)
+	{
+		// the advisors of the old propagator tell us which variables it was listening to
+		std::vector<AdvisorPtr> advs;
+		old->createAdvisors(advs);
+		for (AdvisorPtr adv: advs)
+		{
+			std::vector<AdvisorPtr>& varAdvs = advisors[adv->getVar()];
+			varAdvs.erase(std::remove_if(varAdvs.begin(), varAdvs.end(),
+				[&old](const AdvisorPtr& a) { return (&(a->getPropagator()) == old.get()); }), varAdvs.end());
+		}
+	}
+	queue.erase(std::remove(queue.begin(), queue.end(), id), queue.end());
+	propagators[id] = prop;
+	if (!prop) return;
+	DOMINIQS_ASSERT( &(prop->getDomain()) == domain.get() );
+	prop->setID(id);
+	if (prop->pending()) queue.push_back(id);
+	std::vector<AdvisorPtr> advs;
+	prop->createAdvisors(advs);
+	for (AdvisorPtr adv: advs) advisors[adv->getVar()].push_back(adv);
+}
+
+void PropagationEngine::schedulePropagators()
+{
+	for (PropagatorPtr prop: propagators)
+	{
+		if (!prop) continue;
+		if (!prop->pending()) queue.push_back(prop->getID());
+		prop->setPending();
+	}
+}
+
+void PropagationEngine::loop(uint64_t workLimit)
 {
 	// propagation loop
+	uint64_t calls = 0;
 	while(true)
 	{
+		if (workLimit && (calls >= workLimit)) break;
 		PropagatorPtr p = top();
 		if (!p) break;
-		if (p->pending()) p->propagate();
+		if (p->pending())
+		{
+			p->propagate();
+			stats.propagatorCalls++;
+			calls++;
+		}
 		if (p->failed()) hasFailed = true;
 		if (stopPropagationIfFailed && hasFailed) break;
 	}
 }
 
+static constexpr int BULK_CHUNK = 64; //< propagators grabbed at once by a thread of a bulk round
+
+void PropagationEngine::bulkLoop(uint64_t workLimit)
+{
+	int numThreads = (bulkThreads > 0) ? bulkThreads : (int)std::thread::hardware_concurrency();
+	uint64_t calls = 0;
+	std::vector<PropagatorPtr> round;
+	std::vector<BoundChanges> changes;
+	std::vector<char> inRound(propagators.size(), 0);
+	while (numThreads > 1)
+	{
+		if (workLimit && (calls >= workLimit)) return;
+		if (stopPropagationIfFailed && hasFailed) return;
+		if ((int)queue.size() < bulkMinRound) break;
+		// collect the round (at most the remaining work)
+		round.clear();
+		while (!queue.empty())
+		{
+			if (workLimit && (calls + round.size() >= workLimit)) break;
+			int id = queue.front();
+			queue.pop_front();
+			PropagatorPtr p = propagators[id];
+			if (!p || !p->pending() || inRound[id]) continue;
+			inRound[id] = 1;
+			round.push_back(p);
+		}
+		if (round.empty()) continue;
+		// parallel propagation on a read-only domain
+		changes.resize(round.size());
+		for (unsigned int k = 0; k < round.size(); k++) changes[k].clear();
+		std::atomic<unsigned int> next(0);
+		std::exception_ptr error;
+		std::atomic_flag errorLock = ATOMIC_FLAG_INIT;
+		auto worker = [&]() {
+			while (true)
+			{
+				unsigned int first = next.fetch_add(BULK_CHUNK);
+				if (first >= round.size()) break;
+				unsigned int last = std::min((unsigned int)round.size(), first + BULK_CHUNK);
+				for (unsigned int k = first; k < last; k++)
+				{
+					Domain::deferredChanges = &changes[k];
+					try
+					{
+						round[k]->propagate();
+					}
+					catch (...)
+					{
+						if (!errorLock.test_and_set()) error = std::current_exception();
+					}
+				}
+			}
+			Domain::deferredChanges = nullptr;
+		};
+		domain->deferred = true;
+		int roundThreads = std::min(numThreads, (int)(round.size() + BULK_CHUNK - 1) / BULK_CHUNK);
+		std::vector<std::thread> threads;
+		for (int t = 1; t < roundThreads; t++) threads.emplace_back(worker);
+		worker();
+		for (std::thread& t: threads) t.join();
+		domain->deferred = false;
+		if (error) std::rethrow_exception(error);
+		stats.propagatorCalls += round.size();
+		stats.bulkRounds++;
+		calls += round.size();
+		// merge (in queue order): advisors are notified and schedule the next round
+		for (unsigned int k = 0; k < round.size(); k++)
+		{
+			inRound[round[k]->getID()] = 0;
+			if (round[k]->failed()) hasFailed = true;
+			for (const BoundChange& c: changes[k])
+			{
+				if (!applyChange(c)) hasFailed = true;
+			}
+		}
+	}
+	// what is left is not worth a parallel round
+	if (workLimit) loop(workLimit - calls);
+	else loop();
+}
+
+bool PropagationEngine::applyChange(const BoundChange& change)
+{
+	int j = change.var;
+	switch (change.type)
+	{
+		case BoundChange::FixUp:
+			if (domain->isVarFixed(j)) return greaterThan(domain->varLb(j), 0.5);
+			domain->fixBinUp(j);
+			break;
+		case BoundChange::FixDown:
+			if (domain->isVarFixed(j)) return lessThan(domain->varUb(j), 0.5);
+			domain->fixBinDown(j);
+			break;
+		case BoundChange::Lb:
+			if (greaterThan(change.value, domain->varUb(j))) return false;
+			domain->tightenLb(j, change.value);
+			break;
+		case BoundChange::Ub:
+			if (lessThan(change.value, domain->varLb(j))) return false;
+			domain->tightenUb(j, change.value);
+			break;
+	}
+	return true;
+}
+
 bool PropagationEngine::propagate()
 {
 	lastFixed.clear();
@@ -115,6 +270,13 @@ bool PropagationEngine::propagate()
 	return (!hasFailed);
 }
 
+bool PropagationEngine::fixpoint(uint64_t workLimit)
+{
+	lastFixed.clear();
+	bulkLoop(workLimit);
+	return (!hasFailed);
+}
+
 bool PropagationEngine::propagate(int var, double value)
 {
 	if (domain->isVarFixed(var)) return true;
@@ -135,6 +297,7 @@ bool PropagationEngine::propagate(int var, double value)
 		}
 	}
 	decisions.push_back(Decision(var, value));
+	stats.decisions++;
 	loop();
 	return (!hasFailed);
 }
@@ -151,6 +314,7 @@ bool PropagationEngine::propagate(const std::vector<int>& vars, const std::vecto
 		var = vars[i];
 		value = values[i];
 		if (domain->isVarFixed(var)) continue;
+		stats.decisions++;
 		if (domain->varType(var) == 'B')
 		{
 			if (isNull(value)) domain->fixBinDown(var);
@@ -167,7 +331,7 @@ bool PropagationEngine::propagate(const std::vector<int>& vars, const std::vecto
 			}
 		}
 	}
-	loop();
+	bulkLoop();
 	return (!hasFailed);
 }
 
@@ -214,6 +378,7 @@ void PropagationEngine::tightenedLb(int j, double newValue, double oldValue)
 	}
 	if (domain->isVarFixed(j) && (domain->varType(j) != 'C')) lastFixed.push_back(j);
 	bool propagateFlag = (domain->isVarFixed(j) || (vPropLbCount[j]++ < MAX_PROP_COUNT));
+	stats.advisorEvents += advisors[j].size();
 	for (AdvisorPtr adv: advisors[j])
 	{
 		Propagator& p = adv->getPropagator();
@@ -235,6 +400,7 @@ void PropagationEngine::tightenedUb(int j, double newValue, double oldValue)
 	}
 	if (domain->isVarFixed(j) && (domain->varType(j) != 'C')) lastFixed.push_back(j);
 	bool propagateFlag = (domain->isVarFixed(j) || (vPropUbCount[j]++ < MAX_PROP_COUNT));
+	stats.advisorEvents += advisors[j].size();
 	for (AdvisorPtr adv: advisors[j])
 	{
 		Propagator& p = adv->getPropagator();
@@ -248,6 +414,7 @@ void PropagationEngine::tightenedUb(int j, double newValue, double oldValue)
 void PropagationEngine::fixedBinUp(int j)
 {
 	lastFixed.push_back(j);
+	stats.advisorEvents += advisors[j].size();
 	for (AdvisorPtr adv: advisors[j])
 	{
 		Propagator& p = adv->getPropagator();
@@ -261,6 +428,7 @@ void PropagationEngine::fixedBinUp(int j)
 void PropagationEngine::fixedBinDown(int j)
 {
 	lastFixed.push_back(j);
+	stats.advisorEvents += advisors[j].size();
 	for (AdvisorPtr adv: advisors[j])
 	{
 		Propagator& p = adv->getPropagator();
@@ -315,9 +315,9 @@ PropagatorPtr VarBoundFactory::analyze(Domain& d, Constraint* c)
 		if (sense == 'L') sense = 'G';
 		else sense = 'L';
 	}
-	xCoef = 1.0;
 	yCoef /= xCoef;
 	double rhs = c->rhs / xCoef;
+	xCoef = 1.0;
    numCreated++;
 	if (sense == 'L') return std::make_shared<VarUpperBoundProp>(d, c->name, xIdx, yIdx, yCoef, rhs);
 	return std::make_shared<VarLowerBoundProp>(d, c->name, xIdx, yIdx, yCoef, rhs);
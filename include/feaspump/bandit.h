@@ -0,0 +1,56 @@
+/**
+ * @file bandit.h
+ * @brief Multi-armed bandit for online operator selection
+ */
+
+#ifndef BANDIT_H
+#define BANDIT_H
+
+#include <vector>
+#include <string>
+
+#include <utils/randgen.h>
+
+enum class BanditPolicy
+{
+	Off,
+	EpsGreedy,
+	UCB
+};
+
+/** Statistics of an operator (arm) */
+struct BanditArm
+{
+	std::string name;
+	int pulls = 0;
+	double totReward = 0.0;
+	double time = 0.0;
+	// discounted statistics (used for the selection)
+	double weight = 0.0;
+	double value = 0.0;
+};
+
+/**
+ * Bandit over a small set of operators.
+ * Rewards are expected in [0,1]. Statistics are discounted at every update,
+ * so that the selection follows the operator that works best in the current phase of the run.
+ */
+
+class Bandit
+{
+public:
+	void init(const std::vector<std::string>& names, BanditPolicy policy, double eps, uint64_t seed);
+	void clear() { arms.clear(); }
+	/** @return the arm to pull next (arms never tried come first) */
+	int select();
+	void update(int arm, double reward, double time);
+	int size() const { return arms.size(); }
+	const BanditArm& arm(int k) const { return arms[k]; }
+private:
+	std::vector<BanditArm> arms;
+	BanditPolicy policy = BanditPolicy::Off;
+	double eps = 0.1;
+	dominiqs::RandGen rnd;
+};
+
+#endif /* BANDIT_H */
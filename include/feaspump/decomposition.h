@@ -0,0 +1,75 @@
+/**
+ * @file decomposition.h
+ * @brief Block decomposition of the constraint graph, with one pump per block
+ */
+
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "mipmodel.h"
+
+namespace dominiqs { class FeasibilityPump; }
+
+/** Connected component of the constraint graph: columns linked by the rows they appear in */
+struct Block
+{
+	std::vector<int> cols;
+	std::vector<int> rows;
+};
+
+/**
+ * Connected components of the constraint graph of model (union-find on the rows).
+ * Blocks with at least one row are returned, largest first; columns that appear in no row go to freeCols.
+ */
+std::vector<Block> findBlocks(const MIPModelI& model, std::vector<int>& freeCols);
+
+
+/**
+ * Feasibility pump on block-diagonal models (independent blocks linked only through the objective):
+ * an independent pump per block, in parallel, on a sub-model with its own LP solver;
+ * the blocks whose pump fails are then solved together by a single pump.
+ * Free columns are set to their best bound w.r.t. the objective.
+ * The pumps are configured from the global config (quietly).
+ */
+
+class DecomposedPump
+{
+public:
+	/** builds an empty model with its own solver environment (sub-models are solved concurrently) */
+	typedef std::function<MIPModelPtr()> ModelFactory;
+	DecomposedPump(ModelFactory factory) : newModel(factory) {}
+	/**
+	 * @return true if model has at least two blocks (otherwise there is no point in decomposing it)
+	 * and no infeasible empty row (those belong to no block: the model is left to the plain pump)
+	 */
+	bool decompose(MIPModelPtr model);
+	/**
+	 * run the block pumps on numThreads threads (<= 0: one per core), then the fallback pump
+	 * @return true if a solution for the whole model was found
+	 */
+	bool pump(int numThreads);
+	const std::vector<double>& solution() const { return x; }
+	void logStats() const;
+	// stats
+	int blockCnt = 0;
+	int failedCnt = 0; //< blocks not solved by their own pump
+	bool fallbackFound = false;
+	double blockTime = 0.0; //< wall clock time of the block pumps
+	double fallbackTime = 0.0;
+private:
+	ModelFactory newModel;
+	MIPModelPtr model;
+	std::vector<Block> blocks;
+	std::vector<int> freeCols;
+	std::vector<double> x;
+	/** sub-model restricted to the given columns and rows (indices of the sub-model follow their order) */
+	MIPModelPtr subModel(const std::vector<int>& cols, const std::vector<int>& rows) const;
+	/** run a pump on sub (restricted to cols) and scatter its solution into x: @return true if it found one */
+	bool pumpModel(dominiqs::FeasibilityPump& fp, MIPModelPtr sub, const std::vector<int>& cols);
+};
+
+#endif /* DECOMPOSITION_H */
@@ -10,16 +10,146 @@
 #define FEASPUMP_H
 
 #include <list>
+#include <deque>
 #include <set>
+#include <atomic>
+#include <future>
+#include <functional>
 
 #include <utils/randgen.h>
 #include <utils/it_display.h>
 #include <utils/timer.h>
 
 #include "fp_interface.h"
+#include "wscache.h"
+#include "polish.h"
+#include "bandit.h"
 
 namespace dominiqs {
 
+/**
+ * How the method of the pumping LPs is chosen:
+ * Fixed uses reOptMethod, Adaptive alternates primal and dual simplex based on their
+ * solve times so far, Race solves each LP with both on two models in parallel.
+ */
+enum class LPStrategy
+{
+	Fixed,
+	Adaptive,
+	Race
+};
+
+/**
+ * Options of the Feasibility Pump.
+ * Each field corresponds to the config key fp.<field> read by FeasibilityPump::readConfig()
+ * (with the exception of seed, which is read from the global key seed).
+ * Options of the rounder are still read from the config by the rounder itself.
+ */
+
+struct FPOptions
+{
+	std::string frac2int = "propround"; //< rounder name
+	char firstOptMethod = 'S'; //< LP method for the initial LP
+	char reOptMethod = 'S'; //< LP method for the pumping LPs
+	bool rootCrossover = true; //< with a barrier initial LP, run crossover (otherwise the pump starts from the interior point)
+	LPStrategy lpStrategy = LPStrategy::Fixed; //< method selection for the pumping LPs
+	BanditPolicy bandit = BanditPolicy::Off; //< online selection of the rounding operator and of the perturbation type ("off", "egreedy", "ucb")
+	double banditEps = 0.1; //< exploration probability of the epsilon-greedy policy
+	double timeLimit = 3600.0;
+	double timeMult = 100.0; //< time limit of the pumping loop as a multiple of the initial LP time (<= 0: none)
+	double lpIterMult = -1.0; //< LP iteration limit per pump LP as a multiple of the initial LP iterations (<= 0: none)
+	int stageIterLimit = 50;
+	int iterLimit = 100;
+	int64_t lpIterBudget = -1; //< work budget: total number of LP iterations (< 0: unlimited)
+	int avgFlips = 20;
+	int tabuTenure = 0; //< perturbations and restarts avoid variables flipped in the last tabuTenure iterations (0 = off)
+	double tabuAspiration = 0.9; //< a tabu variable can still be flipped by a perturbation if its fractionality is at least this
+	double integralityEps = 1e-6;
+	uint64_t seed = 0;
+	double alpha = 0.0;
+	double alphaFactor = 0.9;
+	double alphaDist = 0.005;
+	bool doStage3 = false;
+	bool walksatPerturbe = true;
+	bool randomizeLP = false;
+	bool penaltyObj = false;
+	bool contCompletion = false; //< mixed models: try to complete the integer part of the rounded points by solving for the continuous variables
+	bool polish = false; //< improve every incumbent by 1-opt/2-opt moves (and, on mixed models, an LP in the continuous variables)
+	int numRefs = 0; //< number of recent roundings used as additional reference points of the distance function (0 = off)
+	double refWeight = 0.5; //< weight of the most recent additional reference point (the current rounding has weight 1)
+	double refDecay = 0.5; //< weight decay of older reference points
+	double refBestWeight = 0.0; //< weight of the incumbent (or of the closest point, if none) as additional reference point
+	bool lpCutoff = false; //< stop the distance LPs once they cannot improve on the closest point (the next rounding uses the partial solution)
+	bool workingSet = false; //< distance LPs hold only the rows recently tight or violated (violated rows are added lazily)
+	int workingSetAge = 10; //< working set: rows slack for this many iterations in a row leave the LP
+	bool verbose = true; //< print config, iteration log and results
+	bool handleCtrlC = true; //< catch SIGINT while pumping (disable if the caller has its own handler or runs FP in threads)
+	bool asyncInit = false; //< build the rounder and the row copies on a background thread while the initial LP is solved (root bounds then reach the LP only after it)
+	bool improve = false; //< after a solution is found, keep pumping (objective FP) with an objective cutoff
+	double improveGap = 1e-4; //< relative improvement required by the objective cutoff
+	int poolSize = 10; //< max number of solutions kept in the pool
+	int poolMinDist = 1; //< min number of integer variables with a different value between two pool solutions
+};
+
+/** A solution collected by the pump (see FPOptions::improve) */
+struct FPSolution
+{
+	std::vector<double> x;
+	double objval;
+	double time; //< time at which it was found
+};
+
+/** Snapshot of the pump status at the end of an iteration */
+struct FPIterationInfo
+{
+	int stage;
+	int iteration;
+	double alpha;
+	double origObj; //< original objective of the current fractional point
+	double dist; //< distance between the fractional point and its rounding
+	int numFrac;
+	int64_t lpIter; //< LP iterations so far
+	double time;
+};
+
+/** Status of a (step-wise) pump run */
+enum class FPStatus
+{
+	InProgress, //< call step() again
+	Found, //< a feasible solution has been found
+	NotFound //< stopped without a feasible solution
+};
+
+/**
+ * User callbacks (empty ones are not called).
+ * They are invoked synchronously from the thread running pump().
+ */
+
+struct FPCallbacks
+{
+	std::function<void(const std::vector<double>& x, double objval)> incumbent; //< a feasible solution has been found
+	std::function<void(const FPIterationInfo& info)> iteration; //< end of a pumping iteration
+	std::function<void(int stage, double time)> progress; //< start of a stage (0 is the initial LP)
+};
+
+/**
+ * Cooperative cancellation token: cancel() can be called from any thread,
+ * the pump checks it between LP solves and stops as soon as possible.
+ */
+
+class CancelToken
+{
+public:
+	void cancel() { flag.store(true, std::memory_order_relaxed); }
+	void reset() { flag.store(false, std::memory_order_relaxed); }
+	bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+private:
+	std::atomic<bool> flag{false};
+};
+
+using CancelTokenPtr = std::shared_ptr<CancelToken>;
+
+
 /**
  * @brief Basic Feasibility Pump Scheme
  * Accepts custom rounders
@@ -31,22 +161,59 @@ public:
 	FeasibilityPump();
 	// config
 	void readConfig();
+	/** options as read from the config by readConfig() */
+	static FPOptions configOptions();
+	/** set options directly (alternative to readConfig(): nothing is read from the config except rounder options) */
+	void setOptions(const FPOptions& opts);
+	void setCallbacks(const FPCallbacks& cb) { callbacks = cb; }
+	void setCancelToken(CancelTokenPtr token) { cancelToken = token; }
 	/** init algorithm
 	 * @param env: cplex environment
 	 * @param lp: problem object (this is modified by the algorithm: you may want to pass a copy!)
 	 * @param ctype: if the problem object is an LP, you can provide variable type info with this vector
 	 */
 	void init(MIPModelPtr model, const std::vector<char>& ctype = std::vector<char>());
+	/**
+	 * Incremental alternative to init() after small edits of the model used in the last init():
+	 * the changes are applied to the model, then the cached problem data and the rounder
+	 * are patched instead of being rebuilt. The run state is reset as in init().
+	 */
+	void update(MIPModelPtr model, const ModelChanges& changes);
 	/** pump
 	 * @param xStart: starting fractional solution (will solve LP if empty)
 	 * @param pFeas: primal feasiblity status of supplied vector
 	 */
 	bool pump(const std::vector<double>& xStart = std::vector<double>(), bool pFeas = false);
+	/**
+	 * Step-wise alternative to pump(): start() sets up the run (solving the initial LP if needed),
+	 * then each step() performs at most iterBudget pumping iterations (stage 3 counts as one) and
+	 * returns the current status. All the pump state persists across calls, so that FP can be
+	 * interleaved with other work on the same thread. Time limits only count the time spent
+	 * inside start() and step(). pump() is a loop over step().
+	 */
+	void start(const std::vector<double>& xStart = std::vector<double>(), bool pFeas = false);
+	FPStatus step(int iterBudget = 1);
 	// get solution info
 	bool foundSolution() const;
 	void getSolution(std::vector<double>& x) const;
+	/** @return the incumbent without copying it (valid until the next init/reset) */
+	const std::vector<double>& solution() const;
+	double solutionValue() const { return primalBound; }
 	double getSolutionValue(const std::vector<double>& x) const;
 	int getIterations() const;
+	int64_t getLpIterations() const { return totLpIter; }
+	/** solutions found in the last run, best first (more than one only in improvement mode) */
+	const std::vector<FPSolution>& getPool() const { return pool; }
+	double getTimeToFirst() const { return firstSolTime; }
+	double getTimeToBest() const { return bestSolTime; }
+	/**
+	 * Warm start from a previous run on a similar model (call after init()): the basis is used
+	 * for the initial LP, then the incumbent (if still feasible) or the closest point replace
+	 * the initial LP solution as starting point. Ignored if pump() is given a starting point.
+	 */
+	void setWarmStart(const WarmStart& ws) { warmStart = ws; }
+	/** warm start information collected by the last run (root basis, closest point, incumbent) */
+	void getWarmStart(WarmStart& ws) const;
 	// reset
 	void reset();
 private:
@@ -57,6 +224,8 @@ private:
 	int stageIterLimit;
 	int iterLimit;
 	int avgFlips;
+	int tabuTenure;
+	double tabuAspiration;
 	double integralityEps;
 	uint64_t seed;
 	double alpha;
@@ -66,9 +235,43 @@ private:
 	bool walksatPerturbe;
 	bool randomizeLP;
 	bool penaltyObj;
+	bool contCompletion;
+	bool polish;
+	int numRefs;
+	double refWeight;
+	double refDecay;
+	double refBestWeight;
+	bool lpCutoff;
+	bool workingSet;
+	int workingSetAge;
+	int64_t lpIterBudget;
+	bool verbose;
+	bool handleCtrlC;
+	bool asyncInit;
+	bool improve;
+	double improveGap;
+	int poolSize;
+	int poolMinDist;
 	// LP options
 	char firstOptMethod;
 	char reOptMethod;
+	LPStrategy lpStrategy;
+	BanditPolicy bandit;
+	double banditEps;
+	bool rootCrossover;
+	/** statistics of a simplex method over the pumping LPs (for the adaptive/race strategies) */
+	struct LPMethodStats
+	{
+		int solves = 0;
+		int wins = 0; /**< races won */
+		double time = 0.0;
+		int64_t iters = 0;
+		double avgTime = 0.0; /**< exponential moving average of the solve time */
+	};
+	LPMethodStats lpStats[2]; /**< primal and dual simplex */
+	int lpChoices; /**< number of adaptive choices made */
+	MIPModelPtr racer; /**< concurrent clone racing the pumping LPs: kept until the LP rows or columns change */
+	bool needBasis; /**< the initial LP was solved without crossover: no basis to warm start the next LP from */
 	// FP data
 	MIPModelPtr model;
 	double objOffset;
@@ -78,6 +281,10 @@ private:
 	std::vector<double> integer_x; /**< integer x^~ */
 	typedef std::pair<double, std::vector<double>> AlphaVector;
 	std::list<AlphaVector> lastIntegerX; /**< integer x cache */
+	std::vector<int> lastFlip; /**< flip history: iteration of the last flip of each variable (-1 if never) */
+	std::vector<int> flipCnt; /**< flip history: number of flips of each variable */
+	std::deque<std::vector<signed char>> refPoints; /**< distance signs of the recent roundings on the binaries (newest first) */
+	std::vector<double> refSum; /**< weighted sum of refPoints (one entry per binary) */
 	RandGen rnd;
 	std::vector<double> closestPoint; /**< point closest to feasibility */
 	double closestDist;
@@ -89,21 +296,75 @@ private:
 	std::vector<double> lb; /**< lower bounds */
 	std::vector<double> ub; /**< upper bounds */
 	std::vector<char> xType; /**< column types */
+	std::vector<std::string> xNames; /**< column names */
 	std::vector<bool> fixed; /**< fixed status in the original formulation (usually due to presolve) */
 	std::vector<int> binaries; /**< list of binary vars indexes */
 	std::vector<int> gintegers; /**< list of general integer vars indexes */
 	std::vector<int> integers; /**< list of non continuous vars indexes (binaries + gintegers) */
 	std::vector<ConstraintPtr> rows; /**< constraints of the model */
 	IterationDisplay display;
+	// pump state (persists across step() calls)
+	enum class Phase { Idle, Stage1, Stage2, Stage3, Done };
+	Phase phase;
+	FPStatus status;
+	double runningAlpha;
+	ObjSense origObjSense;
+	double dualBound;
+	int stageStartIter; /**< iteration count at the beginning of the current stage */
+	double pumpTimeLimit;
+	int lpIterLimit;
+	bool stage3Found;
+	std::vector<double> distObj; /**< distance objective (scratch) */
+	std::vector<int> colIndices; /**< column indices for objective changes (scratch) */
+	FPCallbacks callbacks;
+	CancelTokenPtr cancelToken;
+	WarmStart warmStart; /**< user supplied warm start */
+	std::vector<int> rootCStat; /**< root LP basis (columns) */
+	std::vector<int> rootRStat; /**< root LP basis (rows) */
 	// solution
 	bool hasIncumbent;
 	std::vector<double> incumbent; /**< current incumbent */
 	double primalBound;
+	std::vector<FPSolution> pool; /**< solution pool (best first) */
+	int numSols; /**< number of incumbents found */
+	double firstSolTime;
+	double bestSolTime;
+	bool hasObjective; /**< is the original objective nonzero? */
+	int cutoffRow; /**< index of the objective cutoff row in the model (-1 if none) */
+	// working set of the distance LPs (see FPOptions::workingSet)
+	bool wsActive; /**< the LP holds only the working set (until stage 3 or the end of the run) */
+	std::vector<int> wsRows; /**< LP row -> original row (-1 for the objective cutoff), temporary rows excluded */
+	std::vector<char> inLP; /**< original row -> is it in the LP? */
+	std::vector<int> wsAge; /**< original row -> consecutive iterations it has been slack in the LP */
+	std::vector<int> wsPending; /**< rows added by the last separation (they follow the temporary rows of the iteration) */
+	std::vector<double> rowViol; /**< row violations at frac_x (valid if wsViolValid) */
+	bool wsViolValid;
+	std::vector<std::string> wsNames; /**< original row names (to put the rows back) */
 	// stats
 	int firstPerturbation;
 	int pertCnt;
 	int restartCnt;
 	int walksatCnt;
+	int tabuSkips; /**< tabu variables that ended up not flipped by a perturbation or restart */
+	int tabuAspirations; /**< flips of tabu variables done thanks to the aspiration rule */
+	int contChecks; /**< continuous completions attempted */
+	int contFound; /**< continuous completions that gave a feasible solution */
+	MIPModelPtr contLP; /**< LP of the continuous completions: a clone of the model, built at the first one and reused */
+	std::vector<char> contLPHas; /**< working set: rows of rows already in contLP */
+	int wsAdded; /**< rows added lazily to the working set */
+	int wsRemoved; /**< rows aged out of the working set */
+	int wsResolves; /**< LPs re-solved after adding violated rows */
+	int wsMaxRows; /**< max size of the working set */
+	Bandit roundBandit; /**< rounding operators */
+	Bandit pertBandit; /**< perturbation types: fractional flips only or with WalkSAT */
+	int roundArm; /**< arms pulled in the current iteration (-1 if none) */
+	int pertArm;
+	double lastDist; /**< distance and number of violated rows (of the rounding) at the previous iteration */
+	int lastViolated;
+	double maxRewardRate; /**< to normalize the rewards to [0,1] */
+	int polishCnt; /**< incumbents improved by polishing */
+	double polishGain; /**< total objective improvement by polishing */
+	std::unique_ptr<Polisher> polisher; /**< built at the first incumbent */
 	int nitr; /**< pumping iterations */
 	int lastRestart;
 	int flipsInRestart;
@@ -113,13 +374,101 @@ private:
 	StopWatch roundWatch;
 	double rootTime;
 	int rootLpIter;
+	int rootBoundCnt; /**< bounds tightened by the rounder at the root and pushed to the LP */
+	ModelChanges rootUndo; /**< original bounds of the columns tightened by applyRootBounds */
+	int64_t totLpIter; /**< LP iterations over all LP solves */
+	/**
+	 * background initialization of the rounder and of the rows (see asyncInit):
+	 * keep it last, so that it is destroyed (and joined) first
+	 */
+	std::future<void> pendingInit;
 	// helpers
+	void loadOptions(const FPOptions& opts);
+	void resetRun();
+	void classifyColumns();
+	void initRounding(MIPModelPtr m);
+	void waitInit();
+	void applyRootBounds();
+	/** give the model (and lb/ub) back the bounds it had before applyRootBounds */
+	void undoRootBounds();
+	void discardInit();
+	bool stopRequested() const;
+	int64_t lastLpIterations() const;
+	char chooseLPMethod();
+	void recordLPSolve(char method, double time, int64_t iters);
+	int64_t solvePumpLP();
+	int64_t raceLP();
+	double elapsed() const;
+	int currentStage() const { return static_cast<int>(phase) - static_cast<int>(Phase::Stage1) + 1; }
+	void startStage(Phase newPhase);
+	bool stageContinues();
+	void pumpIteration();
+	void nextPhase();
+	void finish(bool found);
 	void solveInitialLP();
 	void perturbe(std::vector<double>& x, bool ignoreGeneralIntegers);
 	void restart(std::vector<double>& x, bool ignoreGeneralIntegers);
-	bool pumpLoop(double& runningAlpha, int stage);
+	void recordFlip(int j);
+	bool isTabu(int j) const { return (tabuTenure > 0) && !lastFlip.empty() && (lastFlip[j] >= 0) && (nitr - lastFlip[j] <= tabuTenure); }
 	bool stage3();
+	/**
+	 * Setup the distance function for the general integer variables in integer_x:
+	 * those not at one of their bounds need an auxiliary variable and two constraints,
+	 * which are added to the model in batch.
+	 * @return the number of auxiliary variables added
+	 */
+	int addGeneralIntegersDistance(std::vector<double>& distObj, std::vector<int>& colIndices);
+	/**
+	 * Multiple reference vectors: add to the distance function (on the binaries) the weighted
+	 * distances from the recent roundings and from the incumbent (or closest point).
+	 * @return true if any reference point was added
+	 */
+	bool addReferenceDistance(std::vector<double>& distObj);
+	/** push integer_x in the window of recent roundings (updating refSum incrementally) */
+	void updateReferences();
+	void clearReferences();
+	void initBandits();
+	/**
+	 * Reward the arms pulled in the current iteration with the reduction of distance and of violated rows
+	 * w.r.t. the previous iteration, per unit of time
+	 */
+	void rewardBandits(double dist, int violated, double time);
+	/**
+	 * Fix the integer variables to their (integral) values in x and solve the LP in the continuous
+	 * variables (on contLP, with the original objective).
+	 * Only done if the activity bounds of the rows do not already rule out feasibility.
+	 * @return true if a feasible completion was found (and stored in x)
+	 */
+	bool completeContinuous(std::vector<double>& x);
+	/** the LP part of completeContinuous (no filtering, no stats) */
+	bool solveContinuous(std::vector<double>& x);
+	/** improve the incumbent by local search (see Polisher) and, on mixed models, by solveContinuous */
+	void polishIncumbent();
 	void foundIncumbent(const std::vector<double>& x, double objval);
+	void addToPool(const std::vector<double>& x, double objval);
+	bool canImprove();
+	/** improvement mode: tighten the objective cutoff (in the model and in the rounder) and restart pumping */
+	void startImprovement();
+	int numModelRows() const { return wsActive ? wsRows.size() : rows.size() + (cutoffRow >= 0); }
+	// working set of the distance LPs
+	/** keep in the LP only the rows tight or violated at frac_x */
+	void initWorkingSet();
+	/**
+	 * add the rows violated by the LP solution and re-solve, until there are none (or the LP is not feasible)
+	 * @return the LP iterations of the re-solves
+	 */
+	int64_t separateRows();
+	/** after the temporary rows are removed: the rows of the last separation join the working set, the old slack ones leave */
+	void updateWorkingSet();
+	/** put all rows back in the LP, in their original order (followed by the cutoff, if any) */
+	void restoreRows();
+	/** append the given original rows to lp */
+	void addOriginalRows(MIPModelI& lp, const std::vector<int>& which) const;
+	/**
+	 * add to lp the rows that it misses (lpHas) and are violated, given the row violations
+	 * @return the number of rows added (also appended to added)
+	 */
+	int addViolatedRows(MIPModelI& lp, const std::vector<double>& viol, std::vector<char>& lpHas, std::vector<int>& added) const;
 	bool isInCache(double a, const std::vector<double>& x, bool ignoreGeneralIntegers);
 	void infeasibleSupport(const std::vector<double>& x, std::set<int>& supp, bool ignoreGeneralIntegers);
 };
@@ -0,0 +1,73 @@
+/**
+ * @file features.h
+ * @brief Instance features and feature based selection of the FP configuration
+ */
+
+#ifndef FEATURES_H
+#define FEATURES_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mipmodel.h"
+
+/** Named numerical features of an instance */
+typedef std::map<std::string, double> InstanceFeatures;
+
+/**
+ * Names of the features computed by extractFeatures(), in a fixed order:
+ * size and density, column type mix, row sense mix, coefficient dynamism, objective density and,
+ * for each registered propagator factory, the fraction of rows it would handle (as in the propround rounder)
+ */
+std::vector<std::string> featureNames();
+
+/** compute the features of model (one pass over the rows, no LP solve) */
+InstanceFeatures extractFeatures(const MIPModelI& model);
+
+
+/** Selector of a configuration (e.g., the name of a settings file) given the features of an instance */
+
+class ConfigSelector
+{
+public:
+	virtual ~ConfigSelector() {}
+	virtual std::string select(const InstanceFeatures& features) const = 0;
+};
+
+
+/**
+ * Decision tree selector.
+ * Text format, one node per line (node 0 is the root, # starts a comment):
+ *   node <id> <feature> <threshold> <left id> <right id>   (left if feature <= threshold)
+ *   leaf <id> <configuration>
+ */
+
+class DecisionTreeSelector : public ConfigSelector
+{
+public:
+	void load(const std::string& filename);
+	void save(const std::string& filename) const;
+	std::string select(const InstanceFeatures& features) const override;
+	/**
+	 * Train (CART, Gini impurity) from the features of some instances and the best configuration of each
+	 * @param maxDepth max depth of the tree
+	 * @param minLeaf min number of instances in a leaf
+	 */
+	void train(const std::vector<InstanceFeatures>& samples, const std::vector<std::string>& labels, int maxDepth, int minLeaf);
+	int size() const { return nodes.size(); }
+private:
+	struct Node
+	{
+		std::string feature;
+		double threshold = 0.0;
+		int left = -1; //< -1 for leaves
+		int right = -1;
+		std::string label;
+	};
+	std::vector<Node> nodes;
+	int build(const std::vector<InstanceFeatures>& samples, const std::vector<std::string>& labels,
+			std::vector<int>& subset, int depth, int maxDepth, int minLeaf);
+};
+
+#endif /* FEATURES_H */
@@ -0,0 +1,45 @@
+/**
+ * @file fp_api.h
+ * @brief Helpers to embed FP2.0 in other codes
+ *
+ * The pump itself is driven through FeasibilityPump (see feaspump.h):
+ * setOptions() instead of readConfig(), setCallbacks(), setCancelToken(),
+ * init() on a (copy of the) node model, pump() with the node LP solution as
+ * starting point, and solution() to access the incumbent without copies.
+ */
+
+#ifndef FP_API_H
+#define FP_API_H
+
+#include "mipmodel.h"
+
+/**
+ * Non-owning view of a MIP stored in CSR (row-wise) format.
+ * The arrays are owned by the caller and need to stay valid only during loadProblem().
+ */
+
+struct FPProblemView
+{
+	int ncols = 0;
+	int nrows = 0;
+	ObjSense objSense = ObjSense::MIN;
+	double objOffset = 0.0;
+	const double* obj = nullptr; //< ncols entries
+	const double* lb = nullptr; //< ncols entries
+	const double* ub = nullptr; //< ncols entries
+	const char* ctype = nullptr; //< ncols entries in {'C','B','I'} (null: all continuous)
+	const int* rowBeg = nullptr; //< nrows+1 entries
+	const int* rowIdx = nullptr; //< rowBeg[nrows] entries
+	const double* rowVal = nullptr; //< rowBeg[nrows] entries
+	const char* sense = nullptr; //< nrows entries in {'L','E','G','R'}
+	const double* rhs = nullptr; //< nrows entries
+	const double* rngval = nullptr; //< nrows entries (null: no ranged rows)
+};
+
+/**
+ * Load the problem into an empty model (e.g., a freshly constructed CPXModel),
+ * with a single batched call for the columns and one for the rows.
+ */
+void loadProblem(MIPModelI& model, const FPProblemView& prob);
+
+#endif /* FP_API_H */
@@ -15,6 +15,14 @@
 extern "C" {
 #endif
 
+/**
+ * Run the Feasibility Pump on a copy of lp (which is not modified).
+ * @param useFP2: use propagation based rounding (FP 2.0) instead of simple rounding
+ * @param logOutput: print the FP log to stdout
+ * @param foundSol: set to 1 if a feasible solution was found, 0 otherwise
+ * @param foundObjval: objective value of the solution found (if any)
+ * @return 0 on success, nonzero on error
+ */
 int callFP(CPXENVptr env, CPXLPptr lp, int useFP2, int logOutput, double timeLimit, int* foundSol, double* foundObjval);
 
 #ifdef __cplusplus
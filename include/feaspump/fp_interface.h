@@ -20,6 +20,40 @@
 
 namespace dominiqs {
 
+/**
+ * Small edits of a model: new bounds, rhs values (same convention as MIPModelI::row)
+ * and objective coefficients. Used to update FP and the rounders incrementally
+ * instead of initializing them from scratch.
+ */
+
+struct ModelChanges
+{
+	std::vector<int> lbCols;
+	std::vector<double> lbValues;
+	std::vector<int> ubCols;
+	std::vector<double> ubValues;
+	std::vector<int> rhsRows;
+	std::vector<double> rhsValues;
+	std::vector<int> objCols;
+	std::vector<double> objValues;
+	void lb(int j, double value) { lbCols.push_back(j); lbValues.push_back(value); }
+	void ub(int j, double value) { ubCols.push_back(j); ubValues.push_back(value); }
+	void rhs(int i, double value) { rhsRows.push_back(i); rhsValues.push_back(value); }
+	void objcoef(int j, double value) { objCols.push_back(j); objValues.push_back(value); }
+	bool empty() const { return lbCols.empty() && ubCols.empty() && rhsRows.empty() && objCols.empty(); }
+	void clear()
+	{
+		lbCols.clear();
+		lbValues.clear();
+		ubCols.clear();
+		ubValues.clear();
+		rhsRows.clear();
+		rhsValues.clear();
+		objCols.clear();
+		objValues.clear();
+	}
+};
+
 /**
  * Solution Transformer interface
  * Base class for frac->int (i.e. rounding) transformations
@@ -34,12 +68,36 @@ public:
 	 * Read needed information (if any) about the problem (@param pinfo)
 	 */
 	virtual void init(MIPModelPtr model, bool ignoreGeneralInt = true) {}
+	/**
+	 * Incremental version of init() after small edits of the model (@param changes)
+	 * @return false if not supported: the caller must then call init() again
+	 */
+	virtual bool update(const ModelChanges& changes) { return false; }
 	virtual void ignoreGeneralIntegers(bool flag) {}
+	/** enable/disable logging (config and statistics) */
+	virtual void logging(bool log) {}
 	/**
 	 * Trasform the vector given as input @param in and store the result in @param out
 	 */
 	virtual void apply(const std::vector<double>& in, std::vector<double>& out) = 0;
 	virtual void newIncumbent(const std::vector<double>& x, double objval) {}
+	/**
+	 * Bounds tightened by the rounder itself (e.g., by propagation at the root) w.r.t. those of the model
+	 * given to init()/update(): the caller can push them to the LP
+	 */
+	virtual void rootBounds(ModelChanges& changes) const {}
+	/**
+	 * Objective cutoff (a 'L' row, tightened on every new incumbent) that the rounded points
+	 * should satisfy: null removes it
+	 */
+	virtual void objectiveCutoff(ConstraintPtr cutoff) {}
+	/**
+	 * Variants of the rounding (operators) that can be switched between calls to apply(),
+	 * e.g., by an online selection policy: operator 0 is the configured one
+	 */
+	virtual int numOperators() const { return 1; }
+	virtual std::string operatorName(int op) const { return "default"; }
+	virtual void setOperator(int op) {}
 	/**
 	 *
 	 */
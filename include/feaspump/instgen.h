@@ -0,0 +1,47 @@
+/**
+ * @file instgen.h
+ * @brief Synthetic structured MIP instances generator
+ */
+
+#ifndef INSTGEN_H
+#define INSTGEN_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "memmodel.h"
+
+/**
+ * Parameters for the instance generators.
+ * Each family interprets the sizes in the most natural way (see instgen.cpp):
+ * for unstructured families nrows, ncols and rowNnz are taken literally, while
+ * for structured ones (e.g., facility location, lot sizing, scheduling) rowNnz
+ * is used as shape parameter and the dimensions are derived from nrows.
+ */
+
+struct InstGenParams
+{
+	int nrows = 1000; //< number of constraints
+	int ncols = 1000; //< number of variables
+	int rowNnz = 10; //< (average) number of nonzeros per row
+	uint64_t seed = 0; //< random seed
+};
+
+/**
+ * Generate an instance of the given family in memory.
+ * All instances are feasible by construction and the output depends only on params (seed included).
+ * Throws if the family is unknown.
+ */
+std::shared_ptr<MemModel> generateInstance(const std::string& family, const InstGenParams& params);
+
+/**
+ * Set nrows and ncols of params so that an instance of the given family
+ * has approximately nnz nonzeros (with params.rowNnz as density/shape parameter).
+ */
+void scaleToNnz(const std::string& family, long long nnz, InstGenParams& params);
+
+/** @return the names of the available instance families */
+std::vector<std::string> instanceFamilies();
+
+#endif /* INSTGEN_H */
@@ -0,0 +1,132 @@
+/**
+ * @file memmodel.h
+ * @brief In-memory implementation of MIPModelI (no solver attached)
+ */
+
+#ifndef MEMMODEL_H
+#define MEMMODEL_H
+
+#include <iosfwd>
+
+#include "mipmodel.h"
+
+/**
+ * Pure data implementation of MIPModelI.
+ *
+ * Stores the model (columns, rows, objective) in memory and supports all
+ * data access and modification methods, but it cannot solve anything:
+ * lpopt/mipopt/presolve throw. Models can be written in (optionally gzipped) MPS format.
+ * Useful to build synthetic instances and to exercise the non-LP parts of the code
+ * (e.g., the rounders) without a solver.
+ */
+
+class MemModel : public MIPModelI
+{
+public:
+	MemModel();
+	~MemModel() override;
+	std::unique_ptr<MemModel> clone() const { return std::unique_ptr<MemModel>(this->clone_impl()); }
+	/* Read/Write */
+	void readModel(const std::string& filename) override;
+	void writeModel(const std::string& filename, const std::string& format="") const override;
+	void writeSol(const std::string& filename) const override;
+	/* Solve */
+	void lpopt(char method) override;
+	void mipopt() override;
+	/* Presolve/postsolve */
+	void presolve() override;
+	void postsolve() override;
+	std::vector<double> postsolveSolution(const std::vector<double>& preX) const override;
+	/* Get solution */
+	double objval() const override;
+	void sol(double* x, int first = 0, int last = -1) const override;
+	bool isPrimalFeas() const override;
+	/* Basis */
+	bool getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const override;
+	void setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat) override;
+	/* Parameters */
+	void handleCtrlC(bool flag) override;
+	bool aborted() const override;
+	void interrupt() override;
+	void armInterrupt() override;
+	void seed(int seed) override;
+	void logging(bool log) override;
+	int intParam(IntParam which) const override;
+	void intParam(IntParam which, int value) override;
+	double dblParam(DblParam which) const override;
+	void dblParam(DblParam which, double value) override;
+	int intAttr(IntAttr which) const override;
+	double dblAttr(DblAttr which) const override;
+	/* Access model data */
+	int nrows() const override;
+	int ncols() const override;
+	int nnz() const override;
+	double objOffset() const override;
+	ObjSense objSense() const override;
+	void lbs(double* lb, int first = 0, int last = -1) const override;
+	void ubs(double* ub, int first = 0, int last = -1) const override;
+	void objcoefs(double* obj, int first = 0, int last = -1) const override;
+	void ctypes(char* ctype, int first = 0, int last = -1) const override;
+	void sense(char* sense, int first = 0, int last = -1) const override;
+	void rhs(double* rhs, int first = 0, int last = -1) const override;
+	void row(int ridx, dominiqs::SparseVector& row, char& sense, double& rhs, double& rngval) const override;
+	void rows(dominiqs::SparseMatrix& matrix) const override;
+	void col(int cidx, dominiqs::SparseVector& col, char& type, double& lb, double& ub, double& obj) const override;
+	void cols(dominiqs::SparseMatrix& matrix) const override;
+	void colNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	void rowNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	/* Data modifications */
+	void addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj) override;
+	void addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj) override;
+	void addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval = 0.0) override;
+	void addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs) override;
+	void addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals = nullptr) override;
+	void delRow(int ridx) override;
+	void delCol(int cidx) override;
+	void delRows(int first, int last) override;
+	void delCols(int first, int last) override;
+	void delRowSet(int cnt, const int* rows) override;
+	void objSense(ObjSense objsen) override;
+	void objOffset(double val) override;
+	void lb(int cidx, double val) override;
+	void lbs(int cnt, const int* cols, const double* values) override;
+	void ub(int cidx, double val) override;
+	void ubs(int cnt, const int* cols, const double* values) override;
+	void fixCol(int cidx, double val) override;
+	void objcoef(int cidx, double val) override;
+	void objcoefs(int cnt, const int* cols, const double* values) override;
+	void rhs(int cnt, const int* rows, const double* values) override;
+	void ctype(int cidx, char val) override;
+	void ctypes(int cnt, const int* cols, const char* values) override;
+	void switchToLP() override;
+private:
+	MemModel* clone_impl() const override;
+	void writeMPS(std::ostream& out, const std::string& filename) const;
+	MemModel* presolvedmodel_impl() override;
+private:
+	// columns
+	std::vector<std::string> xNames;
+	std::vector<double> xLb;
+	std::vector<double> xUb;
+	std::vector<double> xObj;
+	std::vector<char> xType;
+	// rows (ranged rows use our convention: linear expression in [rhs-range,rhs])
+	std::vector<dominiqs::ConstraintPtr> constraints;
+	int numNnz = 0;
+	// objective
+	ObjSense objsen = ObjSense::MIN;
+	double objoff = 0.0;
+	// parameters
+	int threads = 1;
+	int solutionLimit = 0;
+	int nodeLimit = 0;
+	int iterLimit = 0;
+	int crossover = 1;
+	double timeLimit = 1e75;
+	double feasTol = 1e-6;
+	double intTol = 1e-6;
+	double objLowerLimit = -1e75;
+	double objUpperLimit = 1e75;
+};
+
+#endif /* MEMMODEL_H */
@@ -22,18 +22,29 @@ enum class ObjSense {
 };
 
 
+/** Crossover: 1 (default) = barrier is followed by crossover to a basic solution, 0 = barrier stops at the interior solution */
 enum class IntParam {
 	Threads,
 	SolutionLimit,
 	NodeLimit,
-	IterLimit
+	IterLimit,
+	Crossover
 };
 
 
+/**
+ * ObjLowerLimit/ObjUpperLimit allow the LP optimization (of a minimization problem) to stop
+ * as soon as its optimal value is known to be below/above the limit (e.g., with CPLEX the primal
+ * simplex stops once the objective goes below the lower limit, the dual once it goes above the upper one).
+ * Backends without such a feature just store the value: ObjLowerLimit is CPLEX only
+ * (Xpress ignores it, with a warning the first time a finite limit is set).
+ */
 enum class DblParam {
 	TimeLimit,
 	FeasibilityTolerance,
-	IntegralityTolerance
+	IntegralityTolerance,
+	ObjLowerLimit,
+	ObjUpperLimit
 };
 
 
@@ -56,6 +67,12 @@ class MIPModelI
 public:
 	virtual ~MIPModelI() {}
 	std::unique_ptr<MIPModelI> clone() const { return std::unique_ptr<MIPModelI>(this->clone_impl()); }
+	/**
+	 * Clone that can be solved concurrently with this model (e.g., racing on the same LP in another thread):
+	 * it has its own parameters (copied from this model) and its own interrupt().
+	 * Returns nullptr if the backend cannot provide one.
+	 */
+	std::unique_ptr<MIPModelI> concurrentClone() const { return std::unique_ptr<MIPModelI>(this->concurrentclone_impl()); }
 	/* Read/Write */
 	virtual void readModel(const std::string& filename) = 0;
 	virtual void writeModel(const std::string& filename, const std::string& format="") const = 0;
@@ -72,9 +89,27 @@ public:
 	virtual double objval() const = 0;
 	virtual void sol(double* x, int first = 0, int last = -1) const = 0;
 	virtual bool isPrimalFeas() const = 0;
+	/**
+	 * Basis: one status per column (cstat) and per row (rstat), with codes
+	 * 0 = nonbasic at lower bound, 1 = basic, 2 = nonbasic at upper bound, 3 = superbasic/free.
+	 * getBasis() returns false if no basis is available.
+	 */
+	virtual bool getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const = 0;
+	virtual void setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat) = 0;
 	/* Parameters */
 	virtual void handleCtrlC(bool flag) = 0;
 	virtual bool aborted() const = 0;
+	/**
+	 * Ask a running lpopt()/mipopt() to stop as soon as possible: can be called from another thread.
+	 * Unlike a user break, it does not make aborted() return true.
+	 */
+	virtual void interrupt() = 0;
+	/**
+	 * Clear the interrupt state before the next lpopt()/mipopt() is started (e.g., by another thread):
+	 * an interrupt() arriving in between then stops that solve right away.
+	 * Without it, a solve clears stale interrupts when it starts.
+	 */
+	virtual void armInterrupt() = 0;
 	virtual void seed(int seed) = 0;
 	virtual void logging(bool log) = 0;
 	virtual int intParam(IntParam which) const = 0;
@@ -105,10 +140,15 @@ public:
 	virtual void addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj) = 0;
 	virtual void addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj) = 0;
 	virtual void addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval = 0.0) = 0;
+	/* Batch versions: names (if not empty) must have cnt entries, beg has cnt+1 entries (beg[cnt] = #nonzeros) */
+	virtual void addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs) = 0;
+	virtual void addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals = nullptr) = 0;
 	virtual void delRow(int ridx) = 0;
 	virtual void delCol(int cidx) = 0;
 	virtual void delRows(int first, int last) = 0;
 	virtual void delCols(int first, int last) = 0;
+	/* delete the cnt rows listed in rows (distinct indices, any order) in a single call */
+	virtual void delRowSet(int cnt, const int* rows) = 0;
 	virtual void objSense(ObjSense objsen) = 0;
 	virtual void objOffset(double val) = 0;
 	virtual void lb(int cidx, double val) = 0;
@@ -118,11 +158,14 @@ public:
 	virtual void fixCol(int cidx, double val) = 0;
 	virtual void objcoef(int cidx, double val) = 0;
 	virtual void objcoefs(int cnt, const int* cols, const double* values) = 0;
+	/* for ranged rows the range is kept (i.e., the allowed range becomes [rhs-rngval,rhs]) */
+	virtual void rhs(int cnt, const int* rows, const double* values) = 0;
 	virtual void ctype(int cidx, char val) = 0;
 	virtual void ctypes(int cnt, const int* cols, const char* values) = 0;
 	virtual void switchToLP() = 0;
 private:
 	virtual MIPModelI* clone_impl() const = 0;
+	virtual MIPModelI* concurrentclone_impl() const { return nullptr; }
 	virtual MIPModelI* presolvedmodel_impl() = 0;
 };
 
@@ -0,0 +1,63 @@
+/**
+ * @file polish.h
+ * @brief Local search polishing of feasible solutions
+ */
+
+#ifndef POLISH_H
+#define POLISH_H
+
+#include <vector>
+#include <cstdint>
+
+#include <utils/maths.h>
+
+/**
+ * Cheap objective improvement of a feasible solution by local moves:
+ * - 1-opt: shift a variable towards its better bound, as far as the slacks of its rows allow
+ *   (integer variables by integral steps);
+ * - 2-opt: a unit step of an integer variable blocked by a single row, compensated by
+ *   a unit step of another integer variable of that row, if the pair improves the objective.
+ * Row activities are updated incrementally, using a column-major copy of the matrix.
+ * Moves keep the solution feasible: polish() never makes it worse.
+ */
+
+class Polisher
+{
+public:
+	/**
+	 * Setup (the rows are shared, not copied).
+	 * @param obj objective to minimize (the caller negates it for maximization problems)
+	 */
+	void init(const std::vector<dominiqs::ConstraintPtr>& rows, const std::vector<char>& xType,
+			const std::vector<double>& lb, const std::vector<double>& ub, const std::vector<double>& obj);
+	/** polish x in place: @return the objective improvement (>= 0) */
+	double polish(std::vector<double>& x);
+	bool ready() const { return !colBeg.empty(); }
+	// stats
+	uint64_t oneOptMoves = 0;
+	uint64_t twoOptMoves = 0;
+private:
+	// problem data
+	std::vector<dominiqs::ConstraintPtr> rows;
+	std::vector<double> rowLhs;
+	std::vector<double> rowRhs;
+	std::vector<char> xType;
+	std::vector<double> lb;
+	std::vector<double> ub;
+	std::vector<double> obj;
+	// column-major copy of the matrix
+	std::vector<int> colBeg;
+	std::vector<int> colRow;
+	std::vector<double> colCoef;
+	// search state
+	std::vector<double> activity;
+	std::vector<double> delta; //< scratch: activity changes of a pending move (dense, kept clean)
+	// helpers
+	bool isInt(int j) const { return xType[j] != 'C'; }
+	double maxStep(int j, double dir, const std::vector<double>& x) const;
+	void move(int j, double step, std::vector<double>& x);
+	bool oneOpt(int j, std::vector<double>& x);
+	bool twoOpt(int j, std::vector<double>& x);
+};
+
+#endif /* POLISH_H */
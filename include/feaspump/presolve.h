@@ -0,0 +1,65 @@
+/**
+ * @file presolve.h
+ * @brief Lightweight in-tree presolve (with postsolve stack)
+ */
+
+#ifndef PRESOLVE_H
+#define PRESOLVE_H
+
+#include <vector>
+
+#include "mipmodel.h"
+
+/**
+ * Solver independent presolve of the reductions that matter most to FP:
+ * - bound tightening of the integer variables by a root fixpoint of the propagation engine;
+ * - removal of fixed columns;
+ * - singleton rows turned into bounds, empty and free rows removed;
+ * - duplicate and parallel rows merged into a single (possibly ranged) row;
+ * - aggregation of the binaries found equal by the logic propagators (x - y = 0).
+ * Reductions are applied in rounds until nothing changes.
+ * The reduced model is a clone of the input one, edited through MIPModelI,
+ * so that it keeps the LP solver of the original model.
+ * Each removed column pushes a step on the postsolve stack, unwound by postsolve().
+ */
+
+class Presolver
+{
+public:
+	/**
+	 * Presolve model.
+	 * @return the reduced model, or nullptr if no reduction was found or the model was proven infeasible
+	 */
+	MIPModelPtr presolve(const MIPModelI& model);
+	/** map a solution of the reduced model back to the original space */
+	std::vector<double> postsolve(const std::vector<double>& preX) const;
+	bool infeasible() const { return isInfeasible; }
+	void logStats() const;
+	// options
+	int propThreads = 1; //< threads of the root propagation (see PropagationEngine::bulkThreads)
+	// stats
+	int tightenedBounds = 0;
+	int fixedCols = 0;
+	int aggregatedCols = 0;
+	int singletonRows = 0;
+	int emptyRows = 0;
+	int parallelRows = 0;
+	int rounds = 0;
+	double time = 0.0;
+private:
+	struct PostsolveStep
+	{
+		enum class Type { Fixed, Aggregated };
+		Type type;
+		int col;
+		double value; //< Fixed: value of col
+		int rep; //< Aggregated: col takes the value of rep
+	};
+	std::vector<PostsolveStep> stack;
+	std::vector<int> keptCols; //< reduced column -> original column
+	int origCols = 0;
+	bool isInfeasible = false;
+	void clear();
+};
+
+#endif /* PRESOLVE_H */
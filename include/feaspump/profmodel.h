@@ -0,0 +1,140 @@
+/**
+ * @file profmodel.h
+ * @brief Profiling decorator for MIPModelI
+ */
+
+#ifndef PROFMODEL_H
+#define PROFMODEL_H
+
+#include "mipmodel.h"
+#include "tracemodel.h"
+
+
+/**
+ * Number of calls and time spent in each MIPModelI method.
+ * Methods are identified by their trace opcode. Calls are split in two buckets:
+ * optimization (lpopt, mipopt, presolve) and data traffic (everything else).
+ */
+
+class ModelProfile
+{
+public:
+	ModelProfile();
+	void add(TraceOp op, double time)
+	{
+		numCalls[static_cast<int>(op)]++;
+		totTime[static_cast<int>(op)] += time;
+	}
+	uint64_t calls(TraceOp op) const { return numCalls[static_cast<int>(op)]; }
+	double time(TraceOp op) const { return totTime[static_cast<int>(op)]; }
+	static bool isOptimization(TraceOp op);
+	/* bucket totals */
+	uint64_t optCalls() const;
+	double optTime() const;
+	uint64_t dataCalls() const;
+	double dataTime() const;
+	/** log a summary (methods sorted by decreasing total time) */
+	void print() const;
+	void clear();
+private:
+	std::vector<uint64_t> numCalls;
+	std::vector<double> totTime;
+};
+
+using ModelProfilePtr = std::shared_ptr<ModelProfile>;
+
+
+/**
+ * Decorator of MIPModelI counting calls and accumulating time per method.
+ * Clones and presolved models share the same profile.
+ */
+
+class ProfiledModel : public MIPModelI
+{
+public:
+	ProfiledModel(MIPModelPtr model, ModelProfilePtr profile);
+	const ModelProfile& getProfile() const { return *profile; }
+	/** record mode: wrap model */
+	/** replay mode */
+	std::unique_ptr<ProfiledModel> clone() const { return std::unique_ptr<ProfiledModel>(this->clone_impl()); }
+	/* Read/Write */
+	void readModel(const std::string& filename) override;
+	void writeModel(const std::string& filename, const std::string& format="") const override;
+	void writeSol(const std::string& filename) const override;
+	/* Solve */
+	void lpopt(char method) override;
+	void mipopt() override;
+	/* Presolve/postsolve */
+	void presolve() override;
+	void postsolve() override;
+	std::vector<double> postsolveSolution(const std::vector<double>& preX) const override;
+	/* Get solution */
+	double objval() const override;
+	void sol(double* x, int first = 0, int last = -1) const override;
+	bool isPrimalFeas() const override;
+	/* Basis */
+	bool getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const override;
+	void setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat) override;
+	/* Parameters */
+	void handleCtrlC(bool flag) override;
+	bool aborted() const override;
+	void interrupt() override;
+	void armInterrupt() override;
+	void seed(int seed) override;
+	void logging(bool log) override;
+	int intParam(IntParam which) const override;
+	void intParam(IntParam which, int value) override;
+	double dblParam(DblParam which) const override;
+	void dblParam(DblParam which, double value) override;
+	int intAttr(IntAttr which) const override;
+	double dblAttr(DblAttr which) const override;
+	/* Access model data */
+	int nrows() const override;
+	int ncols() const override;
+	int nnz() const override;
+	double objOffset() const override;
+	ObjSense objSense() const override;
+	void lbs(double* lb, int first = 0, int last = -1) const override;
+	void ubs(double* ub, int first = 0, int last = -1) const override;
+	void objcoefs(double* obj, int first = 0, int last = -1) const override;
+	void ctypes(char* ctype, int first = 0, int last = -1) const override;
+	void sense(char* sense, int first = 0, int last = -1) const override;
+	void rhs(double* rhs, int first = 0, int last = -1) const override;
+	void row(int ridx, dominiqs::SparseVector& row, char& sense, double& rhs, double& rngval) const override;
+	void rows(dominiqs::SparseMatrix& matrix) const override;
+	void col(int cidx, dominiqs::SparseVector& col, char& type, double& lb, double& ub, double& obj) const override;
+	void cols(dominiqs::SparseMatrix& matrix) const override;
+	void colNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	void rowNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	/* Data modifications */
+	void addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj) override;
+	void addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj) override;
+	void addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval = 0.0) override;
+	void addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs) override;
+	void addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals = nullptr) override;
+	void delRow(int ridx) override;
+	void delCol(int cidx) override;
+	void delRows(int first, int last) override;
+	void delCols(int first, int last) override;
+	void delRowSet(int cnt, const int* rows) override;
+	void objSense(ObjSense objsen) override;
+	void objOffset(double val) override;
+	void lb(int cidx, double val) override;
+	void lbs(int cnt, const int* cols, const double* values) override;
+	void ub(int cidx, double val) override;
+	void ubs(int cnt, const int* cols, const double* values) override;
+	void fixCol(int cidx, double val) override;
+	void objcoef(int cidx, double val) override;
+	void objcoefs(int cnt, const int* cols, const double* values) override;
+	void rhs(int cnt, const int* rows, const double* values) override;
+	void ctype(int cidx, char val) override;
+	void ctypes(int cnt, const int* cols, const char* values) override;
+	void switchToLP() override;
+private:
+	ProfiledModel* clone_impl() const override;
+	ProfiledModel* presolvedmodel_impl() override;
+	MIPModelPtr model; //< wrapped backend
+	ModelProfilePtr profile;
+};
+
+#endif /* PROFMODEL_H */
@@ -0,0 +1,266 @@
+/**
+ * @file tracemodel.h
+ * @brief Recording/replaying decorator for MIPModelI
+ */
+
+#ifndef TRACEMODEL_H
+#define TRACEMODEL_H
+
+#include <iosfwd>
+#include <cstdint>
+
+#include "mipmodel.h"
+
+
+/* Operation codes of a trace record (one per MIPModelI method) */
+enum class TraceOp : uint8_t {
+	ReadModel = 1,
+	WriteModel,
+	WriteSol,
+	LPOpt,
+	MIPOpt,
+	Presolve,
+	Postsolve,
+	PresolvedModel,
+	PostsolveSolution,
+	ObjVal,
+	Sol,
+	IsPrimalFeas,
+	HandleCtrlC,
+	Aborted,
+	Seed,
+	Logging,
+	GetIntParam,
+	SetIntParam,
+	GetDblParam,
+	SetDblParam,
+	IntAttr,
+	DblAttr,
+	NRows,
+	NCols,
+	NNZ,
+	GetObjOffset,
+	GetObjSense,
+	GetLbs,
+	GetUbs,
+	GetObjCoefs,
+	GetCTypes,
+	Sense,
+	Rhs,
+	Row,
+	Rows,
+	Col,
+	Cols,
+	ColNames,
+	RowNames,
+	AddEmptyCol,
+	AddCol,
+	AddRow,
+	AddEmptyCols,
+	AddRows,
+	DelRow,
+	DelCol,
+	DelRows,
+	DelCols,
+	SetObjSense,
+	SetObjOffset,
+	SetLb,
+	SetLbs,
+	SetUb,
+	SetUbs,
+	FixCol,
+	SetObjCoef,
+	SetObjCoefs,
+	SetCType,
+	SetCTypes,
+	SwitchToLP,
+	Clone,
+	GetBasis,
+	SetBasis,
+	SetRhs,
+	DelRowSet,
+	NumOps //< sentinel: keep last
+};
+
+/** @return a human readable name for the given opcode (i.e., the MIPModelI method name) */
+const char* traceOpName(TraceOp op);
+
+/** number of opcodes (opcodes are in [1,NUM_TRACE_OPS)) */
+static const int NUM_TRACE_OPS = static_cast<int>(TraceOp::NumOps);
+
+
+/**
+ * Binary trace of MIPModelI calls.
+ *
+ * The same object is shared by all models (clones, presolved models) derived from
+ * the same root model, so that the trace is a single sequential stream.
+ * All I/O methods are symmetric: in record mode they write the given value,
+ * in replay mode they read it back (io) or read it and compare with the given one (check).
+ * Files ending in .gz are compressed.
+ */
+
+class Trace
+{
+public:
+	enum class Mode { Record, Replay };
+	Trace(const std::string& filename, Mode mode);
+	~Trace();
+	Mode mode() const { return traceMode; }
+	bool recording() const { return (traceMode == Mode::Record); }
+	int newModelId() { return nextModelId++; }
+	uint64_t records() const { return numRecords; }
+	/* Record header: opcode + model id (checked in replay mode) */
+	void begin(TraceOp op, int modelId);
+	/* Symmetric I/O */
+	template<typename T> void io(T& value)
+	{
+		if (recording())  write(&value, sizeof(T));
+		else  read(&value, sizeof(T));
+	}
+	template<typename T> void check(const T& value)
+	{
+		T other = value;
+		io(other);
+		if (!recording() && !(other == value))  mismatch("argument");
+	}
+	template<typename T> void ioArray(T* data, int n)
+	{
+		if (n <= 0)  return;
+		if (recording())  write(data, sizeof(T) * n);
+		else  read(data, sizeof(T) * n);
+	}
+	template<typename T> void ioVector(std::vector<T>& v)
+	{
+		int n = v.size();
+		io(n);
+		v.resize(n);
+		if (n)  ioArray(&v[0], n);
+	}
+	void io(std::string& s);
+	void io(std::vector<std::string>& v);
+	void io(dominiqs::SparseVector& v);
+	void io(dominiqs::SparseMatrix& m);
+	/**
+	 * Outcome of a call that may throw: in record mode e is the exception thrown by the
+	 * backend (or null), in replay mode the recorded exception is thrown again.
+	 */
+	void ioOutcome(const std::exception* e);
+private:
+	void write(const void* data, size_t size);
+	void read(void* data, size_t size);
+	void mismatch(const std::string& what);
+	Mode traceMode;
+	std::string filename;
+	std::ostream* out = nullptr;
+	std::istream* in = nullptr;
+	int nextModelId = 0;
+	uint64_t numRecords = 0;
+};
+
+using TracePtr = std::shared_ptr<Trace>;
+
+
+/**
+ * Decorator of MIPModelI recording (or replaying) all calls and their results.
+ *
+ * In record mode every call is forwarded to the wrapped backend and logged, together with
+ * its results, to the trace. In replay mode no backend is needed: results are read back from
+ * the trace, and the sequence of calls (and their scalar arguments) is checked against it.
+ * This allows to profile and regression test the non-LP parts of the code without a solver,
+ * as long as the calling code is deterministic (same config and seed, no wall-clock limits hit).
+ */
+
+class TraceModel : public MIPModelI
+{
+public:
+	/** record mode: wrap model */
+	TraceModel(MIPModelPtr model, TracePtr trace);
+	/** replay mode */
+	TraceModel(TracePtr trace);
+	std::unique_ptr<TraceModel> clone() const { return std::unique_ptr<TraceModel>(this->clone_impl()); }
+	/* Read/Write */
+	void readModel(const std::string& filename) override;
+	void writeModel(const std::string& filename, const std::string& format="") const override;
+	void writeSol(const std::string& filename) const override;
+	/* Solve */
+	void lpopt(char method) override;
+	void mipopt() override;
+	/* Presolve/postsolve */
+	void presolve() override;
+	void postsolve() override;
+	std::vector<double> postsolveSolution(const std::vector<double>& preX) const override;
+	/* Get solution */
+	double objval() const override;
+	void sol(double* x, int first = 0, int last = -1) const override;
+	bool isPrimalFeas() const override;
+	/* Basis */
+	bool getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const override;
+	void setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat) override;
+	/* Parameters */
+	void handleCtrlC(bool flag) override;
+	bool aborted() const override;
+	void interrupt() override;
+	void armInterrupt() override;
+	void seed(int seed) override;
+	void logging(bool log) override;
+	int intParam(IntParam which) const override;
+	void intParam(IntParam which, int value) override;
+	double dblParam(DblParam which) const override;
+	void dblParam(DblParam which, double value) override;
+	int intAttr(IntAttr which) const override;
+	double dblAttr(DblAttr which) const override;
+	/* Access model data */
+	int nrows() const override;
+	int ncols() const override;
+	int nnz() const override;
+	double objOffset() const override;
+	ObjSense objSense() const override;
+	void lbs(double* lb, int first = 0, int last = -1) const override;
+	void ubs(double* ub, int first = 0, int last = -1) const override;
+	void objcoefs(double* obj, int first = 0, int last = -1) const override;
+	void ctypes(char* ctype, int first = 0, int last = -1) const override;
+	void sense(char* sense, int first = 0, int last = -1) const override;
+	void rhs(double* rhs, int first = 0, int last = -1) const override;
+	void row(int ridx, dominiqs::SparseVector& row, char& sense, double& rhs, double& rngval) const override;
+	void rows(dominiqs::SparseMatrix& matrix) const override;
+	void col(int cidx, dominiqs::SparseVector& col, char& type, double& lb, double& ub, double& obj) const override;
+	void cols(dominiqs::SparseMatrix& matrix) const override;
+	void colNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	void rowNames(std::vector<std::string>& names, int first = 0, int last = -1) const override;
+	/* Data modifications */
+	void addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj) override;
+	void addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj) override;
+	void addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval = 0.0) override;
+	void addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs) override;
+	void addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals = nullptr) override;
+	void delRow(int ridx) override;
+	void delCol(int cidx) override;
+	void delRows(int first, int last) override;
+	void delCols(int first, int last) override;
+	void delRowSet(int cnt, const int* rows) override;
+	void objSense(ObjSense objsen) override;
+	void objOffset(double val) override;
+	void lb(int cidx, double val) override;
+	void lbs(int cnt, const int* cols, const double* values) override;
+	void ub(int cidx, double val) override;
+	void ubs(int cnt, const int* cols, const double* values) override;
+	void fixCol(int cidx, double val) override;
+	void objcoef(int cidx, double val) override;
+	void objcoefs(int cnt, const int* cols, const double* values) override;
+	void rhs(int cnt, const int* rows, const double* values) override;
+	void ctype(int cidx, char val) override;
+	void ctypes(int cnt, const int* cols, const char* values) override;
+	void switchToLP() override;
+private:
+	TraceModel* clone_impl() const override;
+	TraceModel* presolvedmodel_impl() override;
+	// helpers
+	void begin(TraceOp op) const { trace->begin(op, id); }
+	bool recording() const { return trace->recording(); }
+	int rangeSize(int first, int last, bool onRows) const;
+	MIPModelPtr model; //< wrapped backend (null in replay mode)
+	TracePtr trace;
+	int id;
+};
+
+#endif /* TRACEMODEL_H */
@@ -45,15 +45,24 @@ public:
 	SimpleRounding();
 	void readConfig();
 	void init(MIPModelPtr model, bool ignoreGeneralInt = true);
+	bool update(const dominiqs::ModelChanges& changes);
 	void ignoreGeneralIntegers(bool flag);
+	void logging(bool log) { verbose = log; }
 	void apply(const std::vector<double>& in, std::vector<double>& out);
 protected:
+	std::vector<double> xLb;
+	std::vector<double> xUb;
+	std::vector<char> xType;
 	std::vector<int> binaries;
 	std::vector<int> gintegers;
 	std::vector<int> integers;
+	bool ignoreGInt;
 	dominiqs::RandGen roundGen;
 	bool randomizedRounding;
 	bool logDetails;
+	bool verbose;
+	// helpers
+	void classifyColumns();
 };
 
 /**
@@ -67,17 +76,52 @@ public:
 	~PropagatorRounding() { clear(); }
 	void readConfig();
 	void init(MIPModelPtr model, bool ignoreGeneralInt = true);
+	/**
+	 * Patch the domain and rebuild only the propagators of the edited rows and of
+	 * the rows containing a variable whose bounds changed.
+	 * The bounds implied by the previous root propagation are dropped (they may not hold anymore)
+	 * and the root propagation is run again.
+	 */
+	bool update(const dominiqs::ModelChanges& changes);
 	void ignoreGeneralIntegers(bool flag);
 	void apply(const std::vector<double>& in, std::vector<double>& out);
+	/** integer bounds tightened by the root propagation (see rootPropWork): update() starts again from the original ones */
+	void rootBounds(dominiqs::ModelChanges& changes) const { changes = rootChanges; }
+	/** the cutoff is propagated as an additional row (after the rows of the model) */
+	void objectiveCutoff(dominiqs::ConstraintPtr cutoff);
+	/** operators: propagation with each of the registered rankers (the configured one first), plus plain rounding */
+	int numOperators() const { return opRankers.size(); }
+	std::string operatorName(int op) const;
+	void setOperator(int op);
 	void clear();
 protected:
 	// data
 	DomainPtr domain;
 	StatePtr state;
+	StatePtr preRootState; //< state before the root propagation (null if there was none)
 	PropagationEngine prop;
 	std::map<int, PropagatorFactoryPtr> factories;
-	RankerPtr ranker;
+	RankerPtr ranker; //< ranker of the current operator
+	std::vector<std::string> opRankers; //< operator -> ranker name (empty for plain rounding)
+	std::vector<RankerPtr> rankers; //< operator -> ranker
+	std::vector<bool> rankerReady; //< operator -> ranker initialized (other than the configured one, they are initialized on first use)
+	int curOp = 0;
 	bool filterConstraints;
+	std::vector<dominiqs::ConstraintPtr> rows; //< constraints of the model
+	std::vector<int> rowProp; //< row index -> propagator id (-1 if none)
+	std::vector<int> propRow; //< propagator id -> row index (-1 if removed)
+	int cutoffRow = -1; //< index of the objective cutoff in rows (-1 if none)
+	int rootPropWork; //< work limit of the root propagation, in propagator calls per propagator (0 = off)
+	dominiqs::ModelChanges rootChanges; //< integer bounds tightened at the root
+	// helpers
+	/**
+	 * Propagate at the root (with a work limit) and make the result the root state of the dives
+	 * @return true if some variable got fixed
+	 */
+	bool rootFixpoint();
+	bool isFiltered(const dominiqs::Constraint& c) const;
+	PropagatorPtr createPropagator(dominiqs::Constraint* c);
+	void setRowPropagator(int i, PropagatorPtr p);
 };
 
 #endif /* TRANSFORMERS_H */
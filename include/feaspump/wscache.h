@@ -0,0 +1,56 @@
+/**
+ * @file wscache.h
+ * @brief Persistent on-disk cache of warm start information
+ */
+
+#ifndef WSCACHE_H
+#define WSCACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "mipmodel.h"
+
+/** Warm start information collected by a FP run */
+struct WarmStart
+{
+	std::vector<int> cstat; //< root LP basis (columns)
+	std::vector<int> rstat; //< root LP basis (rows)
+	std::vector<double> closestPoint; //< rounded point closest to feasibility
+	std::vector<double> incumbent; //< feasible solution (empty if none)
+	bool empty() const { return cstat.empty() && closestPoint.empty() && incumbent.empty(); }
+	void clear();
+};
+
+/**
+ * Structural signature of a model: dimensions, column types, row senses and sparsity pattern.
+ * Numerical data (coefficients, bounds, sides, objective) are not considered,
+ * so that slightly perturbed versions of a model share the same signature.
+ */
+uint64_t modelSignature(const MIPModelI& model);
+
+/**
+ * Directory based cache of warm starts, keyed by model signature.
+ * Each entry is a file: loads refresh its modification time, which is used to evict
+ * the least recently used entries whenever the total size exceeds the cap.
+ * Entries are written atomically, so the cache can be shared by concurrent processes.
+ */
+
+class WarmStartCache
+{
+public:
+	/** @param dir cache directory (created if missing), @param maxSize total size cap in bytes */
+	WarmStartCache(const std::string& dir, uint64_t maxSize);
+	/** load the entry for key, if present and compatible with the given dimensions */
+	bool load(uint64_t key, int ncols, int nrows, WarmStart& ws) const;
+	/** store (or replace) the entry for key, then enforce the size cap */
+	void store(uint64_t key, int ncols, int nrows, const WarmStart& ws);
+private:
+	std::string entryPath(uint64_t key) const;
+	void evict();
+	std::string dir;
+	uint64_t maxSize;
+};
+
+#endif /* WSCACHE_H */
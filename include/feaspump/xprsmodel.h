@@ -10,6 +10,7 @@
 #define XPRSMODEL_H
 
 #include "mipmodel.h"
+#include <atomic>
 #include <xprs.h>
 
 class XPRSModel : public MIPModelI
@@ -35,9 +36,14 @@ public:
 	double objval() const override;
 	void sol(double* x, int first = 0, int last = -1) const override;
 	bool isPrimalFeas() const override;
+	/* Basis */
+	bool getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const override;
+	void setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat) override;
 	/* Parameters */
 	void handleCtrlC(bool flag) override;
 	bool aborted() const override;
+	void interrupt() override;
+	void armInterrupt() override;
 	void seed(int seed) override;
 	void logging(bool log) override;
 	int intParam(IntParam which) const override;
@@ -68,10 +74,13 @@ public:
 	void addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj) override;
 	void addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj) override;
 	void addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval = 0.0) override;
+	void addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs) override;
+	void addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals = nullptr) override;
 	void delRow(int ridx) override;
 	void delCol(int cidx) override;
 	void delRows(int first, int last) override;
 	void delCols(int first, int last) override;
+	void delRowSet(int cnt, const int* rows) override;
 	void objSense(ObjSense objsen) override;
 	void objOffset(double val) override;
 	void lb(int cidx, double val) override;
@@ -81,6 +90,7 @@ public:
 	void fixCol(int cidx, double val) override;
 	void objcoef(int cidx, double val) override;
 	void objcoefs(int cnt, const int* cols, const double* values) override;
+	void rhs(int cnt, const int* rows, const double* values) override;
 	void ctype(int cidx, char val) override;
 	void ctypes(int cnt, const int* cols, const char* values) override;
 	void switchToLP() override;
@@ -88,13 +98,19 @@ public:
 	XPRSprob getProb() const { return prob; }
 private:
 	XPRSModel* clone_impl() const override;
+	XPRSModel* concurrentclone_impl() const override;
 	XPRSModel* presolvedmodel_impl() override;
+	/** @return true if the solve about to start has already been interrupted (see armInterrupt) */
+	bool skipInterrupted();
 private:
 	XPRSprob prob = nullptr;
 	bool ownProb = true;
 	using SignalHandler = void (*)(int);
 	SignalHandler previousHandler = nullptr;
 	bool restoreSignalHandler = false;
+	double objLowerLimit = -1e75;
+	bool armed = false; //< armInterrupt() was called and no solve started since
+	std::atomic<bool> interrupted{false}; //< interrupt() was called since armInterrupt()
 };
 
 #endif /* XPRSMODEL_H */
@@ -0,0 +1,69 @@
+/**
+ * @file bandit.cpp
+ * @brief Multi-armed bandit for online operator selection
+ */
+
+#include "feaspump/bandit.h"
+#include <cmath>
+
+#include <utils/asserter.h>
+
+using namespace dominiqs;
+
+static const double BANDIT_DISCOUNT = 0.95;
+
+
+void Bandit::init(const std::vector<std::string>& names, BanditPolicy _policy, double _eps, uint64_t seed)
+{
+	arms.clear();
+	arms.resize(names.size());
+	for (unsigned int k = 0; k < names.size(); k++)  arms[k].name = names[k];
+	policy = _policy;
+	eps = _eps;
+	rnd.setSeed(seed);
+	rnd.warmUp();
+}
+
+
+int Bandit::select()
+{
+	DOMINIQS_ASSERT( arms.size() );
+	int n = arms.size();
+	double totWeight = 0.0;
+	for (int k = 0; k < n; k++)
+	{
+		if (arms[k].weight <= 0.0)  return k;
+		totWeight += arms[k].weight;
+	}
+	if ((policy == BanditPolicy::EpsGreedy) && (rnd.getFloat() < eps))  return std::min(int(rnd.getFloat() * n), n - 1);
+	int best = 0;
+	double bestScore = -1.0;
+	for (int k = 0; k < n; k++)
+	{
+		double score = arms[k].value / arms[k].weight;
+		if (policy == BanditPolicy::UCB)  score += std::sqrt(2.0 * std::log(std::max(totWeight, 1.0)) / arms[k].weight);
+		if (score > bestScore)
+		{
+			best = k;
+			bestScore = score;
+		}
+	}
+	return best;
+}
+
+
+void Bandit::update(int k, double reward, double time)
+{
+	DOMINIQS_ASSERT( (k >= 0) && (k < (int)arms.size()) );
+	for (BanditArm& a: arms)
+	{
+		a.weight *= BANDIT_DISCOUNT;
+		a.value *= BANDIT_DISCOUNT;
+	}
+	BanditArm& a = arms[k];
+	a.pulls++;
+	a.totReward += reward;
+	a.time += time;
+	a.weight += 1.0;
+	a.value += reward;
+}
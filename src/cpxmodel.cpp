@@ -11,10 +11,12 @@
 #include <cstring>
 
 int CPXModel_UserBreak = 0;
+static int* CPXModel_BreakFlag = nullptr; //< termination flag of the environment handling Ctrl-C
 
 static void userSignalBreak(int signum)
 {
 	CPXModel_UserBreak = 1;
+	if (CPXModel_BreakFlag)  *CPXModel_BreakFlag = 1;
 }
 
 
@@ -38,6 +40,55 @@ void CPX_CALL(Func cpxfunc, CPXENVptr env, Args&&... args)
 }
 
 
+/* Copy the parameters of env that are not at their default value to dest */
+static void copyParams(CPXENVptr env, CPXENVptr dest)
+{
+	int cnt = 0;
+	int surplus = 0;
+	CPXgetchgparam(env, &cnt, nullptr, 0, &surplus);
+	if (surplus >= 0)  return;
+	std::vector<int> params(-surplus);
+	CPX_CALL(CPXgetchgparam, env, &cnt, &params[0], (int)params.size(), &surplus);
+	for (int k = 0; k < cnt; k++)
+	{
+		int type = CPX_PARAMTYPE_NONE;
+		CPX_CALL(CPXgetparamtype, env, params[k], &type);
+		switch (type)
+		{
+			case CPX_PARAMTYPE_INT:
+			{
+				CPXINT value = 0;
+				CPX_CALL(CPXgetintparam, env, params[k], &value);
+				CPX_CALL(CPXsetintparam, dest, params[k], value);
+				break;
+			}
+			case CPX_PARAMTYPE_LONG:
+			{
+				CPXLONG value = 0;
+				CPX_CALL(CPXgetlongparam, env, params[k], &value);
+				CPX_CALL(CPXsetlongparam, dest, params[k], value);
+				break;
+			}
+			case CPX_PARAMTYPE_DOUBLE:
+			{
+				double value = 0.0;
+				CPX_CALL(CPXgetdblparam, env, params[k], &value);
+				CPX_CALL(CPXsetdblparam, dest, params[k], value);
+				break;
+			}
+			case CPX_PARAMTYPE_STRING:
+			{
+				char value[CPX_STR_PARAM_MAX];
+				CPX_CALL(CPXgetstrparam, env, params[k], value);
+				CPX_CALL(CPXsetstrparam, dest, params[k], value);
+				break;
+			}
+			default: break;
+		}
+	}
+}
+
+
 CPXModel::CPXModel()
 {
 	int status = 0;
@@ -94,6 +145,8 @@ void CPXModel::writeSol(const std::string& filename) const
 void CPXModel::lpopt(char method)
 {
 	DOMINIQS_ASSERT(env && lp);
+	if (!armed)  armTerminate();
+	armed = false;
 	switch(method)
 	{
 		case 'S': CPX_CALL(CPXlpopt, env, lp); break;
@@ -108,6 +161,8 @@ void CPXModel::lpopt(char method)
 void CPXModel::mipopt()
 {
 	DOMINIQS_ASSERT(env && lp);
+	if (!armed)  armTerminate();
+	armed = false;
 	CPX_CALL(CPXmipopt, env, lp);
 }
 
@@ -165,15 +220,39 @@ bool CPXModel::isPrimalFeas() const
 }
 
 
+/* Basis */
+bool CPXModel::getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const
+{
+	DOMINIQS_ASSERT(env && lp);
+	int solnType = CPX_NO_SOLN;
+	CPX_CALL(CPXsolninfo, env, lp, nullptr, &solnType, nullptr, nullptr);
+	if (solnType != CPX_BASIC_SOLN)  return false;
+	// CPLEX status codes (CPX_AT_LOWER, CPX_BASIC, CPX_AT_UPPER, CPX_FREE_SUPER) match ours
+	cstat.resize(ncols());
+	rstat.resize(nrows());
+	CPX_CALL(CPXgetbase, env, lp, cstat.data(), rstat.data());
+	return true;
+}
+
+
+void CPXModel::setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat)
+{
+	DOMINIQS_ASSERT(env && lp);
+	DOMINIQS_ASSERT((int)cstat.size() == ncols() && (int)rstat.size() == nrows());
+	CPX_CALL(CPXcopybase, env, lp, cstat.data(), rstat.data());
+}
+
+
 /* Parameters */
 void CPXModel::handleCtrlC(bool flag)
 {
 	if (flag)
 	{
 		CPXModel_UserBreak = 0;
+		CPXModel_BreakFlag = terminateFlag.get();
 		previousHandler = ::signal(SIGINT, userSignalBreak);
 		restoreSignalHandler = true;
-		CPX_CALL( CPXsetterminate, env, &CPXModel_UserBreak );
+		armTerminate();
 	}
 	else
 	{
@@ -181,7 +260,7 @@ void CPXModel::handleCtrlC(bool flag)
 		{
 			::signal(SIGINT, previousHandler);
 			restoreSignalHandler = false;
-			CPX_CALL( CPXsetterminate, env, nullptr );
+			CPXModel_BreakFlag = nullptr;
 		}
 	}
 }
@@ -193,6 +272,29 @@ bool CPXModel::aborted() const
 }
 
 
+void CPXModel::interrupt()
+{
+	// this stops all the optimizations running in the same environment
+	*terminateFlag = 1;
+}
+
+
+void CPXModel::armInterrupt()
+{
+	armTerminate();
+	armed = true;
+}
+
+
+void CPXModel::armTerminate()
+{
+	// clear stale interrupts (but not a pending user break) and make sure the flag is the one
+	// of this model (the env may have been shared with a model created by the caller)
+	*terminateFlag = CPXModel_UserBreak;
+	CPX_CALL( CPXsetterminate, env, terminateFlag.get() );
+}
+
+
 void CPXModel::seed(int seed)
 {
 	DOMINIQS_ASSERT(env);
@@ -227,6 +329,10 @@ int CPXModel::intParam(IntParam which) const
 		case IntParam::IterLimit:
 			CPX_CALL(CPXgetintparam, env, CPX_PARAM_ITLIM, &value);
 			break;
+		case IntParam::Crossover:
+			CPX_CALL(CPXgetintparam, env, CPX_PARAM_BARCROSSALG, &value);
+			value = (value != CPX_ALG_NONE);
+			break;
 		default:
 			throw std::runtime_error("Unknown integer parameter");
 	}
@@ -253,6 +359,9 @@ void CPXModel::intParam(IntParam which, int value)
 		case IntParam::IterLimit:
 			CPX_CALL(CPXsetintparam, env, CPX_PARAM_ITLIM, value);
 			break;
+		case IntParam::Crossover:
+			CPX_CALL(CPXsetintparam, env, CPX_PARAM_BARCROSSALG, value ? CPX_ALG_AUTOMATIC : CPX_ALG_NONE);
+			break;
 		default:
 			throw std::runtime_error("Unknown integer parameter");
 	}
@@ -275,6 +384,12 @@ double CPXModel::dblParam(DblParam which) const
 		case DblParam::IntegralityTolerance:
 			CPX_CALL(CPXgetdblparam, env, CPX_PARAM_EPINT, &value);
 			break;
+		case DblParam::ObjLowerLimit:
+			CPX_CALL(CPXgetdblparam, env, CPX_PARAM_OBJLLIM, &value);
+			break;
+		case DblParam::ObjUpperLimit:
+			CPX_CALL(CPXgetdblparam, env, CPX_PARAM_OBJULIM, &value);
+			break;
 		default:
 			throw std::runtime_error("Unknown double parameter");
 	}
@@ -297,6 +412,12 @@ void CPXModel::dblParam(DblParam which, double value)
 		case DblParam::IntegralityTolerance:
 			CPX_CALL(CPXsetdblparam, env, CPX_PARAM_EPINT, value);
 			break;
+		case DblParam::ObjLowerLimit:
+			CPX_CALL(CPXsetdblparam, env, CPX_PARAM_OBJLLIM, value);
+			break;
+		case DblParam::ObjUpperLimit:
+			CPX_CALL(CPXsetdblparam, env, CPX_PARAM_OBJULIM, value);
+			break;
 		default:
 			throw std::runtime_error("Unknown double parameter");
 	}
@@ -693,6 +814,52 @@ void CPXModel::addRow(const std::string& name, const int* idx, const double* val
 }
 
 
+void CPXModel::addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs)
+{
+	DOMINIQS_ASSERT(env && lp);
+	if (cnt <= 0)  return;
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	std::vector<char*> cnames;
+	for (const std::string& name: names)  cnames.push_back((char*)(name.c_str()));
+	// do not risk turning the model into a MIP
+	const char* ctypeptr = nullptr;
+	for (int k = 0; k < cnt; k++)
+	{
+		if (ctypes[k] != 'C')
+		{
+			ctypeptr = ctypes;
+			break;
+		}
+	}
+	CPX_CALL(CPXnewcols, env, lp, cnt, objs, lbs, ubs, ctypeptr, cnames.empty() ? nullptr : &cnames[0]);
+}
+
+
+void CPXModel::addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals)
+{
+	DOMINIQS_ASSERT(env && lp);
+	if (cnt <= 0)  return;
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	std::vector<char*> rnames;
+	for (const std::string& name: names)  rnames.push_back((char*)(name.c_str()));
+	// for ranged rows, we assue [rhs-rngval,rhs] while CPLEX uses [rhs, rhs+rngval]
+	std::vector<double> rhs(rhss, rhss + cnt);
+	std::vector<int> rngIdx;
+	std::vector<double> rngVal;
+	int first = nrows();
+	for (int k = 0; k < cnt; k++)
+	{
+		if (senses[k] != 'R')  continue;
+		DOMINIQS_ASSERT(rngvals && (rngvals[k] >= 0.0));
+		rhs[k] -= rngvals[k];
+		rngIdx.push_back(first + k);
+		rngVal.push_back(rngvals[k]);
+	}
+	CPX_CALL(CPXaddrows, env, lp, 0, cnt, beg[cnt], &rhs[0], senses, beg, idx, val, nullptr, rnames.empty() ? nullptr : &rnames[0]);
+	if (rngIdx.size())  CPX_CALL(CPXchgrngval, env, lp, rngIdx.size(), &rngIdx[0], &rngVal[0]);
+}
+
+
 void CPXModel::delRow(int ridx)
 {
 	DOMINIQS_ASSERT(env && lp);
@@ -727,6 +894,21 @@ void CPXModel::delCols(int first, int last)
 }
 
 
+void CPXModel::delRowSet(int cnt, const int* rows)
+{
+	DOMINIQS_ASSERT(env && lp);
+	if (cnt <= 0)  return;
+	int m = nrows();
+	std::vector<int> delstat(m, 0);
+	for (int k = 0; k < cnt; k++)
+	{
+		DOMINIQS_ASSERT((rows[k] >= 0) && (rows[k] < m));
+		delstat[rows[k]] = 1;
+	}
+	CPX_CALL(CPXdelsetrows, env, lp, &delstat[0]);
+}
+
+
 void CPXModel::objSense(ObjSense objsen)
 {
 	DOMINIQS_ASSERT(env && lp);
@@ -799,6 +981,25 @@ void CPXModel::objcoefs(int cnt, const int* cols, const double* values)
 }
 
 
+void CPXModel::rhs(int cnt, const int* rows, const double* values)
+{
+	DOMINIQS_ASSERT(env && lp);
+	if (cnt <= 0)  return;
+	// CPLEX ranged rows are [rhs,rhs+rngval]: shift the new rhs accordingly
+	std::vector<double> cpxRhs(values, values + cnt);
+	for (int k = 0; k < cnt; k++)
+	{
+		char sense;
+		CPX_CALL(CPXgetsense, env, lp, &sense, rows[k], rows[k]);
+		if (sense != 'R')  continue;
+		double rngval;
+		CPX_CALL(CPXgetrngval, env, lp, &rngval, rows[k], rows[k]);
+		cpxRhs[k] -= rngval;
+	}
+	CPX_CALL(CPXchgrhs, env, lp, cnt, rows, &cpxRhs[0]);
+}
+
+
 void CPXModel::ctype(int cidx, char val)
 {
 	DOMINIQS_ASSERT(env && lp);
@@ -829,7 +1030,53 @@ CPXModel* CPXModel::clone_impl() const
 	int status = 0;
 	CPXLPptr cloned = CPXcloneprob(env, lp, &status);
 	if (status)  throwCplexError(env, status);
-	return new CPXModel(env, cloned, false, true);
+	CPXModel* model = new CPXModel(env, cloned, false, true);
+	model->terminateFlag = terminateFlag;
+	return model;
+}
+
+
+CPXModel* CPXModel::concurrentclone_impl() const
+{
+	DOMINIQS_ASSERT(env && lp);
+	// parameters and the termination flag are per environment, and problems cannot be cloned
+	// across environments: copy parameters and data (no names) to a model with its own environment
+	std::unique_ptr<CPXModel> cloned(new CPXModel());
+	copyParams(env, cloned->env);
+	int n = ncols();
+	int m = nrows();
+	dominiqs::SparseMatrix matrix;
+	std::vector<int> matcnt(n);
+	std::vector<double> obj(n);
+	std::vector<double> xLb(n);
+	std::vector<double> xUb(n);
+	std::vector<char> senses(m);
+	std::vector<double> rhss(m);
+	std::vector<double> rngvals(m);
+	if (n)
+	{
+		cols(matrix);
+		for (int j = 0; j < n; j++)  matcnt[j] = ((j + 1 < n) ? matrix.matbeg[j + 1] : matrix.nnz) - matrix.matbeg[j];
+		objcoefs(&obj[0]);
+		lbs(&xLb[0]);
+		ubs(&xUb[0]);
+	}
+	if (m)
+	{
+		sense(&senses[0]);
+		rhs(&rhss[0]);
+		CPX_CALL(CPXgetrngval, env, lp, &rngvals[0], 0, m - 1);
+	}
+	CPX_CALL(CPXcopylp, cloned->env, cloned->lp, n, m, CPXgetobjsen(env, lp), obj.data(), rhss.data(), senses.data(),
+			matrix.matbeg.data(), matcnt.data(), matrix.matind.data(), matrix.matval.data(), xLb.data(), xUb.data(), rngvals.data());
+	CPX_CALL(CPXchgobjoffset, cloned->env, cloned->lp, objOffset());
+	if (n && (CPXgetprobtype(env, lp) != CPXPROB_LP))
+	{
+		std::vector<char> xType(n);
+		ctypes(&xType[0]);
+		CPX_CALL(CPXcopyctype, cloned->env, cloned->lp, xType.data());
+	}
+	return cloned.release();
 }
 
 
@@ -855,6 +1102,7 @@ CPXModel* CPXModel::presolvedmodel_impl()
 		CPXLPptr cloned = CPXcloneprob(env, redlp, &status);
 		if (status)  throwCplexError(env, status);
 		CPXModel* premodel = new CPXModel(env, cloned, false, true);
+		premodel->terminateFlag = terminateFlag;
 		return premodel;
 	}
 	DOMINIQS_ASSERT( false );
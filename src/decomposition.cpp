@@ -0,0 +1,315 @@
+/**
+ * @file decomposition.cpp
+ * @brief Block decomposition of the constraint graph, with one pump per block
+ */
+
+#include "feaspump/decomposition.h"
+#include "feaspump/feaspump.h"
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+
+#include <utils/asserter.h>
+#include <utils/floats.h>
+#include <utils/timer.h>
+#include <utils/consolelog.h>
+#include <propagator/domain.h>
+
+using namespace dominiqs;
+
+
+static int findRoot(std::vector<int>& parent, int j)
+{
+	while (parent[j] != j)
+	{
+		parent[j] = parent[parent[j]];
+		j = parent[j];
+	}
+	return j;
+}
+
+
+std::vector<Block> findBlocks(const MIPModelI& model, std::vector<int>& freeCols)
+{
+	int n = model.ncols();
+	int m = model.nrows();
+	std::vector<int> parent(n);
+	std::iota(parent.begin(), parent.end(), 0);
+	std::vector<int> rowRep(m, -1); //< a column of each row (-1 if the row is empty)
+	SparseVector row;
+	char sense;
+	double rhs;
+	double range;
+	for (int i = 0; i < m; i++)
+	{
+		model.row(i, row, sense, rhs, range);
+		if (!row.size())  continue;
+		const int* idx = row.idx();
+		int r = findRoot(parent, idx[0]);
+		for (unsigned int k = 1; k < row.size(); k++)
+		{
+			int s = findRoot(parent, idx[k]);
+			if (s != r)  parent[s] = r;
+		}
+		rowRep[i] = idx[0];
+	}
+	// collect blocks
+	std::vector<int> blockOf(n, -1);
+	std::vector<Block> blocks;
+	for (int i = 0; i < m; i++)
+	{
+		if (rowRep[i] < 0)  continue;
+		int r = findRoot(parent, rowRep[i]);
+		if (blockOf[r] < 0)
+		{
+			blockOf[r] = blocks.size();
+			blocks.emplace_back();
+		}
+		blocks[blockOf[r]].rows.push_back(i);
+	}
+	freeCols.clear();
+	for (int j = 0; j < n; j++)
+	{
+		int r = findRoot(parent, j);
+		if (blockOf[r] < 0)  freeCols.push_back(j);
+		else blocks[blockOf[r]].cols.push_back(j);
+	}
+	std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+		return a.cols.size() > b.cols.size();
+	});
+	return blocks;
+}
+
+
+bool DecomposedPump::decompose(MIPModelPtr _model)
+{
+	model = _model;
+	// empty rows are in no block: a violated one (e.g., 0 >= 1) would go unnoticed by the block pumps
+	int m = model->nrows();
+	SparseVector row;
+	char sense;
+	double rhs;
+	double range;
+	for (int i = 0; i < m; i++)
+	{
+		model->row(i, row, sense, rhs, range);
+		if (row.size())  continue;
+		bool violated = false;
+		if (sense == 'L')  violated = lessThan(rhs, 0.0);
+		else if (sense == 'G')  violated = greaterThan(rhs, 0.0);
+		else if (sense == 'E')  violated = !isNull(rhs);
+		else if (sense == 'R')  violated = lessThan(rhs, 0.0) || greaterThan(rhs - range, 0.0);
+		if (violated)
+		{
+			consoleWarn("Empty row {} is infeasible: not decomposing", i);
+			blocks.clear();
+			freeCols.clear();
+			blockCnt = 0;
+			return false;
+		}
+	}
+	blocks = findBlocks(*model, freeCols);
+	blockCnt = blocks.size();
+	return (blockCnt > 1);
+}
+
+
+MIPModelPtr DecomposedPump::subModel(const std::vector<int>& cols, const std::vector<int>& rows) const
+{
+	int n = model->ncols();
+	std::vector<int> local(n, -1);
+	for (unsigned int k = 0; k < cols.size(); k++)  local[cols[k]] = k;
+	// columns
+	std::vector<char> xType(n);
+	std::vector<double> xLb(n);
+	std::vector<double> xUb(n);
+	std::vector<double> obj(n);
+	std::vector<std::string> names;
+	model->ctypes(&xType[0]);
+	model->lbs(&xLb[0]);
+	model->ubs(&xUb[0]);
+	model->objcoefs(&obj[0]);
+	model->colNames(names);
+	std::vector<char> subType;
+	std::vector<double> subLb;
+	std::vector<double> subUb;
+	std::vector<double> subObj;
+	std::vector<std::string> subNames;
+	for (int j: cols)
+	{
+		subType.push_back(xType[j]);
+		subLb.push_back(xLb[j]);
+		subUb.push_back(xUb[j]);
+		subObj.push_back(obj[j]);
+		subNames.push_back(names[j]);
+	}
+	MIPModelPtr sub = newModel();
+	sub->logging(false);
+	sub->intParam(IntParam::Threads, 1);
+	sub->objSense(model->objSense());
+	sub->addEmptyCols(cols.size(), subNames, &subType[0], &subLb[0], &subUb[0], &subObj[0]);
+	// rows
+	std::vector<int> beg;
+	std::vector<int> idx;
+	std::vector<double> val;
+	std::vector<char> senses;
+	std::vector<double> rhss;
+	std::vector<double> ranges;
+	std::vector<std::string> rowNames;
+	SparseVector row;
+	char sense;
+	double rhs;
+	double range;
+	for (int i: rows)
+	{
+		model->row(i, row, sense, rhs, range);
+		beg.push_back(idx.size());
+		const int* ridx = row.idx();
+		const double* rcoef = row.coef();
+		for (unsigned int k = 0; k < row.size(); k++)
+		{
+			DOMINIQS_ASSERT( local[ridx[k]] >= 0 );
+			idx.push_back(local[ridx[k]]);
+			val.push_back(rcoef[k]);
+		}
+		senses.push_back(sense);
+		rhss.push_back(rhs);
+		ranges.push_back(range);
+		rowNames.push_back("r" + std::to_string(i));
+	}
+	beg.push_back(idx.size());
+	sub->addRows(rows.size(), rowNames, &beg[0], &idx[0], &val[0], &senses[0], &rhss[0], &ranges[0]);
+	return sub;
+}
+
+
+bool DecomposedPump::pumpModel(FeasibilityPump& fp, MIPModelPtr sub, const std::vector<int>& cols)
+{
+	fp.init(sub);
+	if (!fp.pump())  return false;
+	const std::vector<double>& subX = fp.solution();
+	DOMINIQS_ASSERT( subX.size() == cols.size() );
+	for (unsigned int k = 0; k < cols.size(); k++)  x[cols[k]] = subX[k];
+	return true;
+}
+
+
+bool DecomposedPump::pump(int numThreads)
+{
+	DOMINIQS_ASSERT( model );
+	int n = model->ncols();
+	x.assign(n, 0.0);
+	failedCnt = 0;
+	fallbackFound = false;
+	blockTime = 0.0;
+	fallbackTime = 0.0;
+
+	// free columns: best bound w.r.t. the objective (or the finite bound closest to zero)
+	if (!freeCols.empty())
+	{
+		std::vector<char> xType(n);
+		std::vector<double> xLb(n);
+		std::vector<double> xUb(n);
+		std::vector<double> obj(n);
+		model->ctypes(&xType[0]);
+		model->lbs(&xLb[0]);
+		model->ubs(&xUb[0]);
+		model->objcoefs(&obj[0]);
+		double dir = static_cast<double>(model->objSense());
+		for (int j: freeCols)
+		{
+			double lb = xLb[j];
+			double ub = xUb[j];
+			if (xType[j] != 'C')
+			{
+				lb = std::ceil(lb);
+				ub = std::floor(ub);
+			}
+			double c = dir * obj[j];
+			double v = std::max(lb, std::min(ub, 0.0));
+			if (c > 0.0 && lb > -INFBOUND)  v = lb;
+			if (c < 0.0 && ub < INFBOUND)  v = ub;
+			x[j] = v;
+		}
+	}
+
+	// sub-models and pumps are set up sequentially
+	FPOptions opts = FeasibilityPump::configOptions();
+	opts.verbose = false;
+	opts.handleCtrlC = false;
+	opts.asyncInit = false;
+	std::vector<MIPModelPtr> subs;
+	std::vector<std::unique_ptr<FeasibilityPump>> pumps;
+	for (const Block& b: blocks)
+	{
+		subs.push_back(subModel(b.cols, b.rows));
+		pumps.emplace_back(new FeasibilityPump());
+		pumps.back()->setOptions(opts);
+	}
+
+	// block pumps (blocks are sorted by size: the largest ones are picked first)
+	StopWatch watch(true);
+	if (numThreads <= 0)  numThreads = std::thread::hardware_concurrency();
+	numThreads = std::max(1, std::min(numThreads, blockCnt));
+	std::vector<char> found(blockCnt, 0);
+	std::atomic<int> nextBlock(0);
+	auto worker = [&]() {
+		while (true)
+		{
+			int b = nextBlock++;
+			if (b >= blockCnt)  break;
+			try
+			{
+				found[b] = pumpModel(*pumps[b], subs[b], blocks[b].cols);
+			}
+			catch (std::exception& e)
+			{
+				consoleWarn("Pump on block {} failed: {}", b, e.what());
+				found[b] = 0;
+			}
+			pumps[b]->reset();
+			subs[b].reset();
+		}
+	};
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++)  threads.emplace_back(worker);
+	for (auto& t: threads)  t.join();
+	watch.stop();
+	blockTime = watch.getTotal();
+
+	// fallback: a single pump on all the failed blocks
+	Block failed;
+	for (int b = 0; b < blockCnt; b++)
+	{
+		if (found[b])  continue;
+		failedCnt++;
+		failed.cols.insert(failed.cols.end(), blocks[b].cols.begin(), blocks[b].cols.end());
+		failed.rows.insert(failed.rows.end(), blocks[b].rows.begin(), blocks[b].rows.end());
+	}
+	if (!failedCnt)  return true;
+	std::sort(failed.cols.begin(), failed.cols.end());
+	std::sort(failed.rows.begin(), failed.rows.end());
+	watch.reset();
+	watch.start();
+	FeasibilityPump fp;
+	fp.setOptions(opts);
+	fallbackFound = pumpModel(fp, subModel(failed.cols, failed.rows), failed.cols);
+	watch.stop();
+	fallbackTime = watch.getTotal();
+	return fallbackFound;
+}
+
+
+void DecomposedPump::logStats() const
+{
+	consoleInfo("[decomposition]");
+	consoleLog("decompBlocks = {}", blockCnt);
+	consoleLog("decompFreeCols = {}", freeCols.size());
+	if (!blocks.empty())  consoleLog("decompLargestBlock = {}", blocks[0].cols.size());
+	consoleLog("decompFailedBlocks = {}", failedCnt);
+	consoleLog("decompFallbackFound = {}", fallbackFound);
+	consoleLog("decompBlockTime = {}", blockTime);
+	consoleLog("decompFallbackTime = {}", fallbackTime);
+}
@@ -23,15 +23,50 @@
 #include <fmt/format.h>
 
 #include "feaspump/feaspump.h"
+#include "feaspump/memmodel.h"
 
 using namespace dominiqs;
 
 // macro type savers
-#define READ_FROM_CONFIG( what, defValue ) what = gConfig().get("fp."#what, defValue)
+#define READ_FROM_CONFIG( what ) opts.what = gConfig().get("fp."#what, opts.what)
 #define LOG_ITEM(name, value) consoleLog("{} = {}", name, value)
 #define LOG_CONFIG( what ) LOG_ITEM("fp."#what, what)
 
 
+/** Constraint data of a model, copied with bulk queries (rows in CSR format with rowBeg of size nrows+1) */
+struct ModelSnapshot
+{
+	SparseMatrix matrix;
+	std::vector<int> rowBeg;
+	std::vector<char> sense;
+	std::vector<double> rhs;
+	std::vector<double> rngval;
+};
+
+static void takeSnapshot(const MIPModelI& model, ModelSnapshot& data)
+{
+	int m = model.nrows();
+	data.rowBeg.resize(m + 1);
+	data.sense.resize(m);
+	data.rhs.resize(m);
+	data.rngval.assign(m, 0.0);
+	if (!m)  return;
+	model.rows(data.matrix);
+	// backends differ on whether matbeg has the final entry
+	std::copy(data.matrix.matbeg.begin(), data.matrix.matbeg.begin() + m, data.rowBeg.begin());
+	data.rowBeg[m] = data.matrix.nnz;
+	model.sense(&data.sense[0]);
+	model.rhs(&data.rhs[0]);
+	// ranged rows are rare: get their rhs and range (in our convention) one by one
+	for (int i = 0; i < m; i++)
+	{
+		if (data.sense[i] != 'R')  continue;
+		SparseVector row;
+		model.row(i, row, data.sense[i], data.rhs[i], data.rngval[i]);
+	}
+}
+
+
 static bool isSolutionInteger(const std::vector<int>& integers, const std::vector<double>& x, double eps)
 {
 	for (int j: integers) if (!isInteger(x[j], eps)) return false;
@@ -58,6 +93,15 @@ static bool areSolutionsEqual(const std::vector<int>& integers, const std::vecto
 	return true;
 }
 
+static bool isWithinBounds(const std::vector<double>& x, const std::vector<double>& lb, const std::vector<double>& ub, double eps)
+{
+	for (unsigned int j = 0; j < x.size(); j++)
+	{
+		if (lessThan(x[j], lb[j], eps) || greaterThan(x[j], ub[j], eps))  return false;
+	}
+	return true;
+}
+
 static bool isSolutionFeasible(const std::vector<double>& x, const std::vector<ConstraintPtr>& rows)
 {
 	for (auto c: rows) {
@@ -66,110 +110,309 @@ static bool isSolutionFeasible(const std::vector<double>& x, const std::vector<C
 	return true;
 }
 
+/** violation of every row by x (positive = violated, negative = slack), in a single pass over the rows */
+static void rowViolations(const std::vector<ConstraintPtr>& rows, const std::vector<double>& x, std::vector<double>& viol)
+{
+	int m = rows.size();
+	viol.resize(m);
+	for (int i = 0; i < m; i++)  viol[i] = rows[i]->violation(&x[0]);
+}
 
-namespace dominiqs {
+/**
+ * Check with activity bounds whether the rows can be satisfied with the integer variables
+ * fixed to their values in x and the continuous ones free within their bounds
+ */
+static bool mightBeFeasible(const std::vector<double>& x, const std::vector<ConstraintPtr>& rows, const std::vector<char>& xType,
+							const std::vector<double>& lb, const std::vector<double>& ub, double infBound)
+{
+	for (auto c: rows)
+	{
+		double minAct = 0.0;
+		double maxAct = 0.0;
+		bool minInf = false;
+		bool maxInf = false;
+		const int* idx = c->row.idx();
+		const double* coef = c->row.coef();
+		int size = c->row.size();
+		for (int k = 0; k < size; k++)
+		{
+			int j = idx[k];
+			if (xType[j] != 'C')
+			{
+				minAct += coef[k] * x[j];
+				maxAct += coef[k] * x[j];
+				continue;
+			}
+			double l = (coef[k] > 0.0) ? lb[j] : ub[j];
+			double u = (coef[k] > 0.0) ? ub[j] : lb[j];
+			if (fabs(l) >= infBound)  minInf = true;
+			else minAct += coef[k] * l;
+			if (fabs(u) >= infBound)  maxInf = true;
+			else maxAct += coef[k] * u;
+		}
+		double lhs = (c->sense == 'L') ? -infBound : ((c->sense == 'R') ? c->rhs - c->range : c->rhs);
+		double rhs = (c->sense == 'G') ? infBound : c->rhs;
+		if (!minInf && isPositive(minAct - rhs))  return false;
+		if (!maxInf && isNegative(maxAct - lhs))  return false;
+	}
+	return true;
+}
 
-static const double DEF_TIME_LIMIT = 3600.0;
-static const double DEF_TIME_MULT = 100.0;
-static const double DEF_LPITER_MULT = -1.0;
-static const int DEF_STAGE_ITER_LIMIT = 50;
-static const int DEF_ITER_LIMIT = 100;
-static const int DEF_AVG_FLIPS = 20;
-static const double DEF_INTEGRALITY_EPS = 1e-6;
-static const uint64_t DEF_SEED = 0;
-static const double DEF_ALPHA = 0.0;
-static const double DEF_ALPHA_FACTOR = 0.9;
-static const double DEF_ALPHA_DIST = 0.005;
-static const bool DEF_DO_STAGE_3 = false;
-static const bool DEF_WALKSAT_PERTURBE = true;
-static const bool DEF_RANDOMIZE_LP = false;
-static const bool DEF_PENALTYOBJ = false;
-static const char DEF_FIRST_OPT_METHOD = 'S';
-static const char DEF_REOPT_METHOD = 'S';
 
+namespace dominiqs {
 
 static const double GEOM_FACTOR = 0.85;
 static const double BIGM = 1e9;
 static const double BIGBIGM = 1e15;
 static const double INFBOUND = 1e20;
+static const double NO_OBJ_LIMIT = 1e75;
+static const int LP_EXPLORE_FREQ = 10; //< adaptive LP strategy: try the slowest method every LP_EXPLORE_FREQ solves
+static const double LP_TIME_DECAY = 0.3; //< adaptive LP strategy: weight of the last solve time in the average
 
 
-FeasibilityPump::FeasibilityPump() :
-	timeLimit(DEF_TIME_LIMIT), timeMult(DEF_TIME_MULT), lpIterMult(DEF_LPITER_MULT),
-	stageIterLimit(DEF_STAGE_ITER_LIMIT), iterLimit(DEF_ITER_LIMIT),
-	avgFlips(DEF_AVG_FLIPS), integralityEps(DEF_INTEGRALITY_EPS), seed(DEF_SEED),
-	alpha(DEF_ALPHA), alphaFactor(DEF_ALPHA_FACTOR), alphaDist(DEF_ALPHA_DIST),
-	doStage3(DEF_DO_STAGE_3), walksatPerturbe(DEF_WALKSAT_PERTURBE),
-	randomizeLP(DEF_RANDOMIZE_LP), penaltyObj(DEF_PENALTYOBJ),
-	firstOptMethod(DEF_FIRST_OPT_METHOD), reOptMethod(DEF_REOPT_METHOD),
-	objOffset(0.0), hasIncumbent(false)
+static char parseOptMethod(const std::string& method)
 {
+	if (method == "default") return 'S';
+	else if (method == "primal") return 'P';
+	else if (method == "dual") return 'D';
+	else if (method == "barrier") return 'B';
+	else throw std::runtime_error(std::string("Unknown optimization method: ") + method);
 }
 
+static std::string optMethodName(char method)
+{
+	switch (method)
+	{
+		case 'P': return "primal";
+		case 'D': return "dual";
+		case 'B': return "barrier";
+		default: return "default";
+	}
+}
 
-void FeasibilityPump::readConfig()
+static LPStrategy parseLPStrategy(const std::string& strategy)
 {
-	std::string frac2intName = gConfig().get("fp.frac2int", std::string("propround"));
-	frac2int = SolutionTransformerPtr(TransformersFactory::getInstance().create(frac2intName));
-	DOMINIQS_ASSERT( frac2int );
+	if (strategy == "fixed") return LPStrategy::Fixed;
+	else if (strategy == "adaptive") return LPStrategy::Adaptive;
+	else if (strategy == "race") return LPStrategy::Race;
+	else throw std::runtime_error(std::string("Unknown LP strategy: ") + strategy);
+}
+
+static std::string lpStrategyName(LPStrategy strategy)
+{
+	switch (strategy)
+	{
+		case LPStrategy::Adaptive: return "adaptive";
+		case LPStrategy::Race: return "race";
+		default: return "fixed";
+	}
+}
+
+static BanditPolicy parseBanditPolicy(const std::string& policy)
+{
+	if (policy == "off") return BanditPolicy::Off;
+	else if (policy == "egreedy") return BanditPolicy::EpsGreedy;
+	else if (policy == "ucb") return BanditPolicy::UCB;
+	else throw std::runtime_error(std::string("Unknown bandit policy: ") + policy);
+}
+
+static std::string banditPolicyName(BanditPolicy policy)
+{
+	switch (policy)
+	{
+		case BanditPolicy::EpsGreedy: return "egreedy";
+		case BanditPolicy::UCB: return "ucb";
+		default: return "off";
+	}
+}
+
+/** number of rows violated by x */
+static int numViolatedRows(const std::vector<double>& x, const std::vector<ConstraintPtr>& rows)
+{
+	int cnt = 0;
+	for (auto c: rows)
+	{
+		if (!c->satisfiedBy(&x[0]))  cnt++;
+	}
+	return cnt;
+}
+
+/** index of a simplex method in FeasibilityPump::lpStats */
+static int lpMethodIndex(char method)
+{
+	return (method == 'P') ? 0 : 1;
+}
+
+
+FeasibilityPump::FeasibilityPump() : objOffset(0.0), phase(Phase::Idle), status(FPStatus::InProgress),
+	hasIncumbent(false), numSols(0), firstSolTime(0.0), bestSolTime(0.0), cutoffRow(-1), wsActive(false), wsViolValid(false), rootTime(0.0), rootLpIter(0), rootBoundCnt(0), totLpIter(0)
+{
+	loadOptions(FPOptions());
+}
+
+
+FPOptions FeasibilityPump::configOptions()
+{
+	FPOptions opts;
+	opts.frac2int = gConfig().get("fp.frac2int", opts.frac2int);
 	// optimization methods
-	std::string firstMethod = gConfig().get("fp.firstOptMethod", std::string("default"));
-	if (firstMethod == "default") firstOptMethod = 'S';
-	else if (firstMethod == "primal") firstOptMethod = 'P';
-	else if (firstMethod == "dual") firstOptMethod = 'D';
-	else if (firstMethod == "barrier") firstOptMethod = 'B';
-	else throw std::runtime_error(std::string("Unknown optimization method: ") + firstMethod);
-	std::string reMethod = gConfig().get("fp.reOptMethod", std::string("default"));
-	if (reMethod == "default") reOptMethod = 'S';
-	else if (reMethod == "primal") reOptMethod = 'P';
-	else if (reMethod == "dual") reOptMethod = 'D';
-	else if (reMethod == "barrier") reOptMethod = 'B';
-	else throw std::runtime_error(std::string("Unknown optimization method: ") + reMethod);
+	opts.firstOptMethod = parseOptMethod(gConfig().get("fp.firstOptMethod", std::string("default")));
+	opts.reOptMethod = parseOptMethod(gConfig().get("fp.reOptMethod", std::string("default")));
+	opts.lpStrategy = parseLPStrategy(gConfig().get("fp.lpStrategy", std::string("fixed")));
+	READ_FROM_CONFIG( rootCrossover );
+	opts.bandit = parseBanditPolicy(gConfig().get("fp.bandit", std::string("off")));
+	READ_FROM_CONFIG( banditEps );
 	//other options
-	READ_FROM_CONFIG( timeLimit, DEF_TIME_LIMIT );
-	READ_FROM_CONFIG( timeMult, DEF_TIME_MULT );
-	READ_FROM_CONFIG( lpIterMult, DEF_LPITER_MULT );
-	READ_FROM_CONFIG( stageIterLimit, DEF_STAGE_ITER_LIMIT );
-	READ_FROM_CONFIG( iterLimit, DEF_ITER_LIMIT );
-	READ_FROM_CONFIG( avgFlips, DEF_AVG_FLIPS );
-	READ_FROM_CONFIG( integralityEps, DEF_INTEGRALITY_EPS );
-	seed = gConfig().get<uint64_t>("seed", DEF_SEED);
-	READ_FROM_CONFIG( alpha, DEF_ALPHA );
-	READ_FROM_CONFIG( alphaFactor, DEF_ALPHA_FACTOR );
-	READ_FROM_CONFIG( alphaDist, DEF_ALPHA_DIST );
-	READ_FROM_CONFIG( doStage3, DEF_DO_STAGE_3 );
-	READ_FROM_CONFIG( walksatPerturbe, DEF_WALKSAT_PERTURBE );
-	READ_FROM_CONFIG( randomizeLP, DEF_RANDOMIZE_LP );
-	READ_FROM_CONFIG( penaltyObj, DEF_PENALTYOBJ );
+	READ_FROM_CONFIG( timeLimit );
+	READ_FROM_CONFIG( timeMult );
+	READ_FROM_CONFIG( lpIterMult );
+	READ_FROM_CONFIG( stageIterLimit );
+	READ_FROM_CONFIG( iterLimit );
+	READ_FROM_CONFIG( lpIterBudget );
+	READ_FROM_CONFIG( avgFlips );
+	READ_FROM_CONFIG( tabuTenure );
+	READ_FROM_CONFIG( tabuAspiration );
+	READ_FROM_CONFIG( integralityEps );
+	opts.seed = gConfig().get<uint64_t>("seed", opts.seed);
+	READ_FROM_CONFIG( alpha );
+	READ_FROM_CONFIG( alphaFactor );
+	READ_FROM_CONFIG( alphaDist );
+	READ_FROM_CONFIG( doStage3 );
+	READ_FROM_CONFIG( walksatPerturbe );
+	READ_FROM_CONFIG( randomizeLP );
+	READ_FROM_CONFIG( penaltyObj );
+	READ_FROM_CONFIG( contCompletion );
+	READ_FROM_CONFIG( polish );
+	READ_FROM_CONFIG( numRefs );
+	READ_FROM_CONFIG( refWeight );
+	READ_FROM_CONFIG( refDecay );
+	READ_FROM_CONFIG( refBestWeight );
+	READ_FROM_CONFIG( lpCutoff );
+	READ_FROM_CONFIG( workingSet );
+	READ_FROM_CONFIG( workingSetAge );
+	READ_FROM_CONFIG( verbose );
+	READ_FROM_CONFIG( handleCtrlC );
+	READ_FROM_CONFIG( asyncInit );
+	READ_FROM_CONFIG( improve );
+	READ_FROM_CONFIG( improveGap );
+	READ_FROM_CONFIG( poolSize );
+	READ_FROM_CONFIG( poolMinDist );
+	return opts;
+}
+
+
+void FeasibilityPump::readConfig()
+{
 	// display options
 	display.headerInterval = gConfig().get("headerInterval", 10);
 	display.iterationInterval = gConfig().get("iterationInterval", 1);
+	setOptions(configOptions());
+}
+
+
+void FeasibilityPump::setOptions(const FPOptions& opts)
+{
+	discardInit();
+	frac2int = SolutionTransformerPtr(TransformersFactory::getInstance().create(opts.frac2int));
+	if (!frac2int)  throw std::runtime_error(std::string("Unknown rounder: ") + opts.frac2int);
+	loadOptions(opts);
 	// log config
-	consoleInfo("[config fp]");
-	LOG_ITEM("fp.frac2int", frac2intName);
-	LOG_ITEM("fp.firstOptMethod", firstMethod);
-	LOG_ITEM("fp.reOptMethod", reMethod);
-	LOG_CONFIG( timeLimit );
-	LOG_CONFIG( timeMult );
-	LOG_CONFIG( lpIterMult );
-	LOG_CONFIG( iterLimit );
-	LOG_CONFIG( stageIterLimit );
-	LOG_CONFIG( avgFlips );
-	LOG_CONFIG( integralityEps );
-	LOG_CONFIG( seed );
-	LOG_CONFIG( alpha );
-	LOG_CONFIG( alphaFactor );
-	LOG_CONFIG( alphaDist );
-	LOG_CONFIG( doStage3 );
-	LOG_CONFIG( walksatPerturbe );
-	LOG_CONFIG( randomizeLP );
-	LOG_CONFIG( penaltyObj );
+	if (verbose)
+	{
+		consoleInfo("[config fp]");
+		LOG_ITEM("fp.frac2int", opts.frac2int);
+		LOG_ITEM("fp.firstOptMethod", optMethodName(firstOptMethod));
+		LOG_ITEM("fp.reOptMethod", optMethodName(reOptMethod));
+		LOG_ITEM("fp.lpStrategy", lpStrategyName(lpStrategy));
+		LOG_CONFIG( rootCrossover );
+		LOG_ITEM("fp.bandit", banditPolicyName(bandit));
+		LOG_CONFIG( banditEps );
+		LOG_CONFIG( timeLimit );
+		LOG_CONFIG( timeMult );
+		LOG_CONFIG( lpIterMult );
+		LOG_CONFIG( iterLimit );
+		LOG_CONFIG( stageIterLimit );
+		LOG_CONFIG( lpIterBudget );
+		LOG_CONFIG( avgFlips );
+		LOG_CONFIG( tabuTenure );
+		LOG_CONFIG( tabuAspiration );
+		LOG_CONFIG( integralityEps );
+		LOG_CONFIG( seed );
+		LOG_CONFIG( alpha );
+		LOG_CONFIG( alphaFactor );
+		LOG_CONFIG( alphaDist );
+		LOG_CONFIG( doStage3 );
+		LOG_CONFIG( walksatPerturbe );
+		LOG_CONFIG( randomizeLP );
+		LOG_CONFIG( penaltyObj );
+		LOG_CONFIG( contCompletion );
+		LOG_CONFIG( polish );
+		LOG_CONFIG( numRefs );
+		LOG_CONFIG( refWeight );
+		LOG_CONFIG( refDecay );
+		LOG_CONFIG( refBestWeight );
+		LOG_CONFIG( lpCutoff );
+		LOG_CONFIG( workingSet );
+		LOG_CONFIG( workingSetAge );
+		LOG_CONFIG( handleCtrlC );
+		LOG_CONFIG( asyncInit );
+		LOG_CONFIG( improve );
+		LOG_CONFIG( improveGap );
+		LOG_CONFIG( poolSize );
+		LOG_CONFIG( poolMinDist );
+	}
 	rnd.setSeed(seed);
 	rnd.warmUp();
+	frac2int->logging(verbose);
 	frac2int->readConfig();
 }
 
 
+void FeasibilityPump::loadOptions(const FPOptions& opts)
+{
+	firstOptMethod = opts.firstOptMethod;
+	reOptMethod = opts.reOptMethod;
+	lpStrategy = opts.lpStrategy;
+	bandit = opts.bandit;
+	banditEps = opts.banditEps;
+	rootCrossover = opts.rootCrossover;
+	timeLimit = opts.timeLimit;
+	timeMult = opts.timeMult;
+	lpIterMult = opts.lpIterMult;
+	stageIterLimit = opts.stageIterLimit;
+	iterLimit = opts.iterLimit;
+	lpIterBudget = opts.lpIterBudget;
+	avgFlips = opts.avgFlips;
+	tabuTenure = std::max(opts.tabuTenure, 0);
+	tabuAspiration = opts.tabuAspiration;
+	integralityEps = opts.integralityEps;
+	seed = opts.seed;
+	alpha = opts.alpha;
+	alphaFactor = opts.alphaFactor;
+	alphaDist = opts.alphaDist;
+	doStage3 = opts.doStage3;
+	walksatPerturbe = opts.walksatPerturbe;
+	randomizeLP = opts.randomizeLP;
+	penaltyObj = opts.penaltyObj;
+	contCompletion = opts.contCompletion;
+	polish = opts.polish;
+	numRefs = std::max(opts.numRefs, 0);
+	refWeight = opts.refWeight;
+	refDecay = opts.refDecay;
+	refBestWeight = opts.refBestWeight;
+	lpCutoff = opts.lpCutoff;
+	workingSet = opts.workingSet;
+	workingSetAge = std::max(opts.workingSetAge, 1);
+	verbose = opts.verbose;
+	handleCtrlC = opts.handleCtrlC;
+	asyncInit = opts.asyncInit;
+	improve = opts.improve;
+	improveGap = opts.improveGap;
+	poolSize = std::max(opts.poolSize, 1);
+	poolMinDist = opts.poolMinDist;
+}
+
+
 bool FeasibilityPump::foundSolution() const
 {
 	return hasIncumbent;
@@ -184,6 +427,23 @@ void FeasibilityPump::getSolution(std::vector<double>& x) const
 }
 
 
+void FeasibilityPump::getWarmStart(WarmStart& ws) const
+{
+	ws.cstat = rootCStat;
+	ws.rstat = rootRStat;
+	ws.closestPoint = closestPoint;
+	if (hasIncumbent)  ws.incumbent = incumbent;
+	else ws.incumbent.clear();
+}
+
+
+const std::vector<double>& FeasibilityPump::solution() const
+{
+	DOMINIQS_ASSERT( hasIncumbent );
+	return incumbent;
+}
+
+
 double FeasibilityPump::getSolutionValue(const std::vector<double>& x) const
 {
 	return std::inner_product(x.begin(), x.end(), obj.begin(), 0.0) + objOffset;
@@ -196,31 +456,201 @@ int FeasibilityPump::getIterations() const
 }
 
 void FeasibilityPump::reset()
+{
+	discardInit();
+	resetRun();
+	fixed.clear();
+	binaries.clear();
+	gintegers.clear();
+	integers.clear();
+	rows.clear();
+	xNames.clear();
+	rootBoundCnt = 0;
+	rootUndo.clear();
+	isPureInteger = false;
+	isBinary = false;
+	objOffset = 0.0;
+	polisher.reset();
+}
+
+void FeasibilityPump::resetRun()
 {
 	nitr = 0;
 	firstPerturbation = 0;
 	pertCnt = 0;
 	restartCnt = 0;
 	walksatCnt = 0;
+	tabuSkips = 0;
+	tabuAspirations = 0;
+	lastFlip.clear();
+	flipCnt.clear();
+	contChecks = 0;
+	contFound = 0;
+	contLP.reset();
+	contLPHas.clear();
+	polishCnt = 0;
+	polishGain = 0.0;
+	roundBandit.clear();
+	pertBandit.clear();
+	roundArm = -1;
+	pertArm = -1;
+	lastDist = -1.0;
+	lastViolated = 0;
+	maxRewardRate = 0.0;
 	lastRestart = 0;
 	flipsInRestart = 0;
 	maxFlipsInRestart = 0;
 	lastIntegerX.clear();
+	clearReferences();
 	chrono.reset();
 	lpWatch.reset();
 	roundWatch.reset();
-	fixed.clear();
-	binaries.clear();
-	gintegers.clear();
-	integers.clear();
-	rows.clear();
-	isPureInteger = false;
-	isBinary = false;
-	objOffset = 0.0;
 	model = MIPModelPtr();
 	closestPoint.clear();
 	closestDist = INFBOUND;
 	hasIncumbent = false;
+	pool.clear();
+	numSols = 0;
+	firstSolTime = 0.0;
+	bestSolTime = 0.0;
+	cutoffRow = -1;
+	wsActive = false;
+	wsRows.clear();
+	inLP.clear();
+	wsAge.clear();
+	wsPending.clear();
+	rowViol.clear();
+	wsViolValid = false;
+	wsNames.clear();
+	wsAdded = 0;
+	wsRemoved = 0;
+	wsResolves = 0;
+	wsMaxRows = 0;
+	phase = Phase::Idle;
+	status = FPStatus::InProgress;
+	rootTime = 0.0;
+	rootLpIter = 0;
+	totLpIter = 0;
+	lpStats[0] = LPMethodStats();
+	lpStats[1] = LPMethodStats();
+	lpChoices = 0;
+	racer.reset();
+	needBasis = false;
+	warmStart.clear();
+	rootCStat.clear();
+	rootRStat.clear();
+}
+
+void FeasibilityPump::classifyColumns()
+{
+	fixed.clear();
+	binaries.clear();
+	gintegers.clear();
+	integers.clear();
+	int n = xType.size();
+	for (int i = 0; i < n; i++)
+	{
+		// fixed variables are not considered integer variables, of any kind
+		// this is correct if the rounding function does not alter their value!
+		// this is trivially true for simple rounding, but some care must be
+		// taken for more elaborate strategies!!!
+		if ( equal(lb[i], ub[i], integralityEps) ) fixed.push_back(i);
+		else if ( xType[i] != 'C' )
+		{
+			integers.push_back(i);
+			if (xType[i] == 'B') binaries.push_back(i);
+			else                 gintegers.push_back(i);
+		}
+	}
+	isBinary = (gintegers.size() == 0);
+	isPureInteger = (fixed.size() + integers.size() == (unsigned int)n);
+}
+
+void FeasibilityPump::initRounding(MIPModelPtr m)
+{
+	frac2int->init(m, true);
+	// extract the rows
+	int nrows = m->nrows();
+	rows.resize(nrows);
+	for (int i = 0; i < nrows; i++)
+	{
+		ConstraintPtr c = std::make_shared<Constraint>();
+		m->row(i, c->row, c->sense, c->rhs, c->range);
+		rows[i] = c;
+	}
+}
+
+void FeasibilityPump::waitInit()
+{
+	if (!pendingInit.valid())  return;
+	StopWatch watch(true);
+	pendingInit.get(); //< rethrows the exceptions of the background thread
+	watch.stop();
+	consoleDebug(DebugLevel::Verbose, "asyncInit wait = {}", watch.getTotal());
+}
+
+void FeasibilityPump::applyRootBounds()
+{
+	// only actual tightenings (the bounds may have been changed since the rounder computed them)
+	ModelChanges changes;
+	frac2int->rootBounds(changes);
+	std::vector<int> lbCols;
+	std::vector<double> lbValues;
+	std::vector<int> ubCols;
+	std::vector<double> ubValues;
+	for (unsigned int k = 0; k < changes.lbCols.size(); k++)
+	{
+		int j = changes.lbCols[k];
+		double v = changes.lbValues[k];
+		if (!greaterThan(v, lb[j]) || greaterThan(v, ub[j]))  continue;
+		rootUndo.lb(j, lb[j]);
+		lb[j] = v;
+		lbCols.push_back(j);
+		lbValues.push_back(v);
+	}
+	for (unsigned int k = 0; k < changes.ubCols.size(); k++)
+	{
+		int j = changes.ubCols[k];
+		double v = changes.ubValues[k];
+		if (!lessThan(v, ub[j]) || lessThan(v, lb[j]))  continue;
+		rootUndo.ub(j, ub[j]);
+		ub[j] = v;
+		ubCols.push_back(j);
+		ubValues.push_back(v);
+	}
+	int cnt = lbCols.size() + ubCols.size();
+	if (!cnt)  return;
+	if (lbCols.size())  model->lbs(lbCols.size(), &lbCols[0], &lbValues[0]);
+	if (ubCols.size())  model->ubs(ubCols.size(), &ubCols[0], &ubValues[0]);
+	rootBoundCnt += cnt;
+	// root fixings drop out of the integer lists
+	classifyColumns();
+	if (verbose)
+	{
+		consoleLog("rootBounds = {} fixedCnt = {} #bins = {} #integers = {}",
+					cnt, fixed.size(), binaries.size(), gintegers.size());
+	}
+}
+
+void FeasibilityPump::undoRootBounds()
+{
+	if (rootUndo.empty())  return;
+	// in reverse order: a column tightened more than once gets its first recorded (original) value
+	for (int k = (int)rootUndo.lbCols.size() - 1; k >= 0; k--)  lb[rootUndo.lbCols[k]] = rootUndo.lbValues[k];
+	for (int k = (int)rootUndo.ubCols.size() - 1; k >= 0; k--)  ub[rootUndo.ubCols[k]] = rootUndo.ubValues[k];
+	for (unsigned int k = 0; k < rootUndo.lbCols.size(); k++)  rootUndo.lbValues[k] = lb[rootUndo.lbCols[k]];
+	for (unsigned int k = 0; k < rootUndo.ubCols.size(); k++)  rootUndo.ubValues[k] = ub[rootUndo.ubCols[k]];
+	if (rootUndo.lbCols.size())  model->lbs(rootUndo.lbCols.size(), &rootUndo.lbCols[0], &rootUndo.lbValues[0]);
+	if (rootUndo.ubCols.size())  model->ubs(rootUndo.ubCols.size(), &rootUndo.ubCols[0], &rootUndo.ubValues[0]);
+	rootUndo.clear();
+	classifyColumns();
+}
+
+void FeasibilityPump::discardInit()
+{
+	// no one will look at the results (or errors) of the background initialization
+	if (pendingInit.valid())  pendingInit.wait();
+	pendingInit = std::future<void>();
 }
 
 void FeasibilityPump::init(MIPModelPtr _model, const std::vector<char>& ctype)
@@ -228,7 +658,7 @@ void FeasibilityPump::init(MIPModelPtr _model, const std::vector<char>& ctype)
 	DOMINIQS_ASSERT( _model );
 	DOMINIQS_ASSERT( frac2int );
 	// INIT
-	consoleInfo("[fpInit]");
+	if (verbose)  consoleInfo("[fpInit]");
 	reset();
 	model = _model;
 	int n = model->ncols();
@@ -236,9 +666,10 @@ void FeasibilityPump::init(MIPModelPtr _model, const std::vector<char>& ctype)
 	if (ctype.size())
 	{
 		DOMINIQS_ASSERT(n == (int)ctype.size());
-		for (int j = 0; j < n; j++)  model->ctype(j, ctype[j]);
+		std::vector<int> colIndices(n);
+		std::iota(colIndices.begin(), colIndices.end(), 0);
+		model->ctypes(n, &colIndices[0], &ctype[0]);
 	}
-	frac2int->init(model, true);
 	frac_x.resize(n, 0);
 	integer_x.resize(n, 0);
 	obj.resize(n, 0);
@@ -252,49 +683,130 @@ void FeasibilityPump::init(MIPModelPtr _model, const std::vector<char>& ctype)
 	model->lbs(&lb[0]);
 	model->ubs(&ub[0]);
 	model->ctypes(&xType[0]);
-	for (int i = 0; i < n; i++)
+	model->colNames(xNames);
+	classifyColumns();
+	// init the rounder and extract the rows
+	if (asyncInit)
 	{
-		// fixed variables are not considered integer variables, of any kind
-		// this is correct if the rounding function does not alter their value!
-		// this is trivially true for simple rounding, but some care must be
-		// taken for more elaborate strategies!!!
-		if ( equal(lb[i], ub[i], integralityEps) ) fixed.push_back(i);
-		else if ( xType[i] != 'C' )
-		{
-			integers.push_back(i);
-			if (xType[i] == 'B') binaries.push_back(i);
-			else                 gintegers.push_back(i);
-		}
+		// they are not needed before the first rounding, so the work is done on a background
+		// thread while the initial LP is solved, from an in-memory snapshot of the problem
+		// (taken here with bulk queries, as the model itself cannot be shared between threads)
+		std::shared_ptr<MemModel> snapshot = std::make_shared<MemModel>();
+		std::shared_ptr<ModelSnapshot> data = std::make_shared<ModelSnapshot>();
+		takeSnapshot(*model, *data);
+		snapshot->addEmptyCols(n, xNames, &xType[0], &lb[0], &ub[0], &obj[0]);
+		pendingInit = std::async(std::launch::async, [this, data, snapshot]() {
+			int m = data->sense.size();
+			if (m)
+			{
+				snapshot->addRows(m, std::vector<std::string>(), &data->rowBeg[0], data->matrix.matind.data(),
+								data->matrix.matval.data(), &data->sense[0], &data->rhs[0], &data->rngval[0]);
+			}
+			initRounding(snapshot);
+		});
 	}
-	// extract the rows
-	int m = model->nrows();
-	rows.resize(m);
-	for (int i = 0; i < m; i++)
+	else
 	{
-		ConstraintPtr c = std::make_shared<Constraint>();
-		model->row(i, c->row, c->sense, c->rhs, c->range);
-		rows[i] = c;
+		// the root bounds of the rounder are available now: the initial LP also benefits
+		initRounding(model);
+		applyRootBounds();
 	}
 
-	isBinary = (gintegers.size() == 0);
-	isPureInteger = (fixed.size() + integers.size() == (unsigned int)n);
-	consoleLog("#cols = {} #bins = {} #integers = {}", n, binaries.size(), gintegers.size());
-	consoleLog("fixedCnt = {} isBinary = {} isPureInteger = {}",
-				fixed.size(), isBinary, isPureInteger);
+	if (verbose)
+	{
+		consoleLog("#cols = {} #bins = {} #integers = {}", n, binaries.size(), gintegers.size());
+		consoleLog("fixedCnt = {} isBinary = {} isPureInteger = {}",
+					fixed.size(), isBinary, isPureInteger);
+	}
 	objOffset = model->objOffset();
 	model->switchToLP();
 }
 
+void FeasibilityPump::update(MIPModelPtr _model, const ModelChanges& changes)
+{
+	DOMINIQS_ASSERT( _model );
+	DOMINIQS_ASSERT( frac2int );
+	waitInit();
+	int n = xType.size();
+	DOMINIQS_ASSERT( _model->ncols() == n );
+	DOMINIQS_ASSERT( _model->nrows() == (int)rows.size() );
+	DOMINIQS_ASSERT( changes.lbCols.size() == changes.lbValues.size() );
+	DOMINIQS_ASSERT( changes.ubCols.size() == changes.ubValues.size() );
+	DOMINIQS_ASSERT( changes.rhsRows.size() == changes.rhsValues.size() );
+	DOMINIQS_ASSERT( changes.objCols.size() == changes.objValues.size() );
+	if (verbose)  consoleInfo("[fpUpdate]");
+	resetRun();
+	model = _model;
+	// the bounds implied at the root may not hold after the changes: start from the original ones
+	// (nothing to do if the last run finished, as finish() already restored them)
+	undoRootBounds();
+	// apply the changes to the model
+	int lbCnt = changes.lbCols.size();
+	int ubCnt = changes.ubCols.size();
+	int rhsCnt = changes.rhsRows.size();
+	int objCnt = changes.objCols.size();
+	if (lbCnt)  model->lbs(lbCnt, &changes.lbCols[0], &changes.lbValues[0]);
+	if (ubCnt)  model->ubs(ubCnt, &changes.ubCols[0], &changes.ubValues[0]);
+	if (rhsCnt)  model->rhs(rhsCnt, &changes.rhsRows[0], &changes.rhsValues[0]);
+	if (objCnt)  model->objcoefs(objCnt, &changes.objCols[0], &changes.objValues[0]);
+	// patch the cached problem data
+	bool fixingsChanged = false;
+	for (int k = 0; k < lbCnt; k++)
+	{
+		int j = changes.lbCols[k];
+		bool wasFixed = equal(lb[j], ub[j], integralityEps);
+		lb[j] = changes.lbValues[k];
+		fixingsChanged |= (wasFixed != equal(lb[j], ub[j], integralityEps));
+	}
+	for (int k = 0; k < ubCnt; k++)
+	{
+		int j = changes.ubCols[k];
+		bool wasFixed = equal(lb[j], ub[j], integralityEps);
+		ub[j] = changes.ubValues[k];
+		fixingsChanged |= (wasFixed != equal(lb[j], ub[j], integralityEps));
+	}
+	if (fixingsChanged)  classifyColumns();
+	for (int k = 0; k < rhsCnt; k++)  rows[changes.rhsRows[k]]->rhs = changes.rhsValues[k];
+	for (int k = 0; k < objCnt; k++)  obj[changes.objCols[k]] = changes.objValues[k];
+	if (objCnt)  objNorm = sqrt(dotProduct(&obj[0], &obj[0], n));
+	// patch the rounder (or re-init it, giving it back the column types)
+	if (!frac2int->update(changes))
+	{
+		colIndices.resize(n);
+		std::iota(colIndices.begin(), colIndices.end(), 0);
+		model->ctypes(n, &colIndices[0], &xType[0]);
+		frac2int->init(model, true);
+		model->switchToLP();
+	}
+	applyRootBounds();
+	if (verbose)
+	{
+		consoleLog("#lbs = {} #ubs = {} #rhs = {} #obj = {}", lbCnt, ubCnt, rhsCnt, objCnt);
+		consoleLog("fixedCnt = {} isBinary = {} isPureInteger = {}",
+					fixed.size(), isBinary, isPureInteger);
+	}
+}
+
 
 bool FeasibilityPump::pump(const std::vector<double>& xStart, bool pFeas)
+{
+	start(xStart, pFeas);
+	FPStatus status = FPStatus::InProgress;
+	while (status == FPStatus::InProgress)  status = step(std::numeric_limits<int>::max());
+	return (status == FPStatus::Found);
+}
+
+
+void FeasibilityPump::start(const std::vector<double>& xStart, bool pFeas)
 {
 	DOMINIQS_ASSERT( model );
 	DOMINIQS_ASSERT( frac2int );
+	DOMINIQS_ASSERT( phase == Phase::Idle );
 	chrono.start();
 	int n = model->ncols();
 	primalFeas = false;
-	ObjSense origObjSense = model->objSense();
-	double dualBound = -static_cast<int>(origObjSense) * INFBOUND;
+	origObjSense = model->objSense();
+	dualBound = -static_cast<int>(origObjSense) * INFBOUND;
 	primalBound = static_cast<int>(origObjSense) * INFBOUND;
 
 	// setup iteration display
@@ -311,7 +823,7 @@ bool FeasibilityPump::pump(const std::vector<double>& xStart, bool pFeas)
 	display.addColumn("time", 15, 10);
 
 	// Ctrl-C handling
-	model->handleCtrlC(true);
+	if (handleCtrlC)  model->handleCtrlC(true);
 
 	// find first fractional solution (or use user supplied one)
 	// this sets up frac_x
@@ -323,18 +835,48 @@ bool FeasibilityPump::pump(const std::vector<double>& xStart, bool pFeas)
 	}
 	else
 	{
+		if (callbacks.progress)  callbacks.progress(0, elapsed());
 		solveInitialLP();
 		if (primalFeas)  dualBound = getSolutionValue(frac_x);
 	}
+	// the rounder and the rows are needed from here on
+	// (as when they are built in init(), the wait is not counted in the pump time)
+	chrono.stop();
+	waitInit();
+	chrono.start();
+	applyRootBounds();
+	initBandits();
+	if (xStart.empty())
+	{
+		// warm start points from a previous run on a similar model
+		const std::vector<double>& wsInc = warmStart.incumbent;
+		if (((int)wsInc.size() == n) && isSolutionInteger(integers, wsInc, integralityEps)
+			&& isWithinBounds(wsInc, lb, ub, integralityEps) && isSolutionFeasible(wsInc, rows))
+		{
+			if (verbose)  consoleLog("Warm start: incumbent of previous run still feasible");
+			frac_x = wsInc;
+			primalFeas = true;
+		}
+		else if ((int)warmStart.closestPoint.size() == n)
+		{
+			if (verbose)  consoleLog("Warm start: starting from closest point of previous run");
+			frac_x = warmStart.closestPoint;
+			primalFeas = false;
+		}
+	}
 	consoleDebug(DebugLevel::Verbose, "startNumFrac = {}", solutionNumFractional(integers, frac_x, integralityEps));
-	consoleLog("");
+	if (verbose)  consoleLog("");
+
 
+	// working set of the distance LPs (from the rows tight or violated at the starting point)
+	if (workingSet)  initWorkingSet();
 
 	// setup for changing objective function
 	model->objSense(ObjSense::MIN); //< change obj sense: minimize distance
 	model->objOffset(0.0); //< get rid of offset
 
-	double runningAlpha = alpha;
+	runningAlpha = alpha;
+	hasObjective = !isNull(objNorm);
 	// If there is no objective, there is no need to use the objective FP
 	if (isNull(objNorm))
 	{
@@ -344,85 +886,513 @@ bool FeasibilityPump::pump(const std::vector<double>& xStart, bool pFeas)
 	if (runningAlpha == 0.0)  display.setVisible("alpha", false);
 
 
-	consoleInfo("[pump]");
-	display.printHeader(std::cout);
+	if (verbose)
+	{
+		consoleInfo("[pump]");
+		display.printHeader(std::cout);
+	}
 
 	// stage 1
-	bool found = pumpLoop(runningAlpha, 1);
+	startStage(Phase::Stage1);
+	chrono.stop();
+}
+
 
-	// stage 2 specific setup
-	maxFlipsInRestart = std::max(int(gintegers.size() / 10.0), 10);
-	consoleDebug(DebugLevel::Verbose, "maxFlipsInRestart = {}", maxFlipsInRestart);
-	if (closestPoint.empty())
+FPStatus FeasibilityPump::step(int iterBudget)
+{
+	DOMINIQS_ASSERT( phase != Phase::Idle );
+	if (phase == Phase::Done)  return status;
+	chrono.start();
+	int done = 0;
+	while (phase != Phase::Done)
 	{
-		// no iterations were made in stage 1
-		// we can still use frac_x
+		if (((phase == Phase::Stage1) || (phase == Phase::Stage2)) && !stageContinues())
+		{
+			nextPhase();
+			continue;
+		}
+		if (done >= iterBudget)  break;
+		if (phase == Phase::Stage3)
+		{
+			stage3Found = stage3();
+			nextPhase();
+		}
+		else pumpIteration();
+		done++;
 	}
-	else
+	if (phase != Phase::Done)  chrono.stop();
+	return status;
+}
+
+
+void FeasibilityPump::startStage(Phase newPhase)
+{
+	phase = newPhase;
+	int stage = currentStage();
+	if (callbacks.progress)  callbacks.progress(stage, elapsed());
+	if (phase == Phase::Stage3)
 	{
-		// use closest point as starting vector for the next pumping loop
-		frac_x = closestPoint;
-		primalFeas = false;
+		// the MIP needs all the rows
+		if (wsActive)  restoreRows();
+		return;
 	}
-	closestDist = INFBOUND;
+	lastIntegerX.clear();
+	clearReferences();
+	stageStartIter = nitr;
+	lastDist = -1.0;
+	frac2int->ignoreGeneralIntegers(stage == 1);
+	// relative limits make sense only if we solved the initial LP ourselves
+	pumpTimeLimit = ((timeMult > 0.0) && (rootTime > 0.0)) ? timeMult*rootTime : std::numeric_limits<double>::max();
+	lpIterLimit = -1;
+	if ((lpIterMult > 0.0) && (rootLpIter > 0))
+	{
+		lpIterLimit = int(rootLpIter * lpIterMult);
+		lpIterLimit = std::max(lpIterLimit, 10);
+	}
+}
 
-	// stage 2
-	// can skip stage 2 only if we have found a stage-1 solution and there are no general integers
-	if (!found || gintegers.size())  found = pumpLoop(runningAlpha, 2);
 
-	consoleLog("");
+bool FeasibilityPump::stageContinues()
+{
+	if (model->aborted() || stopRequested())  return false;
+	if (((nitr - stageStartIter) >= stageIterLimit) || (nitr >= iterLimit))  return false;
+	// check if frac_x is feasible (w.r.t. the integer variables in this stage)
+	const auto& intSubset = (currentStage() == 1) ? binaries : integers;
+	if (primalFeas && isSolutionInteger(intSubset, frac_x, integralityEps))
+	{
+		// update closest point
+		closestDist = 0.0;
+		closestPoint = frac_x;
+		// then break this stage
+		return false;
+	}
+	// global timelimit check
+	double timeLeft = std::max(std::min(timeLimit, pumpTimeLimit) - elapsed(), 0.0);
+	return (timeLeft > 0.0);
+}
+
+
+void FeasibilityPump::nextPhase()
+{
+	bool found = (primalFeas && isSolutionInteger(integers, frac_x, integralityEps));
+	if (phase == Phase::Stage1)
+	{
+		// stage 2 specific setup
+		maxFlipsInRestart = std::max(int(gintegers.size() / 10.0), 10);
+		consoleDebug(DebugLevel::Verbose, "maxFlipsInRestart = {}", maxFlipsInRestart);
+		if (closestPoint.empty())
+		{
+			// no iterations were made in stage 1
+			// we can still use frac_x
+		}
+		else
+		{
+			// use closest point as starting vector for the next pumping loop
+			frac_x = closestPoint;
+			primalFeas = false;
+		}
+		closestDist = INFBOUND;
+		// can skip stage 2 only if we have found a stage-1 solution and there are no general integers
+		if (!found || gintegers.size())
+		{
+			startStage(Phase::Stage2);
+			return;
+		}
+	}
+	if (phase == Phase::Stage3)  found = stage3Found;
+	else if (!found && doStage3)
+	{
+		if (verbose)  consoleLog("");
+		startStage(Phase::Stage3);
+		return;
+	}
+	if (found && improve)
+	{
+		// record the solution here (the cutoff makes it better than the incumbent, up to tolerances),
+		// then look for a better one
+		double value = getSolutionValue(frac_x);
+		if (!hasIncumbent || (static_cast<int>(origObjSense) * (value - primalBound) < 0.0))  foundIncumbent(frac_x, value);
+		if (canImprove())
+		{
+			startImprovement();
+			return;
+		}
+		found = false;
+	}
+	if (verbose)  consoleLog("");
+	finish(found);
+}
+
+
+bool FeasibilityPump::canImprove()
+{
+	if (!hasObjective || model->aborted() || stopRequested() || (nitr >= iterLimit))  return false;
+	double timeLeft = std::min(timeLimit, pumpTimeLimit) - elapsed();
+	return (timeLeft > 0.0);
+}
+
+
+void FeasibilityPump::startImprovement()
+{
+	int n = frac_x.size();
+	// cutoff row in the original sense: obj x <= (or >=) primalBound -/+ delta
+	double delta = std::max(improveGap * fabs(primalBound), integralityEps);
+	double sign = static_cast<int>(origObjSense);
+	double cutoffRhs = primalBound - objOffset - sign * delta;
+	if (cutoffRow < 0)
+	{
+		std::vector<int> idx;
+		std::vector<double> val;
+		for (int j = 0; j < n; j++)
+		{
+			if (isNull(obj[j]))  continue;
+			idx.push_back(j);
+			val.push_back(obj[j]);
+		}
+		cutoffRow = numModelRows();
+		model->addRow("fp_cutoff", &idx[0], &val[0], idx.size(), (sign > 0) ? 'L' : 'G', cutoffRhs);
+		if (racer)  racer->addRow("fp_cutoff", &idx[0], &val[0], idx.size(), (sign > 0) ? 'L' : 'G', cutoffRhs);
+		if (wsActive)  wsRows.push_back(-1);
+	}
+	else
+	{
+		model->rhs(1, &cutoffRow, &cutoffRhs);
+		if (racer)  racer->rhs(1, &cutoffRow, &cutoffRhs);
+	}
+	// the completion LP is rebuilt with the new cutoff
+	contLP.reset();
+	contLPHas.clear();
+	// the rounder wants it as a 'L' row
+	ConstraintPtr cutoff = std::make_shared<Constraint>();
+	cutoff->name = "fp_cutoff";
+	cutoff->sense = 'L';
+	cutoff->rhs = sign * cutoffRhs;
+	for (int j = 0; j < n; j++)
+	{
+		if (!isNull(obj[j]))  cutoff->row.push(j, sign * obj[j]);
+	}
+	frac2int->objectiveCutoff(cutoff);
+	if (verbose)
+	{
+		consoleLog("");
+		consoleLog("Improvement: primalBound={} cutoff={}", primalBound, cutoffRhs + objOffset);
+	}
+
+	// pump again with the objective FP, starting from the incumbent (which now violates the cutoff)
+	primalFeas = false;
+	closestPoint.clear();
+	closestDist = INFBOUND;
+	runningAlpha = 1.0;
+	display.setVisible("alpha", true);
+	startStage(Phase::Stage1);
+}
 
-	// stage 3
-	if (!found && doStage3)  found = stage3();
 
+void FeasibilityPump::finish(bool found)
+{
+	int n = frac_x.size();
 	if (found)  foundIncumbent(frac_x, getSolutionValue(frac_x));
 
-	model->handleCtrlC(false);
+	if (handleCtrlC)  model->handleCtrlC(false);
 	chrono.stop();
 
+	// back to the full LP, with the original bounds
+	if (wsActive)  restoreRows();
+	undoRootBounds();
+
+	contLP.reset();
+	contLPHas.clear();
+	racer.reset();
+
+	// remove the objective cutoff
+	if (cutoffRow >= 0)
+	{
+		model->delRow(cutoffRow);
+		frac2int->objectiveCutoff(nullptr);
+		cutoffRow = -1;
+	}
+
 	// restore objective stuff
+	colIndices.resize(n);
+	std::iota(colIndices.begin(), colIndices.end(), 0);
+	model->objcoefs(n, &colIndices[0], &obj[0]);
 	model->objSense(origObjSense);
 	model->objOffset(objOffset);
 
+	// back to the configured rounding operator
+	if (roundBandit.size())  frac2int->setOperator(0);
+
 	model = MIPModelPtr();
+	phase = Phase::Done;
+	status = hasIncumbent ? FPStatus::Found : FPStatus::NotFound;
+
+	if (!verbose)  return;
+	consoleLog("");
+	consoleInfo("[results]");
+	LOG_ITEM("primalBound", primalBound);
+	LOG_ITEM("dualBound", dualBound);
+	LOG_ITEM("objSense", origObjSense);
+	LOG_ITEM("numSols", numSols);
+	if (improve)
+	{
+		LOG_ITEM("poolSize", pool.size());
+		LOG_ITEM("timeToFirst", firstSolTime);
+		LOG_ITEM("timeToBest", bestSolTime);
+	}
+	LOG_ITEM("totalLpTime", lpWatch.getTotal());
+	LOG_ITEM("totalRoundingTime", roundWatch.getTotal());
+	LOG_ITEM("iterations", nitr);
+	LOG_ITEM("lpIterations", totLpIter);
+	LOG_ITEM("rootTime", rootTime);
+	LOG_ITEM("rootBoundCnt", rootBoundCnt);
+	LOG_ITEM("time", chrono.getTotal());
+	LOG_ITEM("firstPerturbation", firstPerturbation);
+	LOG_ITEM("perturbationCnt", pertCnt);
+	LOG_ITEM("restartCnt", restartCnt);
+	LOG_ITEM("walksatCnt", walksatCnt);
+	if (tabuTenure > 0)
+	{
+		LOG_ITEM("tabuSkips", tabuSkips);
+		LOG_ITEM("tabuAspirations", tabuAspirations);
+	}
+	if (!isPureInteger && contCompletion)
+	{
+		LOG_ITEM("contChecks", contChecks);
+		LOG_ITEM("contFound", contFound);
+	}
+	if (workingSet)
+	{
+		LOG_ITEM("wsMaxRows", wsMaxRows);
+		LOG_ITEM("wsAdded", wsAdded);
+		LOG_ITEM("wsRemoved", wsRemoved);
+		LOG_ITEM("wsResolves", wsResolves);
+	}
+	if (polish)
+	{
+		LOG_ITEM("polishCnt", polishCnt);
+		LOG_ITEM("polishGain", polishGain);
+	}
+	for (const Bandit* b: {&roundBandit, &pertBandit})
+	{
+		for (int k = 0; k < b->size(); k++)
+		{
+			const BanditArm& arm = b->arm(k);
+			LOG_ITEM(arm.name + "Pulls", arm.pulls);
+			LOG_ITEM(arm.name + "Reward", arm.pulls ? (arm.totReward / arm.pulls) : 0.0);
+			LOG_ITEM(arm.name + "Time", arm.time);
+		}
+	}
+	if (lpStrategy == LPStrategy::Fixed)  return;
+	for (char method: {'P', 'D'})
+	{
+		const LPMethodStats& stats = lpStats[lpMethodIndex(method)];
+		std::string name = optMethodName(method);
+		if (lpStrategy == LPStrategy::Race)  LOG_ITEM(name + "Wins", stats.wins);
+		else LOG_ITEM(name + "Solves", stats.solves);
+		LOG_ITEM(name + "LpTime", stats.time);
+		LOG_ITEM(name + "LpIterations", stats.iters);
+	}
+}
+
+// feasiblity pump helpers
+
+double FeasibilityPump::elapsed() const
+{
+	// chrono only runs inside start() and step()
+	return chrono.getTotal() + chrono.getElapsed();
+}
+
+
+bool FeasibilityPump::stopRequested() const
+{
+	if (cancelToken && cancelToken->cancelled())  return true;
+	if ((lpIterBudget >= 0) && (totLpIter >= lpIterBudget))  return true;
+	return false;
+}
+
+
+int64_t FeasibilityPump::lastLpIterations() const
+{
+	int simplexIt = model->intAttr(IntAttr::SimplexIterations);
+	int barrierIt = model->intAttr(IntAttr::BarrierIterations);
+	return std::max(simplexIt, barrierIt);
+}
+
+
+char FeasibilityPump::chooseLPMethod()
+{
+	// try both methods first (primal is the natural choice after an objective change)
+	if (!lpStats[0].solves)  return 'P';
+	if (!lpStats[1].solves)  return 'D';
+	// then go with the fastest one on average, with some exploration of the other one
+	// (the relative speed can change during the run, e.g., with the distance function)
+	int best = (lpStats[0].avgTime <= lpStats[1].avgTime) ? 0 : 1;
+	if ((++lpChoices % LP_EXPLORE_FREQ) == 0)  best = 1 - best;
+	return best ? 'D' : 'P';
+}
+
+
+void FeasibilityPump::recordLPSolve(char method, double time, int64_t iters)
+{
+	LPMethodStats& stats = lpStats[lpMethodIndex(method)];
+	stats.avgTime = stats.solves ? (LP_TIME_DECAY * time + (1.0 - LP_TIME_DECAY) * stats.avgTime) : time;
+	stats.solves++;
+	stats.time += time;
+	stats.iters += iters;
+}
+
+
+int64_t FeasibilityPump::solvePumpLP()
+{
+	if (needBasis)
+	{
+		// first LP after an interior initial point: simplex would have to start from scratch,
+		// so get a basis with barrier and crossover (the following LPs are warm started as usual)
+		needBasis = false;
+		model->lpopt('B');
+		return lastLpIterations();
+	}
+	if (lpStrategy == LPStrategy::Race)  return raceLP();
+	if (lpStrategy == LPStrategy::Fixed)
+	{
+		model->lpopt(reOptMethod);
+		return lastLpIterations();
+	}
+	char method = chooseLPMethod();
+	StopWatch watch(true);
+	model->lpopt(method);
+	watch.stop();
+	int64_t lpIter = lastLpIterations();
+	recordLPSolve(method, watch.getTotal(), lpIter);
+	consoleDebug(DebugLevel::VeryVerbose, "Iteration {}: method={} time={}", nitr, optMethodName(method), watch.getTotal());
+	return lpIter;
+}
+
+
+int64_t FeasibilityPump::raceLP()
+{
+	// the model runs the method more likely to win (so that usually there is nothing to copy back),
+	// while a clone warm started from the same basis runs the other one
+	const LPMethodStats& primal = lpStats[lpMethodIndex('P')];
+	const LPMethodStats& dual = lpStats[lpMethodIndex('D')];
+	char method[2];
+	method[0] = (primal.wins >= dual.wins) ? 'P' : 'D';
+	method[1] = (method[0] == 'P') ? 'D' : 'P';
+	if (!racer)
+	{
+		// set up once and reused while the LP has the same rows and columns
+		racer = model->concurrentClone();
+		if (!racer)
+		{
+			// the backend cannot solve two LPs at the same time: no racing for the rest of the run
+			if (verbose)  consoleWarn("fp.lpStrategy = race is not supported by this solver: using adaptive");
+			lpStrategy = LPStrategy::Adaptive;
+			return solvePumpLP();
+		}
+		racer->logging(false);
+	}
+	else
+	{
+		// only the objective and the bounds change between the pumping LPs
+		DOMINIQS_ASSERT( (racer->ncols() == model->ncols()) && (racer->nrows() == model->nrows()) );
+		int n = model->ncols();
+		std::vector<int> cols(n);
+		std::iota(cols.begin(), cols.end(), 0);
+		std::vector<double> values(n);
+		model->objcoefs(&values[0]);
+		racer->objcoefs(n, &cols[0], &values[0]);
+		model->lbs(&values[0]);
+		racer->lbs(n, &cols[0], &values[0]);
+		model->ubs(&values[0]);
+		racer->ubs(n, &cols[0], &values[0]);
+	}
+	racer->intParam(IntParam::IterLimit, model->intParam(IntParam::IterLimit));
+	racer->dblParam(DblParam::TimeLimit, model->dblParam(DblParam::TimeLimit));
+	racer->dblParam(DblParam::ObjLowerLimit, model->dblParam(DblParam::ObjLowerLimit));
+	racer->dblParam(DblParam::ObjUpperLimit, model->dblParam(DblParam::ObjUpperLimit));
+	std::vector<int> cstat;
+	std::vector<int> rstat;
+	if (model->getBasis(cstat, rstat))  racer->setBasis(cstat, rstat);
+
+	// the first one to finish interrupts the other
+	MIPModelI* models[2] = {model.get(), racer.get()};
+	double times[2] = {0.0, 0.0};
+	std::atomic<int> winner(-1);
+	// armed before the threads start: an interrupt that comes before a solve starts stops it right away
+	model->armInterrupt();
+	racer->armInterrupt();
+	auto run = [&](int k) {
+		StopWatch watch(true);
+		models[k]->lpopt(method[k]);
+		watch.stop();
+		times[k] = watch.getTotal();
+		int none = -1;
+		if (winner.compare_exchange_strong(none, k))  models[1 - k]->interrupt();
+	};
+	std::future<void> other = std::async(std::launch::async, run, 1);
+	try
+	{
+		run(0);
+	}
+	catch (...)
+	{
+		racer->interrupt();
+		other.wait();
+		throw;
+	}
+	other.get();
 
-	consoleLog("");
-	consoleInfo("[results]");
-	LOG_ITEM("primalBound", primalBound);
-	LOG_ITEM("dualBound", dualBound);
-	LOG_ITEM("objSense", origObjSense);
-	LOG_ITEM("numSols", (int)found);
-	LOG_ITEM("totalLpTime", lpWatch.getTotal());
-	LOG_ITEM("totalRoundingTime", roundWatch.getTotal());
-	LOG_ITEM("iterations", nitr);
-	LOG_ITEM("rootTime", rootTime);
-	LOG_ITEM("time", chrono.getTotal());
-	LOG_ITEM("firstPerturbation", firstPerturbation);
-	LOG_ITEM("perturbationCnt", pertCnt);
-	LOG_ITEM("restartCnt", restartCnt);
-	LOG_ITEM("walksatCnt", walksatCnt);
-	return found;
+	int k = winner.load();
+	int64_t lpIter = 0;
+	if (k == 1)
+	{
+		// copy the final basis back: the model then needs (almost) no iterations to get the same solution
+		lpIter = std::max(racer->intAttr(IntAttr::SimplexIterations), racer->intAttr(IntAttr::BarrierIterations));
+		if (racer->getBasis(cstat, rstat))  model->setBasis(cstat, rstat);
+		model->lpopt(method[1]);
+	}
+	lpIter += lastLpIterations();
+	lpStats[lpMethodIndex(method[k])].wins++;
+	recordLPSolve(method[k], times[k], lpIter);
+	consoleDebug(DebugLevel::VeryVerbose, "Iteration {}: race won by {} in {}s (loser stopped after {}s)",
+			nitr, optMethodName(method[k]), times[k], times[1 - k]);
+	return lpIter;
 }
 
-// feasiblity pump helpers
 
 void FeasibilityPump::solveInitialLP()
 {
-	consoleInfo("[initialSolve]");
-	model->logging(true);
-	double timeLeft = std::max(timeLimit - chrono.getElapsed(), 0.0);
+	if (verbose)  consoleInfo("[initialSolve]");
+	model->logging(verbose);
+	double timeLeft = std::max(timeLimit - elapsed(), 0.0);
 	model->dblParam(DblParam::TimeLimit, timeLeft);
+	bool warmBasis = (warmStart.cstat.size() == frac_x.size()) && ((int)warmStart.rstat.size() == model->nrows());
+	if (warmBasis)  model->setBasis(warmStart.cstat, warmStart.rstat);
+	// an interior point (close to the analytic center) is often a good starting point for FP
+	bool interior = (firstOptMethod == 'B') && !rootCrossover;
+	if (interior)  model->intParam(IntParam::Crossover, 0);
 	model->lpopt(firstOptMethod);
-	rootTime = chrono.getElapsed();
+	if (interior)  model->intParam(IntParam::Crossover, 1);
+	needBasis = interior;
+	rootTime = elapsed();
+	if (!model->getBasis(rootCStat, rootRStat))
+	{
+		rootCStat.clear();
+		rootRStat.clear();
+	}
 	int simplexIt = model->intAttr(IntAttr::SimplexIterations);
 	int barrierIt = model->intAttr(IntAttr::BarrierIterations);
 	rootLpIter = std::max(simplexIt, barrierIt);
+	totLpIter += rootLpIter;
 	model->sol(&frac_x[0]);
 	primalFeas = model->isPrimalFeas();
 	model->logging(false);
 	double dualBound = getSolutionValue(frac_x);
-	consoleLog("Initial LP: lpiter={} barit={} time={:.4f} pfeas={} dualbound={:.2f}",
-				simplexIt, barrierIt, rootTime, primalFeas, dualBound);
+	if (verbose)
+	{
+		consoleLog("Initial LP: lpiter={} barit={} time={:.4f} pfeas={} dualbound={:.2f} warmBasis={} interior={}",
+					simplexIt, barrierIt, rootTime, primalFeas, dualBound, warmBasis, interior);
+	}
 }
 
 
@@ -434,6 +1404,13 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 	int nflips = avgFlips * (rnd.getFloat() + 0.5);
 	int flipsDone = 0;
 
+	// tabu variables (flipped recently) go last (negative key), the ones flipped less often first,
+	// unless their fractionality is large enough (aspiration)
+	auto sortKey = [&](int j, double sigma) {
+		if (!isTabu(j) || (sigma >= tabuAspiration))  return sigma;
+		return -1.0 - flipCnt[j];
+	};
+
 	// add fractional variables
 	double sigma;
 	if (ignoreGeneralIntegers)
@@ -441,7 +1418,7 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 		for (int j: binaries)
 		{
 			sigma = fabs(x[j] - frac_x[j]);
-			if (sigma > integralityEps) toOrder.emplace(sigma, j);
+			if (sigma > integralityEps) toOrder.emplace(sortKey(j, sigma), j);
 		}
 	}
 	else
@@ -449,7 +1426,7 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 		for (int j: integers)
 		{
 			sigma = fabs(x[j] - frac_x[j]);
-			if (sigma > integralityEps) toOrder.emplace(sigma, j);
+			if (sigma > integralityEps) toOrder.emplace(sortKey(j, sigma), j);
 		}
 	}
 
@@ -457,7 +1434,13 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 	int nFracFlips = std::min(nflips, (int) toOrder.size()); //number of vars to be flipped from fractional
 
 	// add variables from walksat if needed
-	if (walksatPerturbe && (nFracFlips < nflips))
+	bool useWalksat = walksatPerturbe;
+	if (pertBandit.size())
+	{
+		pertArm = pertBandit.select();
+		useWalksat = (pertArm == 1);
+	}
+	if (useWalksat && (nFracFlips < nflips))
 	{
 		int nneeded = nflips - nFracFlips;
 		std::set<int> supp;
@@ -483,7 +1466,7 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 		while ((xitr != xend) && (nneeded > 0))
 		{
 			int j = *xitr++;
-			toOrder.emplace(0.0, j);
+			toOrder.emplace(sortKey(j, 0.0), j);
 			nneeded--;
 		}
 
@@ -496,7 +1479,9 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 	while ((itr != end) && (flipsDone < nflips))
 	{
 		int toFlip = itr->second;
+		bool tabu = isTabu(toFlip);
 
+		int before = flipsDone;
 		if (equal(x[toFlip], lb[toFlip], integralityEps)) { x[toFlip] += 1.0; ++flipsDone; }
 		else if (equal(x[toFlip], ub[toFlip], integralityEps)) { x[toFlip] -= 1.0; ++flipsDone; }
 		else
@@ -505,8 +1490,15 @@ void FeasibilityPump::perturbe(std::vector<double>& x, bool ignoreGeneralInteger
 			if (lessThan(x[toFlip], frac_x[toFlip], integralityEps)) { x[toFlip] += 1.0; ++flipsDone; }
 			if (greaterThan(x[toFlip], frac_x[toFlip], integralityEps)) { x[toFlip] -= 1.0; ++flipsDone; }
 		}
+		if ((tabuTenure > 0) && (flipsDone > before))  recordFlip(toFlip);
+		if (tabu && (flipsDone > before) && (itr->first >= 0.0))  tabuAspirations++;
 		++itr;
 	}
+	// tabu variables left unflipped
+	for (; itr != end; ++itr)
+	{
+		if (itr->first < 0.0)  tabuSkips++;
+	}
 	DOMINIQS_ASSERT( flipsDone );
 	display.set("P", " *");
 	display.set("#flips", flipsDone);
@@ -534,7 +1526,14 @@ void FeasibilityPump::restart(std::vector<double>& x, bool ignoreGeneralIntegers
 			sigma = fabs(x[j] - frac_x[j]);
 			if ( (sigma + r) > 0.5 )
 			{
+				// keep recently flipped variables where they are (unless the LP strongly disagrees)
+				if (isTabu(j) && (sigma < tabuAspiration))
+				{
+					tabuSkips++;
+					continue;
+				}
 				x[j] = isNull(x[j], integralityEps) ? 1.0 : 0.0;
+				if (tabuTenure > 0)  recordFlip(j);
 				++changed;
 			}
 		}
@@ -566,6 +1565,7 @@ void FeasibilityPump::restart(std::vector<double>& x, bool ignoreGeneralIntegers
 			if( different(newValue, x[j], integralityEps) )
 			{
 				x[j] = newValue;
+				if (tabuTenure > 0)  recordFlip(j);
 				++changed;
 			}
 		}
@@ -586,6 +1586,7 @@ void FeasibilityPump::restart(std::vector<double>& x, bool ignoreGeneralIntegers
 				if ( r > 0.5 )
 				{
 					x[j] = isNull(x[j], integralityEps) ? 1.0 : 0.0;
+					if (tabuTenure > 0)  recordFlip(j);
 					++changed;
 				}
 			}
@@ -597,300 +1598,717 @@ void FeasibilityPump::restart(std::vector<double>& x, bool ignoreGeneralIntegers
 }
 
 
-bool FeasibilityPump::pumpLoop(double& runningAlpha, int stage)
+void FeasibilityPump::recordFlip(int j)
 {
-	// setup
-	lastIntegerX.clear();
-	int n = model->ncols();
-	std::vector<double> distObj(n, 0);
-	std::vector<int> colIndices(n);
-	std::iota(colIndices.begin(), colIndices.end(), 0);
-	int oldIterCnt = nitr;
-	bool ignoreGenerals = (stage == 1) ? true : false;
-	const auto& intSubset = (stage == 1) ? binaries : integers;
-	frac2int->ignoreGeneralIntegers(ignoreGenerals);
-	double pumpTimeLimit = (timeMult > 0.0) ? timeMult*rootTime : std::numeric_limits<double>::max();
-	std::vector<std::string> xNames;
-	model->colNames(xNames);
-	int lpIterLimit = -1;
-	if (lpIterMult > 0.0)
+	if (lastFlip.empty())
 	{
-		lpIterLimit = int(rootLpIter * lpIterMult);
-		lpIterLimit = std::max(lpIterLimit, 10);
+		lastFlip.assign(frac_x.size(), -1);
+		flipCnt.assign(frac_x.size(), 0);
 	}
+	lastFlip[j] = nitr;
+	flipCnt[j]++;
+}
+
 
-	while (!model->aborted()
-		&& ((nitr - oldIterCnt) < stageIterLimit)
-		&& (nitr < iterLimit))
+void FeasibilityPump::pumpIteration()
+{
+	int n = frac_x.size();
+	int stage = currentStage();
+	bool ignoreGenerals = (stage == 1);
+	const auto& intSubset = (stage == 1) ? binaries : integers;
+	double timeLeft = std::max(std::min(timeLimit, pumpTimeLimit) - elapsed(), 0.0);
+	distObj.resize(n);
+	colIndices.resize(n);
+	std::iota(colIndices.begin(), colIndices.end(), 0);
+
+	// display logger
+	nitr++;
+	display.resetIteration();
+	if (verbose && display.needHeader(nitr)) display.printHeader(std::cout);
+
+	// frac -> int
+	double iterStart = elapsed();
+	roundArm = -1;
+	pertArm = -1;
+	if (roundBandit.size())
+	{
+		roundArm = roundBandit.select();
+		frac2int->setOperator(roundArm);
+	}
+	roundWatch.start();
+	frac2int->apply(frac_x, integer_x);
+	roundWatch.stop();
+	consoleDebug(DebugLevel::Verbose, "roundingTime = {}", roundWatch.getPartial());
+	if ((tabuTenure > 0) && lastIntegerX.size())
 	{
-		// check if frac_x is feasible (w.r.t. the integer variables in this stage)
-		bool found = (primalFeas && isSolutionInteger(intSubset, frac_x, integralityEps));
-		if (found)
+		const std::vector<double>& previous = lastIntegerX.begin()->second;
+		for (int j: intSubset)
 		{
-			// update closest point
-			closestDist = 0.0;
-			closestPoint = frac_x;
-			// then break this stage
-			break;
+			if (different(integer_x[j], previous[j], integralityEps))  recordFlip(j);
 		}
+	}
 
-		// global timelimit check
-		double timeLeft = std::max(std::min(timeLimit, pumpTimeLimit) - chrono.getElapsed(), 0.0);
-		if (timeLeft <= 0.0)  break;
+	// cycle detection and antistalling actions
+	// is it the same of the last one? If yes perturbe
+	if (lastIntegerX.size()
+		&& areSolutionsEqual(intSubset, integer_x, (*(lastIntegerX.begin())).second, integralityEps)
+		&& equal(runningAlpha, (*(lastIntegerX.begin())).first, alphaDist))
+	{
+		if (!pertCnt)  firstPerturbation = nitr;
+		perturbe(integer_x, ignoreGenerals);
+	}
+	// do a restart until we are able to insert it in the cache
+	for (int rtry = 0; rtry < 10; rtry++)
+	{
+		if (isInCache(runningAlpha, integer_x, ignoreGenerals)) restart(integer_x, ignoreGenerals);
+		else break;
+	}
+	lastIntegerX.push_front(AlphaVector(runningAlpha, integer_x));
 
-		// display logger
-		nitr++;
-		display.resetIteration();
-		if (display.needHeader(nitr)) display.printHeader(std::cout);
+	// int -> frac
+	lpWatch.start();
+
+	// with mixed models, integer_x takes the continuous values from frac_x, so it is hardly ever
+	// feasible as is: its integer part might be, though
+	bool roundedFeasible = isSolutionFeasible(integer_x, rows);
+	int violated = (bandit != BanditPolicy::Off) ? numViolatedRows(integer_x, rows) : 0;
+	if (!isPureInteger && contCompletion && !roundedFeasible && completeContinuous(integer_x))
+	{
+		lpWatch.stop();
+		frac_x = integer_x;
+		primalFeas = true;
+		if (verbose)  consoleLog("Iteration {}: rounded point completed by solving for the continuous variables", nitr);
+		return;
+	}
 
-		// frac -> int
-		roundWatch.start();
-		frac2int->apply(frac_x, integer_x);
-		roundWatch.stop();
-		consoleDebug(DebugLevel::Verbose, "roundingTime = {}", roundWatch.getPartial());
+	double thisAlpha = runningAlpha;
+	// if the distance function is not the pure distance one
+	// then we might not realize the current integer_x is feasible.
+	// so we explictly check for feasibility and, if so,
+	// temporarily set the running alpha to zero.
+	if (roundedFeasible)  thisAlpha = 0.0;
 
-		// cycle detection and antistalling actions
-		// is it the same of the last one? If yes perturbe
-		if (lastIntegerX.size()
-			&& areSolutionsEqual(intSubset, integer_x, (*(lastIntegerX.begin())).second, integralityEps)
-			&& equal(runningAlpha, (*(lastIntegerX.begin())).first, alphaDist))
+	// setup distance objective
+	int addedVars = 0;
+	int addedConstrs = 0;
+	std::fill(distObj.begin(), distObj.end(), 0.0);
+	for (int j: binaries)
+	{
+		double fracj = std::min(1.0, std::max(frac_x[j], 0.0)); //< clip fractional value to [0,1]
+		if (isNull(integer_x[j], integralityEps))
 		{
-			if (!pertCnt)  firstPerturbation = nitr;
-			perturbe(integer_x, ignoreGenerals);
+			double distCoef = 1.0;
+			if (penaltyObj)  distCoef = 1.0 / std::max(1.0 - fracj, 1e-6);
+			distObj[j] = distCoef;
 		}
-		// do a restart until we are able to insert it in the cache
-		for (int rtry = 0; rtry < 10; rtry++)
+		else
 		{
-			if (isInCache(runningAlpha, integer_x, ignoreGenerals)) restart(integer_x, ignoreGenerals);
-			else break;
+			double distCoef = -1.0;
+			if (penaltyObj)  distCoef = -1.0 / std::max(fracj, 1e-6);
+			distObj[j] = distCoef;
 		}
-		lastIntegerX.push_front(AlphaVector(runningAlpha, integer_x));
-
-		// int -> frac
-		lpWatch.start();
-
-		double thisAlpha = runningAlpha;
-		// if the distance function is not the pure distance one
-		// then we might not realize the current integer_x is feasible.
-		// so we explictly check for feasibility and, if so,
-		// temporarily set the running alpha to zero.
-		if (isSolutionFeasible(integer_x, rows))  thisAlpha = 0.0;
+	}
+	bool multiRef = addReferenceDistance(distObj);
+	if (stage > 1)
+	{
+		// TODO: penalty objective for general integers?
+		addedVars = addGeneralIntegersDistance(distObj, colIndices);
+		addedConstrs = 2 * addedVars;
+		consoleDebug(DebugLevel::Verbose, "addedVars={} addedConstrs={}", addedVars, addedConstrs);
+		DOMINIQS_ASSERT( distObj.size() == (unsigned int)(n + addedVars) );
+		DOMINIQS_ASSERT( distObj.size() == colIndices.size() );
+	}
 
-		// setup distance objective
-		int addedVars = 0;
-		int addedConstrs = 0;
-		std::fill(distObj.begin(), distObj.end(), 0.0);
-		for (int j: binaries)
+	// randomize distance coefficients
+	if (randomizeLP)
+	{
+		for (int j = 0; j < (n + addedVars); j++)
 		{
-			double fracj = std::min(1.0, std::max(frac_x[j], 0.0)); //< clip fractional value to [0,1]
-			if (isNull(integer_x[j], integralityEps))
-			{
-				double distCoef = 1.0;
-				if (penaltyObj)  distCoef = 1.0 / std::max(1.0 - fracj, 1e-6);
-				distObj[j] = distCoef;
-			}
-			else
-			{
-				double distCoef = -1.0;
-				if (penaltyObj)  distCoef = -1.0 / std::max(fracj, 1e-6);
-				distObj[j] = distCoef;
-			}
+			double randMult = rnd.getFloat() * 0.1 + 0.9; //< random float in [0.9,1.0)
+			distObj[j] *= randMult;
 		}
-		if (stage > 1)
+	}
+
+	// objective FP
+	if (thisAlpha > 0.0)
+	{
+		// compute distance norm and scale distance objective by (1-thisAlpha)
+		double distNorm = 0.0;
+		for (int j = 0; j < (n + addedVars); j++)
 		{
-			for (int j: gintegers)
-			{
-				// TODO: penalty objective for general integers?
-				if (equal(integer_x[j], lb[j], integralityEps))
-				{
-					distObj[j] = 1.0;
-				}
-				else if (equal(integer_x[j], ub[j], integralityEps))
-				{
-					distObj[j] = -1.0;
-				}
-				else
-				{
-					// add auxiliary variable
-					std::string deltaName = xNames[j] + "_delta";
-					model->addEmptyCol(deltaName, 'C', 0.0, INFBOUND, 0.0);
-					int auxIdx = model->ncols() - 1;
-					colIndices.push_back(auxIdx);
-					distObj.push_back(1.0);
-					addedVars++;
-					// add constraints
-					SparseVector vec;
-					vec.push(j, 1.0);
-					vec.push(auxIdx, -1.0);
-					model->addRow(xNames[j] + "_d1", vec.idx(), vec.coef(), 2, 'L', integer_x[j]);
-					addedConstrs++;
-					vec.coef()[1] = 1.0;
-					model->addRow(xNames[j] + "_d2", vec.idx(), vec.coef(), 2, 'G', integer_x[j]);
-					addedConstrs++;
-				}
-			}
-			consoleDebug(DebugLevel::Verbose, "addedVars={} addedConstrs={}", addedVars, addedConstrs);
-			DOMINIQS_ASSERT( distObj.size() == (unsigned int)(n + addedVars) );
-			DOMINIQS_ASSERT( distObj.size() == colIndices.size() );
+			distNorm += (distObj[j]*distObj[j]);
+			distObj[j] *= (1.0 - thisAlpha);
 		}
+		distNorm = sqrt(distNorm) * (1.0 - thisAlpha);
+
+		// add objective with proper weight
+		double weight = (thisAlpha * distNorm) / objNorm;
+		accumulate(&distObj[0], &obj[0], n, weight);
+	}
 
-		// randomize distance coefficients
-		if (randomizeLP)
+	// set objective
+	model->objcoefs(colIndices.size(), &colIndices[0], &distObj[0]);
+
+	// with the pure distance function, the LP value is the distance up to a constant
+	// (distance = LP value + distConst), so the LP can stop as soon as the outcome is decided
+	bool objLimits = (thisAlpha == 0.0) && !multiRef;
+	if (objLimits)
+	{
+		double distConst = 0.0;
+		for (int j = 0; j < n; j++)  distConst -= distObj[j] * integer_x[j];
+		// integer_x is LP feasible: no better point exists
+		model->dblParam(DblParam::ObjLowerLimit, integralityEps - distConst);
+		// no improvement over the closest point: the partial solution is good enough for the next rounding
+		// (only with the unweighted distance, which is the one measured by closestDist)
+		if (lpCutoff && !randomizeLP && !penaltyObj && (closestDist < INFBOUND))
 		{
-			for (int j = 0; j < (n + addedVars); j++)
-			{
-				double randMult = rnd.getFloat() * 0.1 + 0.9; //< random float in [0.9,1.0)
-				distObj[j] *= randMult;
-			}
+			model->dblParam(DblParam::ObjUpperLimit, closestDist - distConst);
 		}
+	}
 
-		// objective FP
-		if (thisAlpha > 0.0)
-		{
-			// compute distance norm and scale distance objective by (1-thisAlpha)
-			double distNorm = 0.0;
-			for (int j = 0; j < (n + addedVars); j++)
-			{
-				distNorm += (distObj[j]*distObj[j]);
-				distObj[j] *= (1.0 - thisAlpha);
-			}
-			distNorm = sqrt(distNorm) * (1.0 - thisAlpha);
+	// solve LP
+	int64_t iterLeft = lpIterLimit;
+	if (lpIterBudget >= 0)
+	{
+		int64_t budgetLeft = std::max(lpIterBudget - totLpIter, (int64_t)1);
+		iterLeft = (iterLeft > 0) ? std::min(iterLeft, budgetLeft) : budgetLeft;
+	}
+	if (iterLeft > 0)  model->intParam(IntParam::IterLimit, (int)std::min(iterLeft, (int64_t)std::numeric_limits<int>::max()));
+	model->dblParam(DblParam::TimeLimit, timeLeft);
+	int64_t lpIter = solvePumpLP();
+	if (wsActive)  lpIter += separateRows();
+	lpWatch.stop();
+	totLpIter += lpIter;
+	if (objLimits)
+	{
+		// the limits would also apply to the node LPs of stage 3
+		model->dblParam(DblParam::ObjLowerLimit, -NO_OBJ_LIMIT);
+		model->dblParam(DblParam::ObjUpperLimit, NO_OBJ_LIMIT);
+	}
 
-			// add objective with proper weight
-			double weight = (thisAlpha * distNorm) / objNorm;
-			accumulate(&distObj[0], &obj[0], n, weight);
-		}
+	// get solution
+	model->sol(&frac_x[0], 0, n-1);
+	primalFeas = model->isPrimalFeas();
+	consoleDebug(DebugLevel::VeryVerbose, "Iteration {}: time={} pFeas={} lpiter={}",
+			nitr, lpWatch.getPartial(), primalFeas, lpIter);
+	double projObj = model->objval();
+
+	// cleanup added vars and constraints
+	if (addedConstrs)
+	{
+		int begin = numModelRows();
+		model->delRows(begin, begin + addedConstrs - 1);
+	}
+	if (addedVars)  model->delCols(n, n + addedVars - 1);
+	if (racer && addedVars)
+	{
+		int begin = numModelRows();
+		racer->delRows(begin, begin + addedConstrs - 1);
+		racer->delCols(n, n + addedVars - 1);
+	}
+	colIndices.resize(n);
+	distObj.resize(n);
+	DOMINIQS_ASSERT( model->ncols() == n );
+	if (wsActive)  updateWorkingSet();
+	updateReferences();
+
+	// get some statistics
+	double origObj = dotProduct(&obj[0], &frac_x[0], n) + objOffset;
+	double dist = solutionsDistance(intSubset, frac_x, integer_x);
+	int numFrac = solutionNumFractional(intSubset, frac_x, integralityEps);
+
+	if (bandit != BanditPolicy::Off)  rewardBandits(dist, violated, elapsed() - iterStart);
+
+	// save integer_x as best point if distance decreased
+	// (the distance is meaningful only if the LP solve was not stopped early)
+	if (primalFeas && (dist < closestDist))
+	{
+		closestDist = dist;
+		closestPoint = integer_x;
+	}
+
+	// display log
+	if (verbose && display.needPrint(nitr))
+	{
+		display.set("stage", stage);
+		display.set("iter", nitr);
+		display.set("alpha", runningAlpha);
+		display.set("origObj", origObj);
+		display.set("time", elapsed());
+		display.set("dist", dist);
+		display.set("#frac", numFrac);
+		display.set("projObj", projObj);
+		display.set("lpiter", lpIter);
+		display.printIteration(std::cout);
+	}
+	if (callbacks.iteration)
+	{
+		FPIterationInfo info;
+		info.stage = stage;
+		info.iteration = nitr;
+		info.alpha = runningAlpha;
+		info.origObj = origObj;
+		info.dist = dist;
+		info.numFrac = numFrac;
+		info.lpIter = totLpIter;
+		info.time = elapsed();
+		callbacks.iteration(info);
+	}
 
-		// set objective
-		model->objcoefs(colIndices.size(), &colIndices[0], &distObj[0]);
+	// update running alpha
+	runningAlpha *= alphaFactor;
+	if (runningAlpha <= 1e-4)  runningAlpha = 0.0;
+}
 
-		// solve LP
-		if (lpIterLimit > 0)  model->intParam(IntParam::IterLimit, lpIterLimit);
-		model->dblParam(DblParam::TimeLimit, timeLeft);
-		model->lpopt(reOptMethod);
-		lpWatch.stop();
 
-		// get solution
-		model->sol(&frac_x[0], 0, n-1);
-		primalFeas = model->isPrimalFeas();
-		consoleDebug(DebugLevel::VeryVerbose, "Iteration {}: time={} pFeas={} lpiter={}",
-				lpWatch.getPartial(), primalFeas, model->intAttr(IntAttr::SimplexIterations));
-		double projObj = model->objval();
+void FeasibilityPump::initBandits()
+{
+	roundBandit.clear();
+	pertBandit.clear();
+	if (bandit == BanditPolicy::Off)  return;
+	int numOps = frac2int->numOperators();
+	if (numOps > 1)
+	{
+		std::vector<std::string> names(numOps);
+		for (int op = 0; op < numOps; op++)  names[op] = frac2int->operatorName(op);
+		roundBandit.init(names, bandit, banditEps, seed);
+	}
+	if (walksatPerturbe)  pertBandit.init({"fracFlips", "walksat"}, bandit, banditEps, seed + 1);
+}
+
+
+void FeasibilityPump::rewardBandits(double dist, int violated, double time)
+{
+	if (lastDist >= 0.0)
+	{
+		double gain = std::max(lastDist - dist, 0.0) / std::max(lastDist, 1.0);
+		gain += std::max(lastViolated - violated, 0) / (double)std::max(lastViolated, 1);
+		double rate = gain / std::max(time, 1e-6);
+		maxRewardRate = std::max(maxRewardRate, rate);
+		double reward = (maxRewardRate > 0.0) ? (rate / maxRewardRate) : 0.0;
+		if (roundArm >= 0)  roundBandit.update(roundArm, reward, time);
+		if (pertArm >= 0)  pertBandit.update(pertArm, reward, time);
+	}
+	lastDist = dist;
+	lastViolated = violated;
+}
+
+
+bool FeasibilityPump::addReferenceDistance(std::vector<double>& distObj)
+{
+	bool added = false;
+	int nbin = binaries.size();
+	if (refPoints.size())
+	{
+		for (int p = 0; p < nbin; p++)  distObj[binaries[p]] += refSum[p];
+		added = true;
+	}
+	const std::vector<double>& best = hasIncumbent ? incumbent : closestPoint;
+	if ((refBestWeight != 0.0) && best.size())
+	{
+		for (int j: binaries)  distObj[j] += (isNull(best[j], integralityEps) ? refBestWeight : -refBestWeight);
+		added = true;
+	}
+	return added;
+}
 
-		// cleanup added vars and constraints
-		if (addedConstrs)
+
+void FeasibilityPump::updateReferences()
+{
+	if (!numRefs)  return;
+	int nbin = binaries.size();
+	if ((int)refSum.size() != nbin)  refSum.assign(nbin, 0.0);
+	// age all the references by one, dropping the oldest one if the window is full
+	for (int p = 0; p < nbin; p++)  refSum[p] *= refDecay;
+	if ((int)refPoints.size() == numRefs)
+	{
+		double oldWeight = refWeight * std::pow(refDecay, numRefs);
+		const std::vector<signed char>& oldest = refPoints.back();
+		for (int p = 0; p < nbin; p++)  refSum[p] -= oldWeight * oldest[p];
+		refPoints.pop_back();
+	}
+	std::vector<signed char> signs(nbin);
+	for (int p = 0; p < nbin; p++)
+	{
+		signs[p] = isNull(integer_x[binaries[p]], integralityEps) ? 1 : -1;
+		refSum[p] += refWeight * signs[p];
+	}
+	refPoints.push_front(std::move(signs));
+}
+
+
+void FeasibilityPump::clearReferences()
+{
+	refPoints.clear();
+	refSum.clear();
+}
+
+
+int FeasibilityPump::addGeneralIntegersDistance(std::vector<double>& distObj, std::vector<int>& colIndices)
+{
+	int n = frac_x.size();
+	int added = 0;
+	std::vector<std::string> auxNames;
+	std::vector<std::string> rowNames;
+	std::vector<int> beg(1, 0);
+	std::vector<int> idx;
+	std::vector<double> val;
+	std::vector<char> sense;
+	std::vector<double> rhs;
+	for (int j: gintegers)
+	{
+		if (equal(integer_x[j], lb[j], integralityEps)) distObj[j] = 1.0;
+		else if (equal(integer_x[j], ub[j], integralityEps)) distObj[j] = -1.0;
+		else
 		{
-			int begin = model->nrows() - addedConstrs;
-			model->delRows(begin, begin + addedConstrs - 1);
+			// auxiliary variable
+			int auxIdx = n + added;
+			auxNames.push_back(xNames[j] + "_delta");
+			colIndices.push_back(auxIdx);
+			distObj.push_back(1.0);
+			added++;
+			// constraints x_j - delta <= x~_j and x_j + delta >= x~_j
+			idx.push_back(j);
+			idx.push_back(auxIdx);
+			val.push_back(1.0);
+			val.push_back(-1.0);
+			beg.push_back(idx.size());
+			rowNames.push_back(xNames[j] + "_d1");
+			sense.push_back('L');
+			rhs.push_back(integer_x[j]);
+			idx.push_back(j);
+			idx.push_back(auxIdx);
+			val.push_back(1.0);
+			val.push_back(1.0);
+			beg.push_back(idx.size());
+			rowNames.push_back(xNames[j] + "_d2");
+			sense.push_back('G');
+			rhs.push_back(integer_x[j]);
 		}
-		if (addedVars)
+	}
+	if (added)
+	{
+		// columns first, as the rows refer to them
+		std::vector<char> auxType(added, 'C');
+		std::vector<double> auxLb(added, 0.0);
+		std::vector<double> auxUb(added, INFBOUND);
+		std::vector<double> auxObj(added, 0.0);
+		model->addEmptyCols(added, auxNames, &auxType[0], &auxLb[0], &auxUb[0], &auxObj[0]);
+		model->addRows(2 * added, rowNames, &beg[0], &idx[0], &val[0], &sense[0], &rhs[0]);
+		// same edits on the racer, so that it can be reused
+		if (racer)
 		{
-			int begin = model->ncols() - addedVars;
-			model->delCols(begin, begin + addedVars - 1);
+			racer->addEmptyCols(added, auxNames, &auxType[0], &auxLb[0], &auxUb[0], &auxObj[0]);
+			racer->addRows(2 * added, rowNames, &beg[0], &idx[0], &val[0], &sense[0], &rhs[0]);
 		}
-		colIndices.resize(n);
-		distObj.resize(n);
-		DOMINIQS_ASSERT( model->ncols() == n );
+	}
+	return added;
+}
 
-		// get some statistics
-		double origObj = dotProduct(&obj[0], &frac_x[0], n) + objOffset;
-		double dist = solutionsDistance(intSubset, frac_x, integer_x);
-		int numFrac = solutionNumFractional(intSubset, frac_x, integralityEps);
 
-		// save integer_x as best point if distance decreased
-		if (dist < closestDist)
+void FeasibilityPump::initWorkingSet()
+{
+	int m = rows.size();
+	DOMINIQS_ASSERT( model->nrows() == m );
+	DOMINIQS_ASSERT( cutoffRow < 0 );
+	model->rowNames(wsNames);
+	rowViolations(rows, frac_x, rowViol);
+	inLP.assign(m, 1);
+	wsAge.assign(m, 0);
+	wsRows.clear();
+	wsPending.clear();
+	std::vector<int> slack;
+	for (int i = 0; i < m; i++)
+	{
+		if (isNegative(rowViol[i]))
 		{
-			closestDist = dist;
-			closestPoint = integer_x;
+			slack.push_back(i);
+			inLP[i] = 0;
 		}
+		else wsRows.push_back(i);
+	}
+	if (slack.size())  model->delRowSet(slack.size(), &slack[0]);
+	racer.reset();
+	wsActive = true;
+	wsViolValid = false;
+	wsMaxRows = wsRows.size();
+	if (verbose)  consoleLog("Working set: {} of {} rows", wsRows.size(), m);
+}
+
 
-		// display log
-		if (display.needPrint(nitr))
+void FeasibilityPump::addOriginalRows(MIPModelI& lp, const std::vector<int>& which) const
+{
+	if (which.empty())  return;
+	std::vector<int> beg;
+	std::vector<int> idx;
+	std::vector<double> val;
+	std::vector<char> sense;
+	std::vector<double> rhs;
+	std::vector<double> range;
+	std::vector<std::string> names;
+	for (int i: which)
+	{
+		const Constraint& c = *rows[i];
+		beg.push_back(idx.size());
+		idx.insert(idx.end(), c.row.idx(), c.row.idx() + c.row.size());
+		val.insert(val.end(), c.row.coef(), c.row.coef() + c.row.size());
+		sense.push_back(c.sense);
+		rhs.push_back(c.rhs);
+		range.push_back(c.range);
+		if (wsNames.size())  names.push_back(wsNames[i]);
+	}
+	beg.push_back(idx.size());
+	lp.addRows(which.size(), names, &beg[0], idx.empty() ? nullptr : &idx[0], val.empty() ? nullptr : &val[0],
+				&sense[0], &rhs[0], &range[0]);
+}
+
+
+int FeasibilityPump::addViolatedRows(MIPModelI& lp, const std::vector<double>& viol, std::vector<char>& lpHas, std::vector<int>& added) const
+{
+	std::vector<int> which;
+	int m = rows.size();
+	for (int i = 0; i < m; i++)
+	{
+		if (lpHas[i] || !isPositive(viol[i]))  continue;
+		lpHas[i] = 1;
+		which.push_back(i);
+	}
+	addOriginalRows(lp, which);
+	added.insert(added.end(), which.begin(), which.end());
+	return which.size();
+}
+
+
+int64_t FeasibilityPump::separateRows()
+{
+	int n = frac_x.size();
+	int64_t lpIter = 0;
+	wsViolValid = false;
+	while (model->isPrimalFeas())
+	{
+		model->sol(&frac_x[0], 0, n-1);
+		rowViolations(rows, frac_x, rowViol);
+		wsViolValid = true;
+		int cnt = addViolatedRows(*model, rowViol, inLP, wsPending);
+		if (!cnt)  break;
+		if (racer)
 		{
-			int simplexIt = model->intAttr(IntAttr::SimplexIterations);
-			int barrierIt = model->intAttr(IntAttr::BarrierIterations);
-			display.set("stage", stage);
-			display.set("iter", nitr);
-			display.set("alpha", runningAlpha);
-			display.set("origObj", origObj);
-			display.set("time", chrono.getElapsed());
-			display.set("dist", dist);
-			display.set("#frac", numFrac);
-			display.set("projObj", projObj);
-			display.set("lpiter", std::max(simplexIt, barrierIt));
-			display.printIteration(std::cout);
+			std::vector<int> which(wsPending.end() - cnt, wsPending.end());
+			addOriginalRows(*racer, which);
 		}
+		for (unsigned int k = wsPending.size() - cnt; k < wsPending.size(); k++)  wsAge[wsPending[k]] = 0;
+		wsAdded += cnt;
+		wsResolves++;
+		wsViolValid = false;
+		consoleDebug(DebugLevel::Verbose, "Iteration {}: {} violated rows added to the working set", nitr, cnt);
+		lpIter += solvePumpLP();
+	}
+	return lpIter;
+}
+
+
+void FeasibilityPump::updateWorkingSet()
+{
+	// the rows of the last separation are right after the working set now
+	wsRows.insert(wsRows.end(), wsPending.begin(), wsPending.end());
+	wsPending.clear();
+	DOMINIQS_ASSERT( model->nrows() == (int)wsRows.size() );
+	wsMaxRows = std::max(wsMaxRows, (int)wsRows.size());
+	// age out the rows slack for too long (ages are updated only when frac_x is an LP solution)
+	if (!primalFeas || !wsViolValid)  return;
+	std::vector<int> old;
+	int lpRows = wsRows.size();
+	for (int p = 0; p < lpRows; p++)
+	{
+		int i = wsRows[p];
+		if (i < 0)  continue;
+		if (!isNegative(rowViol[i]))  wsAge[i] = 0;
+		else if (++wsAge[i] >= workingSetAge)  old.push_back(p);
+	}
+	if (old.empty())  return;
+	model->delRowSet(old.size(), &old[0]);
+	if (racer)  racer->delRowSet(old.size(), &old[0]);
+	for (int p: old)
+	{
+		inLP[wsRows[p]] = 0;
+		wsRows[p] = -2;
+	}
+	wsRows.erase(std::remove(wsRows.begin(), wsRows.end(), -2), wsRows.end());
+	if (cutoffRow >= 0)  cutoffRow = std::find(wsRows.begin(), wsRows.end(), -1) - wsRows.begin();
+	wsRemoved += old.size();
+	consoleDebug(DebugLevel::Verbose, "Iteration {}: {} slack rows aged out of the working set", nitr, old.size());
+}
 
-		// update running alpha
-		runningAlpha *= alphaFactor;
-		if (runningAlpha <= 1e-4)  runningAlpha = 0.0;
+
+void FeasibilityPump::restoreRows()
+{
+	DOMINIQS_ASSERT( wsActive );
+	// the cutoff goes back after the original rows, as in the full model
+	ConstraintPtr cutoff;
+	if (cutoffRow >= 0)
+	{
+		cutoff = std::make_shared<Constraint>();
+		model->row(cutoffRow, cutoff->row, cutoff->sense, cutoff->rhs, cutoff->range);
+	}
+	// rows can only be appended and the full LP must have the original row order: keep the LP rows
+	// already in place (a prefix of the original rows), then add back the others in order
+	wsRows.insert(wsRows.end(), wsPending.begin(), wsPending.end());
+	int m = rows.size();
+	int lpRows = model->nrows();
+	DOMINIQS_ASSERT( lpRows == (int)wsRows.size() );
+	int kept = 0;
+	while ((kept < lpRows) && (wsRows[kept] == kept))  kept++;
+	if (kept < lpRows)  model->delRows(kept, lpRows - 1);
+	std::vector<int> missing(m - kept);
+	std::iota(missing.begin(), missing.end(), kept);
+	addOriginalRows(*model, missing);
+	racer.reset();
+	consoleDebug(DebugLevel::Verbose, "Working set restore: {} rows kept, {} added back", kept, missing.size());
+	if (cutoff)
+	{
+		cutoffRow = rows.size();
+		model->addRow("fp_cutoff", cutoff->row.idx(), cutoff->row.coef(), cutoff->row.size(), cutoff->sense, cutoff->rhs, cutoff->range);
 	}
+	wsActive = false;
+	wsRows.clear();
+	inLP.clear();
+	wsAge.clear();
+	wsPending.clear();
+	wsNames.clear();
+	wsViolValid = false;
+}
 
-	return (primalFeas && isSolutionInteger(integers, frac_x, integralityEps));
+
+bool FeasibilityPump::completeContinuous(std::vector<double>& x)
+{
+	if (!isSolutionInteger(integers, x, integralityEps))  return false;
+	if (!mightBeFeasible(x, rows, xType, lb, ub, INFBOUND))  return false;
+	contChecks++;
+	if (!solveContinuous(x))  return false;
+	contFound++;
+	return true;
+}
+
+
+bool FeasibilityPump::solveContinuous(std::vector<double>& x)
+{
+	int n = frac_x.size();
+	std::vector<int> cols;
+	if (!contLP)
+	{
+		// original objective, to get a good completion (the LP is then warm started by the previous completion)
+		contLP = model->clone();
+		contLP->logging(false);
+		contLP->switchToLP();
+		cols.resize(n);
+		std::iota(cols.begin(), cols.end(), 0);
+		contLP->objcoefs(n, &cols[0], &obj[0]);
+		contLP->objSense(origObjSense);
+		if (wsActive)  contLPHas = inLP;
+	}
+	MIPModelI* lp = contLP.get();
+	// fix the integer variables
+	cols.assign(integers.begin(), integers.end());
+	std::vector<double> values(cols.size());
+	for (unsigned int k = 0; k < cols.size(); k++)
+	{
+		int j = cols[k];
+		values[k] = std::max(lb[j], std::min(ub[j], std::round(x[j])));
+	}
+	if (cols.size())
+	{
+		lp->lbs(cols.size(), &cols[0], &values[0]);
+		lp->ubs(cols.size(), &cols[0], &values[0]);
+	}
+	lp->dblParam(DblParam::TimeLimit, std::max(timeLimit - elapsed(), 0.0));
+	lp->lpopt('S');
+	totLpIter += std::max(lp->intAttr(IntAttr::SimplexIterations), lp->intAttr(IntAttr::BarrierIterations));
+	std::vector<double> y(n);
+	// with the working set, the clone misses some rows: add the violated ones until there are none
+	std::vector<int> added;
+	std::vector<double> viol;
+	while (true)
+	{
+		if (!lp->isPrimalFeas())  return false;
+		lp->sol(&y[0], 0, n-1);
+		if (contLPHas.empty())  break;
+		rowViolations(rows, y, viol);
+		if (!addViolatedRows(*lp, viol, contLPHas, added))  break;
+		lp->lpopt('S');
+		totLpIter += std::max(lp->intAttr(IntAttr::SimplexIterations), lp->intAttr(IntAttr::BarrierIterations));
+	}
+	if (!isSolutionFeasible(y, rows))  return false;
+	x = y;
+	return true;
 }
 
 
+void FeasibilityPump::polishIncumbent()
+{
+	int n = incumbent.size();
+	double sign = static_cast<int>(origObjSense);
+	if (!polisher)
+	{
+		// the polisher minimizes
+		std::vector<double> minObj(n);
+		for (int j = 0; j < n; j++)  minObj[j] = sign * obj[j];
+		polisher.reset(new Polisher());
+		polisher->init(rows, xType, lb, ub, minObj);
+	}
+	std::vector<double> y = incumbent;
+	polisher->polish(y);
+	if (!isPureInteger && !model->aborted() && (elapsed() < timeLimit))  solveContinuous(y);
+	// moves are feasible by construction: double check anyway, and keep the incumbent if in doubt
+	if (!isWithinBounds(y, lb, ub, integralityEps) || !isSolutionFeasible(y, rows))  return;
+	double value = getSolutionValue(y);
+	double gain = sign * (primalBound - value);
+	if (!isPositive(gain))  return;
+	consoleDebug(DebugLevel::Normal, "polish: {} -> {}", primalBound, value);
+	incumbent = y;
+	primalBound = value;
+	polishCnt++;
+	polishGain += gain;
+}
+
 bool FeasibilityPump::stage3()
 {
-	if (model->aborted()) return false;
+	if (model->aborted() || stopRequested()) return false;
 	if (closestPoint.empty()) return false;
-	consoleInfo("[stage3]");
-	double elapsedTime = chrono.getElapsed();
+	if (verbose)  consoleInfo("[stage3]");
+	double elapsedTime = elapsed();
 	double remainingTime = timeLimit - elapsedTime;
 	double s3TimeLimit = std::max(std::min(remainingTime, elapsedTime), 1.0);
 	if (lessThan(remainingTime, 0.1)) return false;
 
-	consoleLog("Starting stage3 from point with distance={} [timeLimit={}]", closestDist, s3TimeLimit);
+	if (verbose)  consoleLog("Starting stage3 from point with distance={} [timeLimit={}]", closestDist, s3TimeLimit);
 
 	int n = model->ncols();
 	bool found = false;
-	std::vector<std::string> xNames;
-	model->colNames(xNames);
+	// no racing in stage 3 (and the racer would not follow the edits below)
+	racer.reset();
 
 	// restore type information
+	std::vector<int> colIndices(n);
+	std::iota(colIndices.begin(), colIndices.end(), 0);
 	std::vector<char> ctype(n, 'C');
 	for (int j: binaries) ctype[j] = 'B';
 	for (int j: gintegers) ctype[j] = 'I';
-	for (int j = 0; j < n; j++)  model->ctype(j, ctype[j]);
+	model->ctypes(n, &colIndices[0], &ctype[0]);
 
 	// load best point and generate objective
 	integer_x = closestPoint;
-	int addedVars = 0;
-	int addedConstrs = 0;
 	std::vector<double> distObj(n, 0.0);
-	std::vector<int> colIndices(n);
-	std::iota(colIndices.begin(), colIndices.end(), 0);
 	for (int j: binaries) distObj[j] = (isNull(integer_x[j], integralityEps) ? 1.0 : 1.0);
-	for (int j: gintegers)
-	{
-		if (equal(integer_x[j], lb[j], integralityEps)) distObj[j] = 1.0;
-		else if (equal(integer_x[j], ub[j], integralityEps)) distObj[j] = -1.0;
-		else
-		{
-			// add auxiliary variable
-			std::string deltaName = xNames[j] + "_delta";
-			model->addEmptyCol(deltaName, 'C', 0.0, INFBOUND, 0.0);
-			int auxIdx = model->ncols() - 1;
-			colIndices.push_back(auxIdx);
-			distObj.push_back(1.0);
-			addedVars++;
-			// add constraints
-			SparseVector vec;
-			vec.push(j, 1.0);
-			vec.push(auxIdx, -1.0);
-			model->addRow(xNames[j] + "_d1", vec.idx(), vec.coef(), 2, 'L', integer_x[j]);
-			addedConstrs++;
-			vec.coef()[1] = 1.0;
-			model->addRow(xNames[j] + "_d2", vec.idx(), vec.coef(), 2, 'G', integer_x[j]);
-			addedConstrs++;
-		}
-	}
+	int addedVars = addGeneralIntegersDistance(distObj, colIndices);
+	int addedConstrs = 2 * addedVars;
 	consoleDebug(DebugLevel::Normal, "addedVars={} addedConstrs={}", addedVars, addedConstrs);
 	DOMINIQS_ASSERT( distObj.size() == (unsigned int)(n + addedVars) );
 	DOMINIQS_ASSERT( distObj.size() == colIndices.size() );
 	model->objcoefs(colIndices.size(), &colIndices[0], &distObj[0]);
 
-	model->logging(true);
+	model->logging(verbose);
+	int oldSolLimit = model->intParam(IntParam::SolutionLimit);
+	double oldTimeLimit = model->dblParam(DblParam::TimeLimit);
 	model->intParam(IntParam::SolutionLimit, 1);
 	model->dblParam(DblParam::TimeLimit, timeLimit);
 	model->mipopt();
@@ -906,17 +2324,14 @@ bool FeasibilityPump::stage3()
 	// cleanup added vars and constraints and restore obj
 	if (addedConstrs)
 	{
-		int begin = model->nrows() - addedConstrs;
+		int begin = numModelRows();
 		model->delRows(begin, begin + addedConstrs - 1);
 	}
-	if (addedVars)
-	{
-		int begin = model->ncols() - addedVars;
-		model->delCols(begin, begin + addedVars - 1);
-	}
-
-	// restore original objective function
-	model->objcoefs(model->ncols(), &colIndices[0], &obj[0]);
+	if (addedVars)  model->delCols(n, n + addedVars - 1);
+	// back to an LP with the old limits: improvement mode keeps solving pumping LPs on it
+	model->switchToLP();
+	model->intParam(IntParam::SolutionLimit, oldSolLimit);
+	model->dblParam(DblParam::TimeLimit, oldTimeLimit);
 
 	return found;
 }
@@ -925,9 +2340,37 @@ void FeasibilityPump::foundIncumbent(const std::vector<double>& x, double objval
 {
 	incumbent = x;
 	primalBound = objval;
+	if (polish)  polishIncumbent();
 	hasIncumbent = true;
+	bestSolTime = elapsed();
+	if (!numSols)  firstSolTime = bestSolTime;
+	numSols++;
+	addToPool(incumbent, primalBound);
 	frac2int->newIncumbent(incumbent, primalBound);
+	if (callbacks.incumbent)  callbacks.incumbent(incumbent, primalBound);
 	lastIntegerX.clear();
+	clearReferences();
+}
+
+void FeasibilityPump::addToPool(const std::vector<double>& x, double objval)
+{
+	// x is better than all the pool solutions (because of the cutoff): it replaces the first one
+	// closer than poolMinDist (if any) or the worst one if the pool is full
+	FPSolution sol;
+	sol.x = x;
+	sol.objval = objval;
+	sol.time = elapsed();
+	auto isClose = [&](const FPSolution& other) {
+		int diff = 0;
+		for (int j: integers)
+		{
+			if (different(x[j], other.x[j], integralityEps) && (++diff >= poolMinDist))  return false;
+		}
+		return true;
+	};
+	pool.erase(std::remove_if(pool.begin(), pool.end(), isClose), pool.end());
+	pool.insert(pool.begin(), sol);
+	if ((int)pool.size() > poolSize)  pool.pop_back();
 }
 
 bool FeasibilityPump::isInCache(double a, const std::vector<double>& x, bool ignoreGeneralIntegers)
@@ -958,9 +2401,10 @@ void FeasibilityPump::infeasibleSupport(const std::vector<double>& x, std::set<i
 {
 	if (supp.empty())
 	{
-		// find set of infeasible constraints
+		// find set of infeasible constraints (rows has all the original ones, while the LP may have
+		// fewer, with the working set, or one more, with the objective cutoff)
 		std::set<int> infeas;
-		int m = model->nrows();
+		int m = rows.size();
 		for (int i = 0; i < m; i++) {
 			ConstraintPtr c = rows[i];
 			if (!c->satisfiedBy(&x[0])) infeas.insert(i);
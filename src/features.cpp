@@ -0,0 +1,317 @@
+/**
+ * @file features.cpp
+ * @brief Instance features and feature based selection of the FP configuration
+ */
+
+#include "feaspump/features.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <iterator>
+#include <algorithm>
+#include <cctype>
+
+#include <utils/maths.h>
+#include <utils/str_utils.h>
+#include <propagator/domain.h>
+#include <propagator/propagator.h>
+#include <fmt/format.h>
+
+using namespace dominiqs;
+
+
+/** registered propagator factories, in order of priority (as used by the propround rounder) */
+static std::vector<PropagatorFactoryPtr> propagatorFactories()
+{
+	std::list<std::string> fNames;
+	PropagatorFactories::getInstance().getIDs(std::back_insert_iterator< std::list<std::string> >(fNames));
+	std::map<int, PropagatorFactoryPtr> byPriority;
+	for (std::string name: fNames)
+	{
+		PropagatorFactoryPtr fact(PropagatorFactories::getInstance().create(name));
+		byPriority[fact->getPriority()] = fact;
+	}
+	std::vector<PropagatorFactoryPtr> factories;
+	for (const auto& kv: byPriority)  factories.push_back(kv.second);
+	return factories;
+}
+
+
+/** feature name of the fraction of rows handled by a propagator factory (e.g., linear -> fracRowsLinear) */
+static std::string propFeatureName(const std::string& factory)
+{
+	std::string name = factory;
+	if (name.size())  name[0] = toupper(name[0]);
+	return "fracRows" + name;
+}
+
+
+std::vector<std::string> featureNames()
+{
+	std::vector<std::string> names = {
+		"rows", "cols", "nnz", "density",
+		"fracBinaries", "fracGIntegers", "fracContinuous",
+		"fracRowsE", "fracRowsL", "fracRowsG", "fracRowsR",
+		"coefDynamism", "objDensity"
+	};
+	for (PropagatorFactoryPtr fact: propagatorFactories())  names.push_back(propFeatureName(fact->getName()));
+	names.push_back("fracRowsNoProp");
+	return names;
+}
+
+
+InstanceFeatures extractFeatures(const MIPModelI& model)
+{
+	InstanceFeatures f;
+	for (const std::string& name: featureNames())  f[name] = 0.0;
+	int n = model.ncols();
+	int m = model.nrows();
+	double nnz = model.nnz();
+	f["rows"] = m;
+	f["cols"] = n;
+	f["nnz"] = nnz;
+	f["density"] = (m && n) ? (nnz / ((double)m * n)) : 0.0;
+
+	// columns
+	std::vector<char> xType(n);
+	std::vector<double> xLb(n);
+	std::vector<double> xUb(n);
+	std::vector<double> obj(n);
+	std::vector<std::string> xNames;
+	if (n)
+	{
+		model.ctypes(&xType[0]);
+		model.lbs(&xLb[0]);
+		model.ubs(&xUb[0]);
+		model.objcoefs(&obj[0]);
+		model.colNames(xNames);
+	}
+	int nBin = 0;
+	int nGInt = 0;
+	int nObj = 0;
+	for (int j = 0; j < n; j++)
+	{
+		if (xType[j] == 'B')  nBin++;
+		else if (xType[j] == 'I')  nGInt++;
+		if (!isNull(obj[j]))  nObj++;
+	}
+	if (n)
+	{
+		f["fracBinaries"] = nBin / (double)n;
+		f["fracGIntegers"] = nGInt / (double)n;
+		f["fracContinuous"] = (n - nBin - nGInt) / (double)n;
+		f["objDensity"] = nObj / (double)n;
+	}
+	if (!m)  return f;
+
+	// rows: senses, coefficients and the propagator each would get
+	Domain domain;
+	for (int j = 0; j < n; j++)  domain.pushVar(xNames[j], xType[j], xLb[j], xUb[j]);
+	std::vector<PropagatorFactoryPtr> factories = propagatorFactories();
+	std::vector<int> propCnt(factories.size(), 0);
+	int noPropCnt = 0;
+	std::map<char, int> senseCnt;
+	double minCoef = INFBOUND;
+	double maxCoef = 0.0;
+	Constraint c;
+	for (int i = 0; i < m; i++)
+	{
+		model.row(i, c.row, c.sense, c.rhs, c.range);
+		senseCnt[c.sense]++;
+		const double* coef = c.row.coef();
+		for (unsigned int k = 0; k < c.row.size(); k++)
+		{
+			double a = std::fabs(coef[k]);
+			if (isNull(a))  continue;
+			minCoef = std::min(minCoef, a);
+			maxCoef = std::max(maxCoef, a);
+		}
+		if (c.sense == 'N')  continue;
+		bool found = false;
+		for (unsigned int k = 0; (k < factories.size()) && !found; k++)
+		{
+			if (factories[k]->analyze(domain, &c))
+			{
+				propCnt[k]++;
+				found = true;
+			}
+		}
+		if (!found)  noPropCnt++;
+	}
+	f["fracRowsE"] = senseCnt['E'] / (double)m;
+	f["fracRowsL"] = senseCnt['L'] / (double)m;
+	f["fracRowsG"] = senseCnt['G'] / (double)m;
+	f["fracRowsR"] = senseCnt['R'] / (double)m;
+	f["coefDynamism"] = (maxCoef > 0.0) ? std::log10(maxCoef / minCoef) : 0.0;
+	for (unsigned int k = 0; k < factories.size(); k++)  f[propFeatureName(factories[k]->getName())] = propCnt[k] / (double)m;
+	f["fracRowsNoProp"] = noPropCnt / (double)m;
+	return f;
+}
+
+
+void DecisionTreeSelector::load(const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in)  throw std::runtime_error(fmt::format("Cannot open selector file {}", filename));
+	nodes.clear();
+	std::string line;
+	while (std::getline(in, line))
+	{
+		line = trim(line);
+		if (line.empty() || (line[0] == '#'))  continue;
+		std::istringstream tokens(line);
+		std::string kind;
+		int id;
+		tokens >> kind >> id;
+		if (!tokens || (id < 0))  throw std::runtime_error(fmt::format("Malformed selector line: {}", line));
+		if (id >= (int)nodes.size())  nodes.resize(id + 1);
+		Node& node = nodes[id];
+		if (kind == "node")  tokens >> node.feature >> node.threshold >> node.left >> node.right;
+		else if (kind == "leaf")  tokens >> node.label;
+		else throw std::runtime_error(fmt::format("Malformed selector line: {}", line));
+		if (!tokens)  throw std::runtime_error(fmt::format("Malformed selector line: {}", line));
+	}
+	// sanity check: children in range and every path ends in a leaf
+	for (const Node& node: nodes)
+	{
+		if (node.left < 0)
+		{
+			if (node.label.empty())  throw std::runtime_error(fmt::format("Selector {}: missing node", filename));
+			continue;
+		}
+		if ((node.left >= (int)nodes.size()) || (node.right < 0) || (node.right >= (int)nodes.size()))
+		{
+			throw std::runtime_error(fmt::format("Selector {}: child out of range", filename));
+		}
+	}
+	if (nodes.empty())  throw std::runtime_error(fmt::format("Selector {} is empty", filename));
+}
+
+
+void DecisionTreeSelector::save(const std::string& filename) const
+{
+	std::ofstream out(filename);
+	if (!out)  throw std::runtime_error(fmt::format("Cannot open selector file {}", filename));
+	out << "# fp config selector (decision tree)" << std::endl;
+	for (unsigned int id = 0; id < nodes.size(); id++)
+	{
+		const Node& node = nodes[id];
+		if (node.left < 0)  out << fmt::format("leaf {} {}", id, node.label) << std::endl;
+		else out << fmt::format("node {} {} {:.17g} {} {}", id, node.feature, node.threshold, node.left, node.right) << std::endl;
+	}
+}
+
+
+std::string DecisionTreeSelector::select(const InstanceFeatures& features) const
+{
+	int id = 0;
+	// depth is bounded by the number of nodes (guards against cycles in hand written files)
+	for (unsigned int steps = 0; (id < (int)nodes.size()) && (steps <= nodes.size()); steps++)
+	{
+		const Node& node = nodes[id];
+		if (node.left < 0)  return node.label;
+		auto itr = features.find(node.feature);
+		double value = (itr != features.end()) ? itr->second : 0.0;
+		id = (value <= node.threshold) ? node.left : node.right;
+	}
+	throw std::runtime_error("Malformed selector: no leaf reached");
+}
+
+
+/** Gini impurity of a label histogram */
+static double gini(const std::map<std::string, int>& hist, int total)
+{
+	if (!total)  return 0.0;
+	double sum = 0.0;
+	for (const auto& kv: hist)  sum += (kv.second / (double)total) * (kv.second / (double)total);
+	return 1.0 - sum;
+}
+
+
+void DecisionTreeSelector::train(const std::vector<InstanceFeatures>& samples, const std::vector<std::string>& labels, int maxDepth, int minLeaf)
+{
+	if (samples.empty() || (samples.size() != labels.size()))  throw std::runtime_error("Selector training: no samples");
+	nodes.clear();
+	std::vector<int> all(samples.size());
+	for (unsigned int k = 0; k < all.size(); k++)  all[k] = k;
+	build(samples, labels, all, 0, maxDepth, std::max(minLeaf, 1));
+}
+
+
+int DecisionTreeSelector::build(const std::vector<InstanceFeatures>& samples, const std::vector<std::string>& labels,
+		std::vector<int>& subset, int depth, int maxDepth, int minLeaf)
+{
+	int id = nodes.size();
+	nodes.emplace_back();
+	int total = subset.size();
+	std::map<std::string, int> hist;
+	for (int k: subset)  hist[labels[k]]++;
+	// majority label (ties broken by name, for determinism)
+	std::string majority;
+	int majorityCnt = 0;
+	for (const auto& kv: hist)
+	{
+		if (kv.second > majorityCnt)
+		{
+			majority = kv.first;
+			majorityCnt = kv.second;
+		}
+	}
+	nodes[id].label = majority;
+	double impurity = gini(hist, total);
+	if ((depth >= maxDepth) || (total < 2 * minLeaf) || (impurity <= 0.0))  return id;
+
+	// best split over all features and thresholds
+	std::string bestFeature;
+	double bestThreshold = 0.0;
+	double bestImpurity = impurity;
+	std::vector<std::pair<double, int>> values(total);
+	for (const auto& feat: samples[subset[0]])
+	{
+		const std::string& name = feat.first;
+		for (int k = 0; k < total; k++)
+		{
+			auto itr = samples[subset[k]].find(name);
+			values[k] = std::make_pair((itr != samples[subset[k]].end()) ? itr->second : 0.0, subset[k]);
+		}
+		std::sort(values.begin(), values.end());
+		std::map<std::string, int> leftHist;
+		std::map<std::string, int> rightHist = hist;
+		for (int k = 0; k < total - 1; k++)
+		{
+			const std::string& label = labels[values[k].second];
+			leftHist[label]++;
+			rightHist[label]--;
+			int nLeft = k + 1;
+			int nRight = total - nLeft;
+			if ((nLeft < minLeaf) || (nRight < minLeaf) || (values[k].first == values[k+1].first))  continue;
+			double splitImpurity = (nLeft * gini(leftHist, nLeft) + nRight * gini(rightHist, nRight)) / total;
+			if (splitImpurity < bestImpurity - 1e-12)
+			{
+				bestImpurity = splitImpurity;
+				bestFeature = name;
+				bestThreshold = 0.5 * (values[k].first + values[k+1].first);
+			}
+		}
+	}
+	if (bestFeature.empty())  return id;
+
+	std::vector<int> leftSet;
+	std::vector<int> rightSet;
+	for (int k: subset)
+	{
+		auto itr = samples[k].find(bestFeature);
+		double value = (itr != samples[k].end()) ? itr->second : 0.0;
+		if (value <= bestThreshold)  leftSet.push_back(k);
+		else rightSet.push_back(k);
+	}
+	int left = build(samples, labels, leftSet, depth + 1, maxDepth, minLeaf);
+	int right = build(samples, labels, rightSet, depth + 1, maxDepth, minLeaf);
+	nodes[id].feature = bestFeature;
+	nodes[id].threshold = bestThreshold;
+	nodes[id].left = left;
+	nodes[id].right = right;
+	nodes[id].label.clear();
+	return id;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file fp_api.cpp
+ * @brief Helpers to embed FP2.0 in other codes
+ */
+
+#include "feaspump/fp_api.h"
+#include <stdexcept>
+
+#include <utils/asserter.h>
+
+
+void loadProblem(MIPModelI& model, const FPProblemView& prob)
+{
+	if ((model.ncols() != 0) || (model.nrows() != 0))  throw std::runtime_error("loadProblem: model is not empty");
+	DOMINIQS_ASSERT( prob.ncols >= 0 && prob.nrows >= 0 );
+	if (prob.ncols)
+	{
+		DOMINIQS_ASSERT( prob.obj && prob.lb && prob.ub );
+		std::vector<char> allContinuous;
+		const char* ctype = prob.ctype;
+		if (!ctype)
+		{
+			allContinuous.resize(prob.ncols, 'C');
+			ctype = &allContinuous[0];
+		}
+		model.addEmptyCols(prob.ncols, std::vector<std::string>(), ctype, prob.lb, prob.ub, prob.obj);
+	}
+	if (prob.nrows)
+	{
+		DOMINIQS_ASSERT( prob.rowBeg && prob.sense && prob.rhs );
+		DOMINIQS_ASSERT( prob.rowBeg[prob.nrows] == 0 || (prob.rowIdx && prob.rowVal) );
+		model.addRows(prob.nrows, std::vector<std::string>(), prob.rowBeg, prob.rowIdx, prob.rowVal,
+					prob.sense, prob.rhs, prob.rngval);
+	}
+	model.objSense(prob.objSense);
+	model.objOffset(prob.objOffset);
+}
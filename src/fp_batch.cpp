@@ -0,0 +1,328 @@
+/**
+ * @file fp_batch.cpp
+ * @brief Batch mode: run FP on a list of instances within a single process
+ *
+ * Each worker thread owns one solver environment and one FeasibilityPump object,
+ * which are set up once and reused for all the jobs it processes.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <utils/args_parser.h>
+#include <utils/fileconfig.h>
+#include <utils/floats.h>
+#include <utils/maths.h>
+#include <utils/timer.h>
+#include <utils/randgen.h>
+#include <utils/consolelog.h>
+#include <utils/str_utils.h>
+
+#include "feaspump/feaspump.h"
+#include "feaspump/features.h"
+#include "feaspump/presolve.h"
+#include "feaspump/version.h"
+#ifdef HAS_CPLEX
+#include "feaspump/cpxmodel.h"
+#endif
+#ifdef HAS_XPRESS
+#include "feaspump/xprsmodel.h"
+#endif
+#include <fmt/format.h>
+
+
+// macro type savers
+#define LOG_ITEM(name, value) consoleLog("{} = {}", name, value)
+
+using namespace dominiqs;
+
+static const uint64_t DEF_SEED = 0;
+
+
+/** Settings shared by all jobs */
+struct BatchSetup
+{
+	std::string solver;
+	bool mipPresolve;
+	bool fpPresolve; //< in-tree presolve (see Presolver)
+	int solverThreads;
+	double timeLimit;
+	bool features; //< append the instance features to the results (see fp_train)
+};
+
+/** Outcome of a single job */
+struct JobResult
+{
+	bool ok = false;
+	int rows = 0;
+	int cols = 0;
+	int nnz = 0;
+	bool found = false;
+	double objval = 0.0;
+	int iterations = 0;
+	int64_t lpIterations = 0;
+	double time = 0.0;
+	std::string error;
+	InstanceFeatures features;
+};
+
+
+static MIPModelPtr makeModel(const std::string& solver)
+{
+	MIPModelPtr model;
+#ifdef HAS_CPLEX
+	if (solver == "cpx")  model = MIPModelPtr(new CPXModel());
+#endif
+#ifdef HAS_XPRESS
+	if (solver == "xprs")  model = MIPModelPtr(new XPRSModel());
+#endif
+	if (!model)  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
+	return model;
+}
+
+
+static void readJobs(std::istream& in, std::vector<std::string>& jobs)
+{
+	std::string line;
+	while (std::getline(in, line))
+	{
+		line = trim(line);
+		if (line.empty() || (line[0] == '#'))  continue;
+		jobs.push_back(line);
+	}
+}
+
+
+/**
+ * Solve a single instance.
+ * base is an empty model: each job works on a clone of it, so that all jobs
+ * of a worker share the same solver environment.
+ */
+static void solveJob(MIPModelPtr base, FeasibilityPump& fp, const BatchSetup& setup, const std::string& filename, JobResult& res)
+{
+	StopWatch watch(true);
+	MIPModelPtr model = base->clone();
+	model->logging(false);
+	model->intParam(IntParam::Threads, setup.solverThreads);
+	model->readModel(filename);
+	res.rows = model->nrows();
+	res.cols = model->ncols();
+	res.nnz = model->nnz();
+
+	// presolve
+	MIPModelPtr premodel;
+	bool hasPresolve = false;
+	if (setup.mipPresolve)
+	{
+		model->dblParam(DblParam::TimeLimit, setup.timeLimit);
+		model->presolve();
+		premodel = model->presolvedModel();
+		if (premodel)  hasPresolve = true;
+	}
+	if (!premodel)  premodel = model->clone();
+	Presolver fpPresolver;
+	bool hasFpPresolve = false;
+	if (setup.fpPresolve)
+	{
+		MIPModelPtr reduced = fpPresolver.presolve(*premodel);
+		if (reduced)
+		{
+			premodel = reduced;
+			hasFpPresolve = true;
+		}
+	}
+	if (setup.features)  res.features = extractFeatures(*premodel);
+
+	// feaspump (init resets all the state of the previous job)
+	fp.init(premodel);
+	res.found = fp.pump();
+	res.iterations = fp.getIterations();
+	res.lpIterations = fp.getLpIterations();
+	if (res.found)
+	{
+		// uncrush solution
+		std::vector<double> x = fp.solution();
+		if (hasFpPresolve)  x = fpPresolver.postsolve(x);
+		if (hasPresolve)
+		{
+			x = model->postsolveSolution(x);
+			model->postsolve();
+		}
+
+		// compute objective in original space
+		int n = model->ncols();
+		std::vector<double> obj(n);
+		model->objcoefs(&obj[0]);
+		res.objval = model->objOffset() + dotProduct(&obj[0], &x[0], n);
+
+		// check solution for feasibility
+		int m = model->nrows();
+		for (int i = 0; i < m; i++)
+		{
+			Constraint c;
+			model->row(i, c.row, c.sense, c.rhs, c.range);
+			if (c.sense == 'N')  continue;
+			if (!c.satisfiedBy(&x[0]))  throw std::runtime_error(fmt::format("Constraint {} violated by {}", i, c.violation(&x[0])));
+		}
+	}
+	watch.stop();
+	res.time = watch.getTotal();
+	res.ok = true;
+}
+
+
+/** Thread-safe writer of result records (one CSV line per job) */
+class ResultWriter
+{
+public:
+	ResultWriter(std::ostream& _out, const std::vector<std::string>& _features) : out(_out), features(_features)
+	{
+		out << "job,instance,status,rows,cols,nnz,found,objval,iterations,lpIterations,time,error";
+		for (const std::string& name: features)  out << ",f_" << name;
+		out << std::endl;
+	}
+	void write(int job, const std::string& instance, const JobResult& res)
+	{
+		std::string error = res.error;
+		std::replace(error.begin(), error.end(), ',', ';');
+		std::replace(error.begin(), error.end(), '\n', ' ');
+		std::string line = fmt::format("{},{},{},{},{},{},{},{:.15g},{},{},{:.4f},{}",
+							job, instance, res.ok ? "ok" : "error", res.rows, res.cols, res.nnz,
+							(int)res.found, res.objval, res.iterations, res.lpIterations, res.time, error);
+		// one field per feature column (empty if the features of this job are missing, e.g., on errors)
+		for (const std::string& name: features)
+		{
+			auto itr = res.features.find(name);
+			line += (itr != res.features.end()) ? fmt::format(",{:.15g}", itr->second) : std::string(",");
+		}
+		std::lock_guard<std::mutex> lock(mtx);
+		out << line << std::endl;
+	}
+private:
+	std::ostream& out;
+	std::vector<std::string> features;
+	std::mutex mtx;
+};
+
+
+static void worker(MIPModelPtr base, FeasibilityPump* fp, const BatchSetup& setup,
+			const std::vector<std::string>& jobs, std::atomic<int>& nextJob, ResultWriter& writer)
+{
+	while (true)
+	{
+		int j = nextJob++;
+		if (j >= (int)jobs.size())  break;
+		JobResult res;
+		try
+		{
+			solveJob(base, *fp, setup, jobs[j], res);
+		}
+		catch (std::exception& e)
+		{
+			res.ok = false;
+			res.error = e.what();
+		}
+		fp->reset();
+		writer.write(j, jobs[j], res);
+	}
+}
+
+
+int main (int argc, char const *argv[])
+{
+	// config/options
+	ArgsParser args;
+	args.parse(argc, argv);
+	if (args.input.size() < 1)
+	{
+		consoleError("usage: fp_batch job_file|- [-c config_file] [batch.threads=N] [batch.output=results_file]");
+		return -1;
+	}
+	mergeConfig(args, gConfig());
+	BatchSetup setup;
+	setup.solver = gConfig().get("solver", std::string("cpx"));
+	setup.mipPresolve = gConfig().get("mipPresolve", true);
+	setup.fpPresolve = gConfig().get("fpPresolve", false);
+	setup.solverThreads = gConfig().get("batch.solverThreads", 1);
+	setup.timeLimit = gConfig().get("fp.timeLimit", 1e+75);
+	setup.features = gConfig().get("batch.features", false);
+	int numWorkers = gConfig().get("batch.threads", 1);
+	std::string defOutput = (args.input[0] == "-") ? std::string("batch") : args.input[0];
+	std::string output = gConfig().get("batch.output", defOutput + ".results.csv");
+	// per job logs of concurrent workers would be interleaved: keep them off by default
+	gConfig().set("fp.verbose", gConfig().get("fp.verbose", false));
+	gConfig().set("fp.handleCtrlC", false);
+	numWorkers = std::max(numWorkers, 1);
+	// logger
+	consoleInfo("[config]");
+	LOG_ITEM("jobs", args.input[0]);
+	LOG_ITEM("solver", setup.solver);
+	LOG_ITEM("presolve", setup.mipPresolve);
+	LOG_ITEM("fpPresolve", setup.fpPresolve);
+	LOG_ITEM("batch.threads", numWorkers);
+	LOG_ITEM("batch.solverThreads", setup.solverThreads);
+	LOG_ITEM("batch.output", output);
+	LOG_ITEM("batch.features", setup.features);
+	LOG_ITEM("gitHash", FP_GIT_HASH);
+	LOG_ITEM("fpVersion", FP_VERSION);
+	// seed
+	uint64_t seed = gConfig().get<uint64_t>("seed", DEF_SEED);
+	LOG_ITEM("seed", seed);
+	seed = generateSeed(seed);
+	gConfig().set<uint64_t>("seed", seed);
+
+	try
+	{
+		std::vector<std::string> jobs;
+		if (args.input[0] == "-")  readJobs(std::cin, jobs);
+		else
+		{
+			std::ifstream in(args.input[0]);
+			if (!in)  throw std::runtime_error(fmt::format("Cannot open job file {}", args.input[0]));
+			readJobs(in, jobs);
+		}
+		numWorkers = std::min(numWorkers, std::max((int)jobs.size(), 1));
+
+		// setup is done sequentially, once per worker
+		std::vector<MIPModelPtr> bases;
+		std::vector<std::unique_ptr<FeasibilityPump>> pumps;
+		for (int w = 0; w < numWorkers; w++)
+		{
+			MIPModelPtr base = makeModel(setup.solver);
+			base->logging(false);
+			if (w == 0)  gConfig().set("fp.integralityEps", base->dblParam(DblParam::IntegralityTolerance));
+			bases.push_back(base);
+			pumps.emplace_back(new FeasibilityPump());
+			pumps.back()->readConfig();
+		}
+
+		std::ofstream outFile(output);
+		if (!outFile)  throw std::runtime_error(fmt::format("Cannot open output file {}", output));
+		ResultWriter writer(outFile, setup.features ? featureNames() : std::vector<std::string>());
+
+		StopWatch watch(true);
+		std::atomic<int> nextJob(0);
+		std::vector<std::thread> threads;
+		for (int w = 0; w < numWorkers; w++)
+		{
+			threads.emplace_back(worker, bases[w], pumps[w].get(), std::cref(setup),
+								std::cref(jobs), std::ref(nextJob), std::ref(writer));
+		}
+		for (auto& t: threads)  t.join();
+		watch.stop();
+		consoleInfo("[results]");
+		LOG_ITEM("numJobs", jobs.size());
+		LOG_ITEM("time", watch.getTotal());
+		LOG_ITEM("jobsPerSec", jobs.size() / std::max(watch.getTotal(), 1e-9));
+	}
+	catch(std::exception& e)
+	{
+		consoleError(e.what());
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file fp_c_interface.cpp
+ * @brief C interface to FP2.0
+ */
+
+#include "feaspump/fp_c_interface.h"
+#include "feaspump/feaspump.h"
+#include "feaspump/cpxmodel.h"
+
+#include <utils/consolelog.h>
+
+using namespace dominiqs;
+
+
+int callFP(CPXENVptr env, CPXLPptr lp, int useFP2, int logOutput, double timeLimit, int* foundSol, double* foundObjval)
+{
+	if (!env || !lp || !foundSol || !foundObjval)  return 1;
+	*foundSol = 0;
+	try
+	{
+		// the pump modifies the model it works on: use a copy
+		CPXModel orig(env, lp);
+		MIPModelPtr model = orig.clone();
+		FPOptions opts;
+		opts.frac2int = useFP2 ? "propround" : "std";
+		opts.timeLimit = timeLimit;
+		opts.integralityEps = model->dblParam(DblParam::IntegralityTolerance);
+		opts.verbose = (logOutput != 0);
+		FeasibilityPump fp;
+		fp.setOptions(opts);
+		fp.init(model);
+		if (fp.pump())
+		{
+			*foundSol = 1;
+			*foundObjval = fp.solutionValue();
+		}
+	}
+	catch (std::exception& e)
+	{
+		if (logOutput)  consoleError(e.what());
+		return 1;
+	}
+	return 0;
+}
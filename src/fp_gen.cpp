@@ -0,0 +1,78 @@
+/**
+ * @file fp_gen.cpp
+ * @brief Synthetic instance generator (writes MPS files)
+ */
+
+#include <iostream>
+
+#include <utils/args_parser.h>
+#include <utils/fileconfig.h>
+#include <utils/timer.h>
+#include <utils/consolelog.h>
+
+#include "feaspump/instgen.h"
+#include "feaspump/version.h"
+#include <fmt/format.h>
+
+
+// macro type savers
+#define LOG_ITEM(name, value) consoleLog("{} = {}", name, value)
+
+using namespace dominiqs;
+
+static const uint64_t DEF_SEED = 0;
+
+int main (int argc, char const *argv[])
+{
+	// config/options
+	ArgsParser args;
+	args.parse(argc, argv);
+	if (args.input.size() < 1)
+	{
+		consoleError("usage: fp_gen out_file[.mps|.mps.gz] gen.family=FAMILY [gen.nnz=NNZ | gen.nrows=M gen.ncols=N] [gen.rowNnz=K] [seed=S]");
+		std::string families;
+		for (const std::string& name: instanceFamilies())  families += " " + name;
+		consoleError("families:{}", families);
+		return -1;
+	}
+	mergeConfig(args, gConfig());
+	std::string family = gConfig().get("gen.family", std::string("setcover"));
+	InstGenParams params;
+	long long nnz = gConfig().get("gen.nnz", 0LL);
+	params.nrows = gConfig().get("gen.nrows", params.nrows);
+	params.ncols = gConfig().get("gen.ncols", params.ncols);
+	params.rowNnz = gConfig().get("gen.rowNnz", params.rowNnz);
+	params.seed = gConfig().get<uint64_t>("seed", DEF_SEED);
+	// logger
+	consoleInfo("[config]");
+	LOG_ITEM("gen.family", family);
+	LOG_ITEM("gen.nnz", nnz);
+	LOG_ITEM("gen.rowNnz", params.rowNnz);
+	LOG_ITEM("seed", params.seed);
+	LOG_ITEM("gitHash", FP_GIT_HASH);
+	LOG_ITEM("fpVersion", FP_VERSION);
+
+	try
+	{
+		// target nnz overrides explicit dimensions
+		if (nnz > 0)  scaleToNnz(family, nnz, params);
+		LOG_ITEM("gen.nrows", params.nrows);
+		LOG_ITEM("gen.ncols", params.ncols);
+		StopWatch watch(true);
+		std::shared_ptr<MemModel> model = generateInstance(family, params);
+		watch.stop();
+		consoleLog("generatedProblem: #rows={} #cols={} #nnz={} time={}",
+					model->nrows(), model->ncols(), model->nnz(), watch.getTotal());
+		watch.reset();
+		watch.start();
+		model->writeModel(args.input[0]);
+		watch.stop();
+		consoleLog("written {} in {}s", args.input[0], watch.getTotal());
+	}
+	catch(std::exception& e)
+	{
+		consoleError(e.what());
+		return -1;
+	}
+	return 0;
+}
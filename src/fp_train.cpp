@@ -0,0 +1,220 @@
+/**
+ * @file fp_train.cpp
+ * @brief Offline training of the configuration selector from batch results
+ *
+ * Input: one fp_batch results file (run with batch.features=1) per configuration.
+ * For each instance, the best configuration is the one that found a solution in the shortest time.
+ * Output: a decision tree selector, to be used with autoConfig=FILE.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+#include <utils/args_parser.h>
+#include <utils/fileconfig.h>
+#include <utils/consolelog.h>
+#include <utils/str_utils.h>
+
+#include "feaspump/features.h"
+#include "feaspump/version.h"
+#include <fmt/format.h>
+
+
+// macro type savers
+#define LOG_ITEM(name, value) consoleLog("{} = {}", name, value)
+
+using namespace dominiqs;
+
+static const char FEATURE_PREFIX[] = "f_";
+
+
+/** Outcome of a configuration on an instance */
+struct RunRecord
+{
+	bool found = false;
+	double time = 0.0;
+};
+
+/** All we know about an instance */
+struct InstanceData
+{
+	InstanceFeatures features;
+	std::map<std::string, RunRecord> runs; //< configuration -> outcome
+};
+
+
+static std::vector<std::string> splitCSV(const std::string& line)
+{
+	std::vector<std::string> fields;
+	std::istringstream in(line);
+	std::string field;
+	while (std::getline(in, field, ','))  fields.push_back(trim(field));
+	if (!line.empty() && (line.back() == ','))  fields.push_back("");
+	return fields;
+}
+
+
+/** configuration name from the results file name (e.g., runs/fp2noobj.results.csv -> fp2noobj) */
+static std::string configName(const std::string& filename)
+{
+	std::string name = filename;
+	size_t slash = name.find_last_of('/');
+	if (slash != std::string::npos)  name = name.substr(slash + 1);
+	for (std::string ext: {".csv", ".results"})
+	{
+		if ((name.size() > ext.size()) && (name.compare(name.size() - ext.size(), ext.size(), ext) == 0))  name.resize(name.size() - ext.size());
+	}
+	return name;
+}
+
+
+static void readResults(const std::string& filename, const std::string& config, std::map<std::string, InstanceData>& instances)
+{
+	std::ifstream in(filename);
+	if (!in)  throw std::runtime_error(fmt::format("Cannot open results file {}", filename));
+	std::string line;
+	if (!std::getline(in, line))  throw std::runtime_error(fmt::format("Empty results file {}", filename));
+	std::vector<std::string> header = splitCSV(line);
+	std::map<std::string, int> column;
+	for (unsigned int k = 0; k < header.size(); k++)  column[header[k]] = k;
+	for (std::string required: {"instance", "status", "found", "time"})
+	{
+		if (!column.count(required))  throw std::runtime_error(fmt::format("Results file {}: missing column {}", filename, required));
+	}
+	int numFeatures = 0;
+	for (const std::string& name: header)  numFeatures += starts_with(name, FEATURE_PREFIX);
+	if (!numFeatures)  throw std::runtime_error(fmt::format("Results file {}: no features (run fp_batch with batch.features=1)", filename));
+	size_t prefixLen = std::string(FEATURE_PREFIX).size();
+	while (std::getline(in, line))
+	{
+		if (trim(line).empty())  continue;
+		std::vector<std::string> fields = splitCSV(line);
+		fields.resize(header.size());
+		InstanceData& data = instances[fields[column["instance"]]];
+		RunRecord& run = data.runs[config];
+		run.found = (fields[column["status"]] == "ok") && (fields[column["found"]] == "1");
+		run.time = run.found ? from_string<double>(fields[column["time"]]) : 0.0;
+		if (!data.features.empty() || (fields[column["status"]] != "ok"))  continue;
+		for (unsigned int k = 0; k < header.size(); k++)
+		{
+			if (starts_with(header[k], FEATURE_PREFIX) && !fields[k].empty())
+			{
+				data.features[header[k].substr(prefixLen)] = from_string<double>(fields[k]);
+			}
+		}
+	}
+}
+
+
+int main (int argc, char const *argv[])
+{
+	// config/options
+	ArgsParser args;
+	args.parse(argc, argv);
+	if (args.input.size() < 2)
+	{
+		consoleError("usage: fp_train out_selector results_file1 [results_file2 ...] [train.maxDepth=D] [train.minLeaf=L]");
+		consoleError("each results file comes from fp_batch (with batch.features=1) run with a different configuration,");
+		consoleError("named after the file (e.g., fp2noobj.results.csv -> fp2noobj, i.e., settings/fp2noobj.cfg)");
+		return -1;
+	}
+	mergeConfig(args, gConfig());
+	int maxDepth = gConfig().get("train.maxDepth", 4);
+	int minLeaf = gConfig().get("train.minLeaf", 2);
+	// logger
+	consoleInfo("[config]");
+	LOG_ITEM("output", args.input[0]);
+	LOG_ITEM("train.maxDepth", maxDepth);
+	LOG_ITEM("train.minLeaf", minLeaf);
+	LOG_ITEM("gitHash", FP_GIT_HASH);
+	LOG_ITEM("fpVersion", FP_VERSION);
+
+	try
+	{
+		std::map<std::string, InstanceData> instances;
+		std::vector<std::string> configs;
+		for (unsigned int k = 1; k < args.input.size(); k++)
+		{
+			std::string config = configName(args.input[k]);
+			configs.push_back(config);
+			readResults(args.input[k], config, instances);
+			LOG_ITEM(config, args.input[k]);
+		}
+
+		// label: fastest configuration that found a solution
+		std::vector<InstanceFeatures> samples;
+		std::vector<std::string> labels;
+		std::map<std::string, int> labelCnt;
+		int unsolved = 0;
+		for (const auto& kv: instances)
+		{
+			const InstanceData& data = kv.second;
+			std::string best;
+			double bestTime = std::numeric_limits<double>::max();
+			for (const std::string& config: configs)
+			{
+				auto itr = data.runs.find(config);
+				if ((itr == data.runs.end()) || !itr->second.found)  continue;
+				if (itr->second.time < bestTime)
+				{
+					best = config;
+					bestTime = itr->second.time;
+				}
+			}
+			if (best.empty() || data.features.empty())
+			{
+				unsolved++;
+				continue;
+			}
+			samples.push_back(data.features);
+			labels.push_back(best);
+			labelCnt[best]++;
+		}
+		consoleInfo("[data]");
+		LOG_ITEM("instances", instances.size());
+		LOG_ITEM("samples", samples.size());
+		LOG_ITEM("skipped", unsolved);
+		for (const auto& kv: labelCnt)  LOG_ITEM(kv.first + "Best", kv.second);
+
+		DecisionTreeSelector selector;
+		selector.train(samples, labels, maxDepth, minLeaf);
+		selector.save(args.input[0]);
+
+		// training set quality: hits, and time of the selected configurations vs the best ones
+		int hits = 0;
+		int selectedSolved = 0;
+		for (unsigned int k = 0; k < samples.size(); k++)
+		{
+			std::string selected = selector.select(samples[k]);
+			hits += (selected == labels[k]);
+		}
+		for (const auto& kv: instances)
+		{
+			if (kv.second.features.empty())  continue;
+			auto itr = kv.second.runs.find(selector.select(kv.second.features));
+			if ((itr != kv.second.runs.end()) && itr->second.found)  selectedSolved++;
+		}
+		consoleInfo("[results]");
+		LOG_ITEM("treeNodes", selector.size());
+		LOG_ITEM("trainAccuracy", samples.size() ? (hits / (double)samples.size()) : 0.0);
+		LOG_ITEM("selectedSolved", selectedSolved);
+		for (const std::string& config: configs)
+		{
+			int solved = 0;
+			for (const auto& kv: instances)
+			{
+				auto itr = kv.second.runs.find(config);
+				if ((itr != kv.second.runs.end()) && itr->second.found)  solved++;
+			}
+			LOG_ITEM(config + "Solved", solved);
+		}
+	}
+	catch(std::exception& e)
+	{
+		consoleError(e.what());
+		return -1;
+	}
+	return 0;
+}
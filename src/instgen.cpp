@@ -0,0 +1,568 @@
+/**
+ * @file instgen.cpp
+ * @brief Synthetic structured MIP instances generator
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include <utils/randgen.h>
+#include <fmt/format.h>
+
+#include "feaspump/instgen.h"
+
+using namespace dominiqs;
+
+
+/**
+ * Small helper around RandGen for the generators
+ */
+
+class InstRandom
+{
+public:
+	InstRandom(uint64_t seed) : gen(seed) { gen.warmUp(); }
+	/** @return a random integer in [lo,hi] */
+	int getInt(int lo, int hi)
+	{
+		int res = lo + (int)floor(gen.getFloat() * (hi - lo + 1));
+		return std::min(res, hi);
+	}
+	/** @return a random double in [lo,hi) */
+	double getFloat(double lo, double hi)
+	{
+		return lo + gen.getFloat() * (hi - lo);
+	}
+	/** sample k distinct indices in [0,n) (k is clipped to n) */
+	void sample(int n, int k, std::vector<int>& out)
+	{
+		k = std::min(k, n);
+		out.clear();
+		if (mark.size() < (size_t)n)  mark.resize(n, 0);
+		while ((int)out.size() < k)
+		{
+			int j = getInt(0, n-1);
+			if (mark[j])  continue;
+			mark[j] = 1;
+			out.push_back(j);
+		}
+		std::sort(out.begin(), out.end());
+		for (int j: out)  mark[j] = 0;
+	}
+private:
+	RandGen gen;
+	std::vector<char> mark;
+};
+
+
+static std::string colName(int j)
+{
+	return fmt::format("x{}", j);
+}
+
+
+static std::string rowName(int i)
+{
+	return fmt::format("c{}", i);
+}
+
+
+/**
+ * Set covering: min c^T x s.t. sum_{j in S_i} x_j >= 1, x binary
+ */
+static void genSetCover(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int n = params.ncols;
+	for (int j = 0; j < n; j++)  model.addEmptyCol(colName(j), 'B', 0.0, 1.0, rnd.getInt(1, 10));
+	std::vector<int> idx;
+	std::vector<double> val;
+	for (int i = 0; i < params.nrows; i++)
+	{
+		rnd.sample(n, params.rowNnz, idx);
+		val.assign(idx.size(), 1.0);
+		model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'G', 1.0);
+	}
+}
+
+
+/**
+ * Multi-row knapsack: max p^T x s.t. sum_{j in S_i} w_ij x_j <= C_i, x binary
+ * Profits are weakly correlated with the weights of the first row the variable appears in.
+ */
+static void genKnapsack(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int n = params.ncols;
+	for (int j = 0; j < n; j++)  model.addEmptyCol(colName(j), 'B', 0.0, 1.0, 0.0);
+	std::vector<double> profit(n, 0.0);
+	std::vector<int> idx;
+	std::vector<double> val;
+	for (int i = 0; i < params.nrows; i++)
+	{
+		rnd.sample(n, params.rowNnz, idx);
+		val.resize(idx.size());
+		double sum = 0.0;
+		for (unsigned int k = 0; k < idx.size(); k++)
+		{
+			val[k] = rnd.getInt(10, 100);
+			sum += val[k];
+			if (profit[idx[k]] == 0.0)  profit[idx[k]] = val[k] + rnd.getInt(-5, 5);
+		}
+		model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'L', floor(0.5 * sum));
+	}
+	model.objSense(ObjSense::MAX);
+	for (int j = 0; j < n; j++)  model.objcoef(j, (profit[j] != 0.0) ? profit[j] : rnd.getInt(5, 105));
+}
+
+
+/**
+ * Fixed charge network-like structure:
+ * half binaries y (facilities) and half continuous x (flows),
+ * with variable upper bounds x_j <= U_j y_{j mod nbin}
+ * and demand rows sum_{j in S_i} x_j >= d_i filling the remaining rows
+ */
+static void genVarBound(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int nbin = std::max(1, params.ncols / 2);
+	int ncont = std::max(1, params.ncols - nbin);
+	std::vector<double> ub(ncont);
+	for (int j = 0; j < nbin; j++)  model.addEmptyCol(fmt::format("y{}", j), 'B', 0.0, 1.0, rnd.getInt(10, 100));
+	for (int j = 0; j < ncont; j++)
+	{
+		ub[j] = rnd.getInt(10, 100);
+		model.addEmptyCol(colName(j), 'C', 0.0, ub[j], rnd.getInt(1, 5));
+	}
+	int i = 0;
+	// variable upper bounds
+	for (int j = 0; j < ncont; j++)
+	{
+		int idx[2] = {nbin + j, j % nbin};
+		double val[2] = {1.0, -ub[j]};
+		model.addRow(fmt::format("vub{}", j), idx, val, 2, 'L', 0.0);
+		i++;
+	}
+	// demands
+	std::vector<int> idx;
+	std::vector<double> val;
+	int ndemands = std::max(1, params.nrows - ncont);
+	for (int r = 0; r < ndemands; r++)
+	{
+		rnd.sample(ncont, params.rowNnz, idx);
+		double sum = 0.0;
+		for (int& j: idx)
+		{
+			sum += ub[j];
+			j += nbin;
+		}
+		val.assign(idx.size(), 1.0);
+		model.addRow(rowName(i++), &idx[0], &val[0], idx.size(), 'G', floor(rnd.getFloat(0.1, 0.5) * sum));
+	}
+}
+
+
+/**
+ * Generic mixed integer rows over binaries, general integers and continuous variables.
+ * Right hand sides are computed from a random reference point, so that the
+ * instance is feasible by construction.
+ */
+static void genMixedInt(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int n = params.ncols;
+	std::vector<double> ref(n);
+	for (int j = 0; j < n; j++)
+	{
+		switch (j % 3)
+		{
+			case 0:
+				model.addEmptyCol(colName(j), 'B', 0.0, 1.0, rnd.getInt(-10, 10));
+				ref[j] = rnd.getInt(0, 1);
+				break;
+			case 1:
+				model.addEmptyCol(colName(j), 'I', -5.0, 10.0, rnd.getInt(-10, 10));
+				ref[j] = rnd.getInt(-5, 10);
+				break;
+			default:
+				model.addEmptyCol(colName(j), 'C', 0.0, 100.0, rnd.getInt(-10, 10));
+				ref[j] = rnd.getFloat(0.0, 100.0);
+				break;
+		}
+	}
+	std::vector<int> idx;
+	std::vector<double> val;
+	for (int i = 0; i < params.nrows; i++)
+	{
+		rnd.sample(n, params.rowNnz, idx);
+		val.resize(idx.size());
+		double act = 0.0;
+		for (unsigned int k = 0; k < idx.size(); k++)
+		{
+			int c = rnd.getInt(1, 10);
+			val[k] = (rnd.getInt(0, 1) ? c : -c);
+			act += val[k] * ref[idx[k]];
+		}
+		int s = rnd.getInt(0, 19);
+		if (s < 2)  model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'E', act);
+		else if (s < 11)  model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'L', ceil(act) + rnd.getInt(0, 5));
+		else  model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'G', floor(act) - rnd.getInt(0, 5));
+	}
+}
+
+
+/**
+ * Set partitioning: min c^T x s.t. sum_{j in S_i} x_j = 1, x binary
+ * A hidden partition (the first nref columns, each covering a random group of rows)
+ * makes the instance feasible; every row is then completed with rowNnz-1 random other columns.
+ */
+static void genSetPartition(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int n = std::max(2, params.ncols);
+	int nref = std::max(1, std::min(n / 2, params.nrows / 3));
+	for (int j = 0; j < n; j++)  model.addEmptyCol(colName(j), 'B', 0.0, 1.0, rnd.getInt(1, 100));
+	std::vector<int> idx;
+	std::vector<double> val;
+	for (int i = 0; i < params.nrows; i++)
+	{
+		rnd.sample(n - nref, params.rowNnz - 1, idx);
+		for (int& j: idx)  j += nref;
+		idx.insert(idx.begin(), rnd.getInt(0, nref - 1));
+		val.assign(idx.size(), 1.0);
+		model.addRow(rowName(i), &idx[0], &val[0], idx.size(), 'E', 1.0);
+	}
+}
+
+
+/**
+ * Multi-dimensional knapsack: max p^T x s.t. W x <= C, x binary
+ * The nrows knapsack constraints are dense (rowNnz is ignored),
+ * with tightness ratio in [0.25,0.75] and profits correlated with the average weight.
+ */
+static void genMDKnapsack(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int n = params.ncols;
+	int m = params.nrows;
+	std::vector<double> avgWeight(n, 0.0);
+	std::vector<int> idx(n);
+	std::vector<double> val(n);
+	for (int j = 0; j < n; j++)
+	{
+		model.addEmptyCol(colName(j), 'B', 0.0, 1.0, 0.0);
+		idx[j] = j;
+	}
+	for (int i = 0; i < m; i++)
+	{
+		double sum = 0.0;
+		for (int j = 0; j < n; j++)
+		{
+			val[j] = rnd.getInt(1, 1000);
+			sum += val[j];
+			avgWeight[j] += val[j] / m;
+		}
+		model.addRow(rowName(i), &idx[0], &val[0], n, 'L', floor(rnd.getFloat(0.25, 0.75) * sum));
+	}
+	model.objSense(ObjSense::MAX);
+	for (int j = 0; j < n; j++)  model.objcoef(j, floor(avgWeight[j]) + rnd.getInt(0, 500));
+}
+
+
+/**
+ * Capacitated facility location (single source relaxed):
+ * F = rowNnz facilities y_f (binary), C = nrows - F customers and flows x_fc in [0,1],
+ * demand rows sum_f x_fc = 1 and capacity rows sum_c d_c x_fc <= s_f y_f.
+ * Total capacity is about three times the total demand (ncols is ignored).
+ */
+static void genFacility(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int nfac = std::max(2, params.rowNnz);
+	int ncust = std::max(1, params.nrows - nfac);
+	std::vector<double> demand(ncust);
+	double totDemand = 0.0;
+	for (int c = 0; c < ncust; c++)
+	{
+		demand[c] = rnd.getInt(5, 35);
+		totDemand += demand[c];
+	}
+	std::vector<double> capacity(nfac);
+	double totCap = 0.0;
+	for (int f = 0; f < nfac; f++)
+	{
+		capacity[f] = rnd.getInt(10, 160);
+		totCap += capacity[f];
+	}
+	double capScale = 3.0 * totDemand / totCap;
+	for (int f = 0; f < nfac; f++)
+	{
+		capacity[f] = ceil(capacity[f] * capScale);
+		model.addEmptyCol(fmt::format("y{}", f), 'B', 0.0, 1.0, rnd.getInt(300, 700) * capacity[f] / 100.0);
+	}
+	// flows: column nfac + c * nfac + f
+	for (int c = 0; c < ncust; c++)
+	{
+		for (int f = 0; f < nfac; f++)  model.addEmptyCol(fmt::format("x{}_{}", f, c), 'C', 0.0, 1.0, demand[c] * rnd.getInt(1, 100));
+	}
+	std::vector<int> idx(nfac);
+	std::vector<double> val(nfac, 1.0);
+	for (int c = 0; c < ncust; c++)
+	{
+		for (int f = 0; f < nfac; f++)  idx[f] = nfac + c * nfac + f;
+		model.addRow(fmt::format("dem{}", c), &idx[0], &val[0], nfac, 'E', 1.0);
+	}
+	idx.resize(ncust + 1);
+	val.resize(ncust + 1);
+	for (int f = 0; f < nfac; f++)
+	{
+		for (int c = 0; c < ncust; c++)
+		{
+			idx[c] = nfac + c * nfac + f;
+			val[c] = demand[c];
+		}
+		idx[ncust] = f;
+		val[ncust] = -capacity[f];
+		model.addRow(fmt::format("cap{}", f), &idx[0], &val[0], ncust + 1, 'L', 0.0);
+	}
+}
+
+
+/**
+ * Multi-item capacitated lot sizing with general integer production batches:
+ * T = rowNnz periods and P = (nrows - T) / (2T) items, with
+ * - batches x_pt (general integer), setups y_pt (binary), inventory s_pt (continuous)
+ * - balance s_{p,t-1} + b_p x_pt - s_pt = d_pt
+ * - setup x_pt <= U_p y_pt
+ * - capacity sum_p (b_p x_pt + st_p y_pt) <= Cap_t
+ * Capacities leave 30% slack w.r.t. the lot-for-lot plan, which is thus feasible (ncols is ignored).
+ */
+static void genLotSizing(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int nper = std::max(2, params.rowNnz);
+	int nitems = std::max(1, (params.nrows - nper) / (2 * nper));
+	std::vector< std::vector<double> > demand(nitems, std::vector<double>(nper));
+	std::vector<double> batch(nitems);
+	std::vector<double> setupTime(nitems);
+	std::vector<double> capacity(nper, 0.0);
+	for (int p = 0; p < nitems; p++)
+	{
+		batch[p] = rnd.getInt(5, 20);
+		setupTime[p] = rnd.getInt(10, 50);
+		double totDemand = 0.0;
+		for (int t = 0; t < nper; t++)
+		{
+			demand[p][t] = rnd.getInt(0, 100);
+			totDemand += demand[p][t];
+			capacity[t] += batch[p] * ceil(demand[p][t] / batch[p]) + setupTime[p];
+		}
+		double maxBatches = ceil(totDemand / batch[p]);
+		// columns for item p: x_pt, y_pt, s_pt for all t
+		for (int t = 0; t < nper; t++)  model.addEmptyCol(fmt::format("x{}_{}", p, t), 'I', 0.0, maxBatches, rnd.getInt(1, 5));
+		for (int t = 0; t < nper; t++)  model.addEmptyCol(fmt::format("y{}_{}", p, t), 'B', 0.0, 1.0, rnd.getInt(50, 500));
+		for (int t = 0; t < nper; t++)  model.addEmptyCol(fmt::format("s{}_{}", p, t), 'C', 0.0, totDemand + nper * batch[p], 1.0);
+	}
+	int colsPerItem = 3 * nper;
+	for (int p = 0; p < nitems; p++)
+	{
+		int xBeg = p * colsPerItem;
+		int yBeg = xBeg + nper;
+		int sBeg = yBeg + nper;
+		double maxBatches = 0.0;
+		for (int t = 0; t < nper; t++)  maxBatches += demand[p][t];
+		maxBatches = ceil(maxBatches / batch[p]);
+		for (int t = 0; t < nper; t++)
+		{
+			// balance
+			std::vector<int> idx = {xBeg + t, sBeg + t};
+			std::vector<double> val = {batch[p], -1.0};
+			if (t > 0)
+			{
+				idx.push_back(sBeg + t - 1);
+				val.push_back(1.0);
+			}
+			model.addRow(fmt::format("bal{}_{}", p, t), &idx[0], &val[0], idx.size(), 'E', demand[p][t]);
+			// setup
+			int sidx[2] = {xBeg + t, yBeg + t};
+			double sval[2] = {1.0, -maxBatches};
+			model.addRow(fmt::format("setup{}_{}", p, t), sidx, sval, 2, 'L', 0.0);
+		}
+	}
+	std::vector<int> idx(2 * nitems);
+	std::vector<double> val(2 * nitems);
+	for (int t = 0; t < nper; t++)
+	{
+		for (int p = 0; p < nitems; p++)
+		{
+			idx[2*p] = p * colsPerItem + t;
+			val[2*p] = batch[p];
+			idx[2*p+1] = p * colsPerItem + nper + t;
+			val[2*p+1] = setupTime[p];
+		}
+		model.addRow(fmt::format("cap{}", t), &idx[0], &val[0], 2 * nitems, 'L', ceil(1.3 * capacity[t]));
+	}
+}
+
+
+/**
+ * Big-M scheduling: jobs with release dates and processing times on parallel machines
+ * (fixed assignment), minimizing the weighted sum of start times.
+ * Each machine gets K = rowNnz jobs and, for each pair of jobs j<k on the same machine,
+ * an order binary z_jk and the disjunctive big-M constraints
+ * S_j + p_j <= S_k + M (1 - z_jk) and S_k + p_k <= S_j + M z_jk.
+ * The number of machines is nrows / (K (K-1)) (ncols is ignored).
+ */
+static void genScheduling(MemModel& model, const InstGenParams& params, InstRandom& rnd)
+{
+	int njobs = std::max(2, params.rowNnz);
+	int nmach = std::max(1, params.nrows / (njobs * (njobs - 1)));
+	std::vector<double> proc(njobs);
+	std::vector<double> release(njobs);
+	std::vector<int> startIdx(njobs);
+	int i = 0;
+	for (int mch = 0; mch < nmach; mch++)
+	{
+		double totProc = 0.0;
+		for (int j = 0; j < njobs; j++)
+		{
+			proc[j] = rnd.getInt(1, 20);
+			totProc += proc[j];
+		}
+		double maxRelease = 0.0;
+		for (int j = 0; j < njobs; j++)
+		{
+			release[j] = rnd.getInt(0, (int)(totProc / 2));
+			maxRelease = std::max(maxRelease, release[j]);
+		}
+		// any sequence (e.g., by release dates) starts all jobs within the horizon
+		double horizon = maxRelease + totProc;
+		for (int j = 0; j < njobs; j++)
+		{
+			startIdx[j] = model.ncols();
+			model.addEmptyCol(fmt::format("S{}_{}", mch, j), 'C', release[j], horizon, rnd.getInt(1, 10));
+		}
+		double bigM = horizon + 20.0;
+		for (int j = 0; j < njobs; j++)
+		{
+			for (int k = j + 1; k < njobs; k++)
+			{
+				int z = model.ncols();
+				model.addEmptyCol(fmt::format("z{}_{}_{}", mch, j, k), 'B', 0.0, 1.0, 0.0);
+				// S_j - S_k + M z_jk <= M - p_j
+				int idx1[3] = {startIdx[j], startIdx[k], z};
+				double val1[3] = {1.0, -1.0, bigM};
+				model.addRow(rowName(i++), idx1, val1, 3, 'L', bigM - proc[j]);
+				// S_k - S_j - M z_jk <= -p_k
+				double val2[3] = {-1.0, 1.0, -bigM};
+				model.addRow(rowName(i++), idx1, val2, 3, 'L', -proc[k]);
+			}
+		}
+	}
+}
+
+
+/**
+ * Sizing rules to hit a target number of nonzeros (given rowNnz)
+ */
+
+static void scaleGeneric(long long nnz, InstGenParams& params)
+{
+	// nrows = ncols and rowNnz nonzeros per row
+	params.nrows = params.ncols = std::max(1LL, nnz / params.rowNnz);
+}
+
+static void scaleVarBound(long long nnz, InstGenParams& params)
+{
+	// ncols/2 vubs with 2 nonzeros each + ncols/2 demand rows with rowNnz nonzeros each
+	params.nrows = params.ncols = std::max(2LL, (2 * nnz) / (2 + params.rowNnz));
+}
+
+static void scaleMDKnapsack(long long nnz, InstGenParams& params)
+{
+	// nrows dense rows (taken as given): only the number of items is scaled
+	params.nrows = std::max(1, params.nrows);
+	params.ncols = std::max(1LL, nnz / params.nrows);
+}
+
+static void scaleFacility(long long nnz, InstGenParams& params)
+{
+	// F = rowNnz facilities, C customers: about 2FC nonzeros
+	int nfac = std::max(2, params.rowNnz);
+	int ncust = std::max(1LL, nnz / (2 * nfac));
+	params.nrows = ncust + nfac;
+	params.ncols = nfac * (ncust + 1);
+}
+
+static void scaleLotSizing(long long nnz, InstGenParams& params)
+{
+	// T = rowNnz periods, P items: about 7PT nonzeros
+	int nper = std::max(2, params.rowNnz);
+	int nitems = std::max(1LL, nnz / (7 * nper));
+	params.nrows = 2 * nitems * nper + nper;
+	params.ncols = 3 * nitems * nper;
+}
+
+static void scaleScheduling(long long nnz, InstGenParams& params)
+{
+	// K = rowNnz jobs per machine, K(K-1) rows per machine with 3 nonzeros each
+	int njobs = std::max(2, params.rowNnz);
+	int nmach = std::max(1LL, nnz / (3 * njobs * (njobs - 1)));
+	params.nrows = nmach * njobs * (njobs - 1);
+	params.ncols = nmach * (njobs + njobs * (njobs - 1) / 2);
+}
+
+
+typedef void (*GenFunc)(MemModel&, const InstGenParams&, InstRandom&);
+typedef void (*ScaleFunc)(long long, InstGenParams&);
+
+struct GenEntry
+{
+	const char* name;
+	GenFunc func;
+	ScaleFunc scale;
+};
+
+static const GenEntry GENERATORS[] = {
+	{"setcover", genSetCover, scaleGeneric},
+	{"knapsack", genKnapsack, scaleGeneric},
+	{"varbound", genVarBound, scaleVarBound},
+	{"mixedint", genMixedInt, scaleGeneric},
+	{"setpart", genSetPartition, scaleGeneric},
+	{"mdknapsack", genMDKnapsack, scaleMDKnapsack},
+	{"facility", genFacility, scaleFacility},
+	{"lotsizing", genLotSizing, scaleLotSizing},
+	{"scheduling", genScheduling, scaleScheduling}
+};
+
+
+static const GenEntry& findGenerator(const std::string& family)
+{
+	for (const GenEntry& entry: GENERATORS)
+	{
+		if (family == entry.name)  return entry;
+	}
+	throw std::runtime_error(fmt::format("Unknown instance family {}", family));
+}
+
+
+std::shared_ptr<MemModel> generateInstance(const std::string& family, const InstGenParams& params)
+{
+	if ((params.nrows <= 0) || (params.ncols <= 0) || (params.rowNnz <= 0))
+	{
+		throw std::runtime_error("Invalid instance generator sizes");
+	}
+	const GenEntry& entry = findGenerator(family);
+	std::shared_ptr<MemModel> model = std::make_shared<MemModel>();
+	InstRandom rnd(params.seed);
+	entry.func(*model, params, rnd);
+	return model;
+}
+
+
+void scaleToNnz(const std::string& family, long long nnz, InstGenParams& params)
+{
+	if ((nnz <= 0) || (params.rowNnz <= 0))  throw std::runtime_error("Invalid instance generator sizes");
+	findGenerator(family).scale(nnz, params);
+}
+
+
+std::vector<std::string> instanceFamilies()
+{
+	std::vector<std::string> names;
+	for (const GenEntry& entry: GENERATORS)  names.push_back(entry.name);
+	return names;
+}
@@ -20,6 +20,12 @@
 
 #include "feaspump/feaspump.h"
 #include "feaspump/version.h"
+#include "feaspump/tracemodel.h"
+#include "feaspump/profmodel.h"
+#include "feaspump/wscache.h"
+#include "feaspump/features.h"
+#include "feaspump/presolve.h"
+#include "feaspump/decomposition.h"
 #ifdef HAS_CPLEX
 #include "feaspump/cpxmodel.h"
 #endif
@@ -36,6 +42,21 @@ using namespace dominiqs;
 
 static const uint64_t DEF_SEED = 0;
 
+
+/** fresh solver model, with its own environment (block pumps run concurrently) */
+static MIPModelPtr makeModel(const std::string& solver)
+{
+	MIPModelPtr model;
+#ifdef HAS_CPLEX
+	if (solver == "cpx")  model = MIPModelPtr(new CPXModel());
+#endif
+#ifdef HAS_XPRESS
+	if (solver == "xprs")  model = MIPModelPtr(new XPRSModel());
+#endif
+	if (!model)  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
+	return model;
+}
+
 int main (int argc, char const *argv[])
 {
 	// config/options
@@ -51,10 +72,20 @@ int main (int argc, char const *argv[])
 	std::string testset = gConfig().get("testset", std::string("unknown"));
 	std::string solver = gConfig().get("solver", std::string("cpx"));
 	bool mipPresolve = gConfig().get("mipPresolve", true);
+	bool fpPresolve = gConfig().get("fpPresolve", false);
 	int numThreads = gConfig().get("numThreads", 0);
 	bool printSol = gConfig().get("printSol", false);
 	double timeLimit = gConfig().get("fp.timeLimit", 1e+75);
 	std::string probName = getProbName(Path(args.input[0]).getBasename());
+	std::string traceMode = gConfig().get("traceMode", std::string("none"));
+	std::string traceFile = gConfig().get("traceFile", probName + ".trace.gz");
+	bool profileModel = gConfig().get("profileModel", false);
+	std::string warmStartCache = gConfig().get("warmStartCache", std::string(""));
+	int warmStartCacheSize = gConfig().get("warmStartCacheSize", 256);
+	std::string autoConfig = gConfig().get("autoConfig", std::string(""));
+	std::string autoConfigDir = gConfig().get("autoConfigDir", std::string("settings"));
+	bool decompose = gConfig().get("decompose", false);
+	int decompThreads = gConfig().get("decompThreads", 0);
 	// logger
 	consoleInfo("Timestamp: {}", currentDateTime());
 	consoleInfo("[config]");
@@ -63,10 +94,20 @@ int main (int argc, char const *argv[])
 	LOG_ITEM("solver", solver);
 	LOG_ITEM("runName", runName);
 	LOG_ITEM("presolve", mipPresolve);
+	LOG_ITEM("fpPresolve", fpPresolve);
 	LOG_ITEM("numThreads", numThreads);
 	LOG_ITEM("gitHash", FP_GIT_HASH);
 	LOG_ITEM("fpVersion", FP_VERSION);
 	LOG_ITEM("printSol", printSol);
+	LOG_ITEM("traceMode", traceMode);
+	if (traceMode != "none")  LOG_ITEM("traceFile", traceFile);
+	LOG_ITEM("profileModel", profileModel);
+	LOG_ITEM("warmStartCache", warmStartCache);
+	if (!warmStartCache.empty())  LOG_ITEM("warmStartCacheSize", warmStartCacheSize);
+	LOG_ITEM("autoConfig", autoConfig);
+	if (!autoConfig.empty())  LOG_ITEM("autoConfigDir", autoConfigDir);
+	LOG_ITEM("decompose", decompose);
+	if (decompose)  LOG_ITEM("decompThreads", decompThreads);
 	// seed
 	uint64_t seed = gConfig().get<uint64_t>("seed", DEF_SEED);
 	LOG_ITEM("seed", seed);
@@ -74,19 +115,46 @@ int main (int argc, char const *argv[])
 	gConfig().set<uint64_t>("seed", seed);
 
 	MIPModelPtr model;
+	TracePtr trace;
+	if (traceMode == "replay")
+	{
+		// no solver needed: all answers come from the trace
+		trace = std::make_shared<Trace>(traceFile, Trace::Mode::Replay);
+		model = std::make_shared<TraceModel>(trace);
+	}
+	else
+	{
 #ifdef HAS_CPLEX
-	if (solver == "cpx")  model = MIPModelPtr(new CPXModel());
+		if (solver == "cpx")  model = MIPModelPtr(new CPXModel());
 #else
-	if (solver == "cpx")  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
+		if (solver == "cpx")  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
 #endif
 #ifdef HAS_XPRESS
-	if (solver == "xprs")  model = MIPModelPtr(new XPRSModel());
+		if (solver == "xprs")  model = MIPModelPtr(new XPRSModel());
 #else
-	if (solver == "xprs")  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
+		if (solver == "xprs")  throw std::runtime_error(fmt::format("Did not compile support for solver {}", solver));
 #endif
+	}
 
 	if (!model)  throw std::runtime_error("No solver available for FP");
 
+	if (traceMode == "record")
+	{
+		trace = std::make_shared<Trace>(traceFile, Trace::Mode::Record);
+		model = std::make_shared<TraceModel>(model, trace);
+	}
+	else if ((traceMode != "none") && (traceMode != "replay"))
+	{
+		throw std::runtime_error(fmt::format("Unknown trace mode {}", traceMode));
+	}
+
+	ModelProfilePtr profile;
+	if (profileModel)
+	{
+		profile = std::make_shared<ModelProfile>();
+		model = std::make_shared<ProfiledModel>(model, profile);
+	}
+
 	DOMINIQS_ASSERT(model);
 	double integralityEps = model->dblParam(DblParam::IntegralityTolerance);
 	gConfig().set("fp.integralityEps", integralityEps);
@@ -128,21 +196,115 @@ int main (int argc, char const *argv[])
 		}
 		DOMINIQS_ASSERT( premodel );
 
+		// in-tree presolve (on top of the solver one)
+		Presolver fpPresolver;
+		bool hasFpPresolve = false;
+		if (fpPresolve)
+		{
+			fpPresolver.propThreads = gConfig().get("fp.propThreads", 1);
+			MIPModelPtr reduced = fpPresolver.presolve(*premodel);
+			fpPresolver.logStats();
+			if (reduced)
+			{
+				premodel = reduced;
+				hasFpPresolve = true;
+				consoleLog("fpPresolvedProblem: #rows={} #cols={} #nnz={}",
+						premodel->nrows(), premodel->ncols(), premodel->nnz());
+			}
+		}
+
+		// warm start cache (keyed by the structure of the presolved model)
+		std::unique_ptr<WarmStartCache> wsCache;
+		uint64_t wsKey = 0;
+		int preN = premodel->ncols();
+		int preM = premodel->nrows();
+		if (!warmStartCache.empty())
+		{
+			wsCache.reset(new WarmStartCache(warmStartCache, (uint64_t)warmStartCacheSize * 1024 * 1024));
+			wsKey = modelSignature(*premodel);
+		}
+
+		// feature based choice of the FP settings (command line overrides still win)
+		if (!autoConfig.empty())
+		{
+			StopWatch featWatch(true);
+			InstanceFeatures features = extractFeatures(*premodel);
+			DecisionTreeSelector selector;
+			selector.load(autoConfig);
+			std::string selected = selector.select(features);
+			featWatch.stop();
+			consoleInfo("[autoConfig]");
+			for (const auto& kv: features)  LOG_ITEM(kv.first, kv.second);
+			LOG_ITEM("selected", selected);
+			LOG_ITEM("featureTime", featWatch.getTotal());
+			std::string cfgFile = autoConfigDir + "/" + selected + ".cfg";
+			if (!std::ifstream(cfgFile))  throw std::runtime_error(fmt::format("Cannot open settings file {}", cfgFile));
+			gConfig().load(cfgFile);
+			ArgsParser overrides = args;
+			overrides.config.clear();
+			mergeConfig(overrides, gConfig());
+		}
+
+		// racing LPs run on two models in parallel: the trace and the profile are not thread safe
+		if (((traceMode != "none") || profileModel) && (gConfig().get("fp.lpStrategy", std::string("fixed")) == "race"))
+		{
+			consoleWarn("fp.lpStrategy = race is not supported with traceMode/profileModel: using adaptive");
+			gConfig().set("fp.lpStrategy", std::string("adaptive"));
+		}
+
+		// block decomposition (the sub-models need fresh solver environments: no trace/profiling)
+		std::unique_ptr<DecomposedPump> decomp;
+		if (decompose && (traceMode == "none") && !profileModel)
+		{
+			decomp.reset(new DecomposedPump([solver]() { return makeModel(solver); }));
+			if (!decomp->decompose(premodel))
+			{
+				consoleLog("decompBlocks = {}: no decomposition", decomp->blockCnt);
+				decomp.reset();
+			}
+		}
+
 		// feaspump
 		FeasibilityPump solver;
-		solver.readConfig();
+		bool found = false;
+		std::vector<double> preX;
+		if (!decomp)  solver.readConfig();
 		gStopWatch().start();
-		solver.init(premodel);
-		solver.pump();
+		if (decomp)
+		{
+			found = decomp->pump(decompThreads);
+			decomp->logStats();
+			LOG_ITEM("found", found);
+			if (found)  preX = decomp->solution();
+		}
+		else
+		{
+			solver.init(premodel);
+			if (wsCache)
+			{
+				WarmStart ws;
+				bool hit = wsCache->load(wsKey, preN, preM, ws);
+				consoleLog("warmStartKey = {:016x} hit = {}", wsKey, hit);
+				if (hit)  solver.setWarmStart(ws);
+			}
+			solver.pump();
+			if (wsCache)
+			{
+				WarmStart ws;
+				solver.getWarmStart(ws);
+				if (!ws.empty())  wsCache->store(wsKey, preN, preM, ws);
+			}
+			found = solver.foundSolution();
+			if (found)  solver.getSolution(preX);
+		}
 		std::vector<double> x;
-		if (solver.foundSolution())
+		if (found)
 		{
 			// uncrush solution
-			std::vector<double> preX;
-			solver.getSolution(preX);
+			DOMINIQS_ASSERT( (int)preX.size() == premodel->ncols() );
+			if (hasFpPresolve)  preX = fpPresolver.postsolve(preX);
 			if (hasPresolve)
 			{
-				DOMINIQS_ASSERT( (int)preX.size() == premodel->ncols() );
 				x = model->postsolveSolution(preX);
 				model->postsolve();
 			}
@@ -184,6 +346,8 @@ int main (int argc, char const *argv[])
 		}
 		solver.reset();
 		gStopWatch().stop();
+		if (trace)  consoleLog("traceRecords = {}", trace->records());
+		if (profile)  profile->print();
 	}
 	catch(std::exception& e)
 	{
@@ -0,0 +1,779 @@
+/**
+ * @file memmodel.cpp
+ * @brief In-memory implementation of MIPModelI (no solver attached)
+ */
+
+#include "feaspump/memmodel.h"
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <cmath>
+
+#include <utils/compress.h>
+#include <utils/str_utils.h>
+#include <fmt/format.h>
+
+using namespace dominiqs;
+
+static const double MPS_INFINITY = 1e20;
+
+
+static void throwNoSolver(const char* what)
+{
+	throw std::runtime_error(std::string("MemModel: ") + what + " requires a solver");
+}
+
+
+MemModel::MemModel() {}
+
+
+MemModel::~MemModel() {}
+
+
+/* Read/Write */
+void MemModel::readModel(const std::string& filename)
+{
+	throw std::runtime_error("MemModel: reading models is not supported");
+}
+
+
+void MemModel::writeModel(const std::string& filename, const std::string& format) const
+{
+	if (!format.empty() && (format != "mps") && (format != "MPS"))
+	{
+		throw std::runtime_error(fmt::format("MemModel: unsupported model format {}", format));
+	}
+	if (ends_with(filename, ".gz"))
+	{
+		ogzstream out(filename.c_str());
+		if (!out)  throw std::runtime_error(fmt::format("Cannot open file {}", filename));
+		writeMPS(out, filename);
+	}
+	else
+	{
+		std::ofstream out(filename.c_str());
+		if (!out)  throw std::runtime_error(fmt::format("Cannot open file {}", filename));
+		writeMPS(out, filename);
+	}
+}
+
+
+void MemModel::writeMPS(std::ostream& out, const std::string& filename) const
+{
+	int n = ncols();
+	int m = nrows();
+	std::vector<std::string> cnames(n);
+	std::vector<std::string> rnames(m);
+	for (int j = 0; j < n; j++)  cnames[j] = xNames[j].empty() ? fmt::format("x{}", j) : xNames[j];
+	for (int i = 0; i < m; i++)  rnames[i] = constraints[i]->name.empty() ? fmt::format("c{}", i) : constraints[i]->name;
+	std::string probName = filename;
+	size_t slash = probName.rfind('/');
+	if (slash != std::string::npos)  probName = probName.substr(slash + 1);
+	probName = probName.substr(0, probName.find('.'));
+	// header
+	out << "NAME          " << probName << "\n";
+	if (objsen == ObjSense::MAX)  out << "OBJSENSE\n    MAX\n";
+	// rows (ranged rows are written as L rows + range: this matches our convention [rhs-range,rhs])
+	out << "ROWS\n";
+	out << " N  OBJ\n";
+	for (int i = 0; i < m; i++)
+	{
+		char sense = constraints[i]->sense;
+		out << " " << ((sense == 'R') ? 'L' : sense) << "  " << rnames[i] << "\n";
+	}
+	// columns (column major)
+	SparseMatrix matrix;
+	cols(matrix);
+	out << "COLUMNS\n";
+	bool inIntSection = false;
+	int markers = 0;
+	for (int j = 0; j < n; j++)
+	{
+		bool isInt = (xType[j] != 'C');
+		if (isInt != inIntSection)
+		{
+			out << fmt::format("    MARKER{}  'MARKER'  '{}'\n", markers++, isInt ? "INTORG" : "INTEND");
+			inIntSection = isInt;
+		}
+		if (xObj[j] != 0.0)  out << fmt::format("    {}  OBJ  {}\n", cnames[j], xObj[j]);
+		for (int k = matrix.matbeg[j]; k < matrix.matbeg[j+1]; k++)
+		{
+			out << fmt::format("    {}  {}  {}\n", cnames[j], rnames[matrix.matind[k]], matrix.matval[k]);
+		}
+		// make sure empty columns are not lost
+		if ((xObj[j] == 0.0) && (matrix.matbeg[j] == matrix.matbeg[j+1]))  out << fmt::format("    {}  OBJ  0\n", cnames[j]);
+	}
+	if (inIntSection)  out << fmt::format("    MARKER{}  'MARKER'  'INTEND'\n", markers++);
+	// rhs (objective offset goes with the opposite sign)
+	out << "RHS\n";
+	if (objoff != 0.0)  out << fmt::format("    RHS  OBJ  {}\n", -objoff);
+	for (int i = 0; i < m; i++)
+	{
+		if (constraints[i]->rhs != 0.0)  out << fmt::format("    RHS  {}  {}\n", rnames[i], constraints[i]->rhs);
+	}
+	// ranges
+	bool hasRanges = false;
+	for (int i = 0; i < m; i++)
+	{
+		if (constraints[i]->sense != 'R')  continue;
+		if (!hasRanges)
+		{
+			out << "RANGES\n";
+			hasRanges = true;
+		}
+		out << fmt::format("    RNG  {}  {}\n", rnames[i], fabs(constraints[i]->range));
+	}
+	// bounds (integer variables get explicit bounds, as readers differ on their defaults)
+	out << "BOUNDS\n";
+	for (int j = 0; j < n; j++)
+	{
+		double lb = xLb[j];
+		double ub = xUb[j];
+		if ((xType[j] == 'B') && (lb == 0.0) && (ub == 1.0))
+		{
+			out << fmt::format(" BV BND  {}\n", cnames[j]);
+			continue;
+		}
+		if (lb == ub)
+		{
+			out << fmt::format(" FX BND  {}  {}\n", cnames[j], lb);
+			continue;
+		}
+		bool isInt = (xType[j] != 'C');
+		if ((lb <= -MPS_INFINITY) && (ub >= MPS_INFINITY))
+		{
+			out << fmt::format(" FR BND  {}\n", cnames[j]);
+			continue;
+		}
+		if (lb <= -MPS_INFINITY)  out << fmt::format(" MI BND  {}\n", cnames[j]);
+		else if ((lb != 0.0) || isInt)  out << fmt::format(" LO BND  {}  {}\n", cnames[j], lb);
+		if (ub >= MPS_INFINITY)
+		{
+			if (isInt)  out << fmt::format(" PL BND  {}\n", cnames[j]);
+		}
+		else  out << fmt::format(" UP BND  {}  {}\n", cnames[j], ub);
+	}
+	out << "ENDATA\n";
+}
+
+
+void MemModel::writeSol(const std::string& filename) const
+{
+	throwNoSolver("writeSol");
+}
+
+
+/* Solve */
+void MemModel::lpopt(char method)
+{
+	throwNoSolver("lpopt");
+}
+
+
+void MemModel::mipopt()
+{
+	throwNoSolver("mipopt");
+}
+
+
+void MemModel::presolve()
+{
+	throwNoSolver("presolve");
+}
+
+
+void MemModel::postsolve()
+{
+	// no-op: the model is never presolved
+}
+
+
+std::vector<double> MemModel::postsolveSolution(const std::vector<double>& preX) const
+{
+	return preX;
+}
+
+
+/* Get solution */
+double MemModel::objval() const
+{
+	throwNoSolver("objval");
+	return 0.0;
+}
+
+
+void MemModel::sol(double* x, int first, int last) const
+{
+	throwNoSolver("sol");
+}
+
+
+bool MemModel::isPrimalFeas() const
+{
+	return false;
+}
+
+
+/* Basis */
+bool MemModel::getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const
+{
+	// nothing was ever solved
+	return false;
+}
+
+
+void MemModel::setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat)
+{
+	DOMINIQS_ASSERT((int)cstat.size() == ncols() && (int)rstat.size() == nrows());
+	// no solver to warm start: ignore
+}
+
+
+/* Parameters */
+void MemModel::handleCtrlC(bool flag)
+{
+	// nothing to interrupt
+}
+
+
+bool MemModel::aborted() const
+{
+	return false;
+}
+
+
+void MemModel::interrupt()
+{
+	// nothing to interrupt
+}
+
+
+void MemModel::armInterrupt()
+{
+	// nothing to interrupt
+}
+
+
+void MemModel::seed(int seed)
+{
+}
+
+
+void MemModel::logging(bool log)
+{
+}
+
+
+int MemModel::intParam(IntParam which) const
+{
+	switch(which)
+	{
+		case IntParam::Threads: return threads;
+		case IntParam::SolutionLimit: return solutionLimit;
+		case IntParam::NodeLimit: return nodeLimit;
+		case IntParam::IterLimit: return iterLimit;
+		case IntParam::Crossover: return crossover;
+		default:
+			throw std::runtime_error("Unknown integer parameter");
+	}
+	return 0;
+}
+
+
+void MemModel::intParam(IntParam which, int value)
+{
+	switch(which)
+	{
+		case IntParam::Threads: threads = value; break;
+		case IntParam::SolutionLimit: solutionLimit = value; break;
+		case IntParam::NodeLimit: nodeLimit = value; break;
+		case IntParam::IterLimit: iterLimit = value; break;
+		case IntParam::Crossover: crossover = value; break;
+		default:
+			throw std::runtime_error("Unknown integer parameter");
+	}
+}
+
+
+double MemModel::dblParam(DblParam which) const
+{
+	switch(which)
+	{
+		case DblParam::TimeLimit: return timeLimit;
+		case DblParam::FeasibilityTolerance: return feasTol;
+		case DblParam::IntegralityTolerance: return intTol;
+		case DblParam::ObjLowerLimit: return objLowerLimit;
+		case DblParam::ObjUpperLimit: return objUpperLimit;
+		default:
+			throw std::runtime_error("Unknown double parameter");
+	}
+	return 0.0;
+}
+
+
+void MemModel::dblParam(DblParam which, double value)
+{
+	switch(which)
+	{
+		case DblParam::TimeLimit: timeLimit = value; break;
+		case DblParam::FeasibilityTolerance: feasTol = value; break;
+		case DblParam::IntegralityTolerance: intTol = value; break;
+		case DblParam::ObjLowerLimit: objLowerLimit = value; break;
+		case DblParam::ObjUpperLimit: objUpperLimit = value; break;
+		default:
+			throw std::runtime_error("Unknown double parameter");
+	}
+}
+
+
+int MemModel::intAttr(IntAttr which) const
+{
+	// nothing was ever solved
+	return 0;
+}
+
+
+double MemModel::dblAttr(DblAttr which) const
+{
+	throwNoSolver("dblAttr");
+	return 0.0;
+}
+
+
+/* Access model data */
+int MemModel::nrows() const
+{
+	return (int)constraints.size();
+}
+
+
+int MemModel::ncols() const
+{
+	return (int)xType.size();
+}
+
+
+int MemModel::nnz() const
+{
+	return numNnz;
+}
+
+
+double MemModel::objOffset() const
+{
+	return objoff;
+}
+
+
+ObjSense MemModel::objSense() const
+{
+	return objsen;
+}
+
+
+void MemModel::lbs(double* lb, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	if (last == -1)  last = ncols()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	std::copy(xLb.begin() + first, xLb.begin() + last + 1, lb);
+}
+
+
+void MemModel::ubs(double* ub, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	if (last == -1)  last = ncols()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	std::copy(xUb.begin() + first, xUb.begin() + last + 1, ub);
+}
+
+
+void MemModel::objcoefs(double* obj, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	if (last == -1)  last = ncols()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	std::copy(xObj.begin() + first, xObj.begin() + last + 1, obj);
+}
+
+
+void MemModel::ctypes(char* ctype, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	if (last == -1)  last = ncols()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	std::copy(xType.begin() + first, xType.begin() + last + 1, ctype);
+}
+
+
+void MemModel::sense(char* sense, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < nrows()));
+	if (last == -1)  last = nrows()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < nrows()));
+	DOMINIQS_ASSERT(first <= last);
+	for (int i = first; i <= last; i++)  *sense++ = constraints[i]->sense;
+}
+
+
+void MemModel::rhs(double* rhs, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < nrows()));
+	if (last == -1)  last = nrows()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < nrows()));
+	DOMINIQS_ASSERT(first <= last);
+	for (int i = first; i <= last; i++)  *rhs++ = constraints[i]->rhs;
+}
+
+
+void MemModel::row(int ridx, dominiqs::SparseVector& row, char& sense, double& rhs, double& rngval) const
+{
+	DOMINIQS_ASSERT((ridx >= 0) && (ridx < nrows()));
+	const dominiqs::Constraint& c = *constraints[ridx];
+	row = c.row;
+	sense = c.sense;
+	rhs = c.rhs;
+	rngval = c.range;
+}
+
+
+void MemModel::rows(dominiqs::SparseMatrix& matrix) const
+{
+	int m = nrows();
+	matrix.matbeg.resize(m+1);
+	matrix.k = m+1;
+	matrix.nnz = numNnz;
+	matrix.matind.resize(numNnz);
+	matrix.matval.resize(numNnz);
+	int offset = 0;
+	for (int i = 0; i < m; i++)
+	{
+		const dominiqs::SparseVector& r = constraints[i]->row;
+		matrix.matbeg[i] = offset;
+		std::copy(r.idx(), r.idx() + r.size(), matrix.matind.begin() + offset);
+		std::copy(r.coef(), r.coef() + r.size(), matrix.matval.begin() + offset);
+		offset += r.size();
+	}
+	matrix.matbeg[m] = offset;
+	DOMINIQS_ASSERT(offset == numNnz);
+}
+
+
+void MemModel::col(int cidx, dominiqs::SparseVector& col, char& type, double& lb, double& ub, double& obj) const
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	col.clear();
+	int m = nrows();
+	for (int i = 0; i < m; i++)
+	{
+		const dominiqs::SparseVector& r = constraints[i]->row;
+		const int* idx = r.idx();
+		for (unsigned int k = 0; k < r.size(); k++)
+		{
+			if (idx[k] == cidx)  col.push(i, r.coef()[k]);
+		}
+	}
+	type = xType[cidx];
+	lb = xLb[cidx];
+	ub = xUb[cidx];
+	obj = xObj[cidx];
+}
+
+
+void MemModel::cols(dominiqs::SparseMatrix& matrix) const
+{
+	int n = ncols();
+	int m = nrows();
+	// count entries per column
+	std::vector<int> cnt(n, 0);
+	for (int i = 0; i < m; i++)
+	{
+		const dominiqs::SparseVector& r = constraints[i]->row;
+		for (unsigned int k = 0; k < r.size(); k++)  cnt[r.idx()[k]]++;
+	}
+	matrix.matbeg.resize(n+1);
+	matrix.k = n+1;
+	matrix.nnz = numNnz;
+	matrix.matind.resize(numNnz);
+	matrix.matval.resize(numNnz);
+	int offset = 0;
+	for (int j = 0; j < n; j++)
+	{
+		matrix.matbeg[j] = offset;
+		offset += cnt[j];
+		cnt[j] = matrix.matbeg[j];
+	}
+	matrix.matbeg[n] = offset;
+	// fill (rows are visited in order, so row indices come out sorted)
+	for (int i = 0; i < m; i++)
+	{
+		const dominiqs::SparseVector& r = constraints[i]->row;
+		for (unsigned int k = 0; k < r.size(); k++)
+		{
+			int pos = cnt[r.idx()[k]]++;
+			matrix.matind[pos] = i;
+			matrix.matval[pos] = r.coef()[k];
+		}
+	}
+}
+
+
+void MemModel::colNames(std::vector<std::string>& names, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	if (last == -1)  last = ncols()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	names.assign(xNames.begin() + first, xNames.begin() + last + 1);
+}
+
+
+void MemModel::rowNames(std::vector<std::string>& names, int first, int last) const
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < nrows()));
+	if (last == -1)  last = nrows()-1;
+	DOMINIQS_ASSERT((last >= 0) && (last < nrows()));
+	DOMINIQS_ASSERT(first <= last);
+	names.clear();
+	for (int i = first; i <= last; i++)  names.push_back(constraints[i]->name);
+}
+
+
+/* Data modifications */
+void MemModel::addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj)
+{
+	DOMINIQS_ASSERT((ctype == 'B') || (ctype == 'I') || (ctype == 'C'));
+	xNames.push_back(name);
+	xType.push_back(ctype);
+	xLb.push_back(lb);
+	xUb.push_back(ub);
+	xObj.push_back(obj);
+}
+
+
+void MemModel::addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj)
+{
+	addEmptyCol(name, ctype, lb, ub, obj);
+	int cidx = ncols() - 1;
+	for (int k = 0; k < cnt; k++)
+	{
+		DOMINIQS_ASSERT((idx[k] >= 0) && (idx[k] < nrows()));
+		constraints[idx[k]]->row.push(cidx, val[k]);
+	}
+	numNnz += cnt;
+}
+
+
+void MemModel::addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval)
+{
+	DOMINIQS_ASSERT((sense == 'L') || (sense == 'G') || (sense == 'E') || (sense == 'R') || (sense == 'N'));
+	dominiqs::ConstraintPtr c = std::make_shared<dominiqs::Constraint>();
+	c->name = name;
+	if (cnt)  c->row.copy(idx, val, cnt);
+	c->sense = sense;
+	c->rhs = rhs;
+	c->range = (sense == 'R') ? rngval : 0.0;
+	constraints.push_back(c);
+	numNnz += cnt;
+}
+
+
+void MemModel::addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs)
+{
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	for (int k = 0; k < cnt; k++)  addEmptyCol(names.empty() ? "" : names[k], ctypes[k], lbs[k], ubs[k], objs[k]);
+}
+
+
+void MemModel::addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals)
+{
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	for (int k = 0; k < cnt; k++)
+	{
+		addRow(names.empty() ? "" : names[k], idx + beg[k], val + beg[k], beg[k+1] - beg[k],
+				senses[k], rhss[k], rngvals ? rngvals[k] : 0.0);
+	}
+}
+
+
+void MemModel::delRow(int ridx)
+{
+	delRows(ridx, ridx);
+}
+
+
+void MemModel::delCol(int cidx)
+{
+	delCols(cidx, cidx);
+}
+
+
+void MemModel::delRows(int first, int last)
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < nrows()));
+	DOMINIQS_ASSERT((last >= 0) && (last < nrows()));
+	DOMINIQS_ASSERT(first <= last);
+	for (int i = first; i <= last; i++)  numNnz -= constraints[i]->row.size();
+	constraints.erase(constraints.begin() + first, constraints.begin() + last + 1);
+}
+
+
+void MemModel::delRowSet(int cnt, const int* rows)
+{
+	int m = nrows();
+	std::vector<char> del(m, 0);
+	for (int k = 0; k < cnt; k++)
+	{
+		DOMINIQS_ASSERT((rows[k] >= 0) && (rows[k] < m));
+		del[rows[k]] = 1;
+	}
+	int kept = 0;
+	for (int i = 0; i < m; i++)
+	{
+		if (del[i])  numNnz -= constraints[i]->row.size();
+		else  constraints[kept++] = constraints[i];
+	}
+	constraints.resize(kept);
+}
+
+
+void MemModel::delCols(int first, int last)
+{
+	DOMINIQS_ASSERT((first >= 0) && (first < ncols()));
+	DOMINIQS_ASSERT((last >= 0) && (last < ncols()));
+	DOMINIQS_ASSERT(first <= last);
+	int count = last - first + 1;
+	// remove the entries from the rows and shift the remaining indices
+	for (dominiqs::ConstraintPtr c: constraints)
+	{
+		int* idx = c->row.idx();
+		double* coef = c->row.coef();
+		unsigned int size = c->row.size();
+		unsigned int kept = 0;
+		for (unsigned int k = 0; k < size; k++)
+		{
+			if ((idx[k] >= first) && (idx[k] <= last))  continue;
+			idx[kept] = (idx[k] > last) ? (idx[k] - count) : idx[k];
+			coef[kept] = coef[k];
+			kept++;
+		}
+		numNnz -= (size - kept);
+		c->row.resize(kept);
+	}
+	xNames.erase(xNames.begin() + first, xNames.begin() + last + 1);
+	xType.erase(xType.begin() + first, xType.begin() + last + 1);
+	xLb.erase(xLb.begin() + first, xLb.begin() + last + 1);
+	xUb.erase(xUb.begin() + first, xUb.begin() + last + 1);
+	xObj.erase(xObj.begin() + first, xObj.begin() + last + 1);
+}
+
+
+void MemModel::objSense(ObjSense _objsen)
+{
+	objsen = _objsen;
+}
+
+
+void MemModel::objOffset(double val)
+{
+	objoff = val;
+}
+
+
+void MemModel::lb(int cidx, double val)
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	xLb[cidx] = val;
+}
+
+
+void MemModel::lbs(int cnt, const int* cols, const double* values)
+{
+	for (int k = 0; k < cnt; k++)  lb(cols[k], values[k]);
+}
+
+
+void MemModel::ub(int cidx, double val)
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	xUb[cidx] = val;
+}
+
+
+void MemModel::ubs(int cnt, const int* cols, const double* values)
+{
+	for (int k = 0; k < cnt; k++)  ub(cols[k], values[k]);
+}
+
+
+void MemModel::fixCol(int cidx, double val)
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	xLb[cidx] = val;
+	xUb[cidx] = val;
+}
+
+
+void MemModel::objcoef(int cidx, double val)
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	xObj[cidx] = val;
+}
+
+
+void MemModel::objcoefs(int cnt, const int* cols, const double* values)
+{
+	for (int k = 0; k < cnt; k++)  objcoef(cols[k], values[k]);
+}
+
+
+void MemModel::rhs(int cnt, const int* rows, const double* values)
+{
+	for (int k = 0; k < cnt; k++)
+	{
+		DOMINIQS_ASSERT((rows[k] >= 0) && (rows[k] < nrows()));
+		constraints[rows[k]]->rhs = values[k];
+	}
+}
+
+
+void MemModel::ctype(int cidx, char val)
+{
+	DOMINIQS_ASSERT((cidx >= 0) && (cidx < ncols()));
+	DOMINIQS_ASSERT((val == 'B') || (val == 'I') || (val == 'C'));
+	xType[cidx] = val;
+}
+
+
+void MemModel::ctypes(int cnt, const int* cols, const char* values)
+{
+	for (int k = 0; k < cnt; k++)  ctype(cols[k], values[k]);
+}
+
+
+void MemModel::switchToLP()
+{
+	std::fill(xType.begin(), xType.end(), 'C');
+}
+
+
+/* Private interface */
+MemModel* MemModel::clone_impl() const
+{
+	MemModel* cloned = new MemModel(*this);
+	// deep copy of the rows
+	for (dominiqs::ConstraintPtr& c: cloned->constraints)  c = dominiqs::ConstraintPtr(c->clone());
+	return cloned;
+}
+
+
+MemModel* MemModel::presolvedmodel_impl()
+{
+	// no presolve: same as the other backends when no reduction was made
+	return nullptr;
+}
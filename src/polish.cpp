@@ -0,0 +1,196 @@
+/**
+ * @file polish.cpp
+ * @brief Local search polishing of feasible solutions
+ */
+
+#include "feaspump/polish.h"
+#include <cmath>
+#include <algorithm>
+
+#include <utils/floats.h>
+
+using namespace dominiqs;
+
+static const double POLISH_INF = 1e20;
+static const double POLISH_EPS = 1e-9;
+static const int MAX_POLISH_PASSES = 5;
+static const int MAX_2OPT_CANDIDATES = 50;
+
+
+void Polisher::init(const std::vector<ConstraintPtr>& _rows, const std::vector<char>& _xType,
+		const std::vector<double>& _lb, const std::vector<double>& _ub, const std::vector<double>& _obj)
+{
+	rows = _rows;
+	xType = _xType;
+	lb = _lb;
+	ub = _ub;
+	obj = _obj;
+	int m = rows.size();
+	int n = xType.size();
+	// row bounds
+	rowLhs.resize(m);
+	rowRhs.resize(m);
+	for (int i = 0; i < m; i++)
+	{
+		const Constraint& c = *rows[i];
+		rowLhs[i] = -POLISH_INF;
+		rowRhs[i] = POLISH_INF;
+		if (c.sense == 'L' || c.sense == 'E' || c.sense == 'R')  rowRhs[i] = c.rhs;
+		if (c.sense == 'G' || c.sense == 'E')  rowLhs[i] = c.rhs;
+		if (c.sense == 'R')  rowLhs[i] = c.rhs - c.range;
+	}
+	// column-major copy
+	colBeg.assign(n + 1, 0);
+	for (int i = 0; i < m; i++)
+	{
+		const SparseVector& row = rows[i]->row;
+		const int* idx = row.idx();
+		for (unsigned int k = 0; k < row.size(); k++)  colBeg[idx[k] + 1]++;
+	}
+	for (int j = 0; j < n; j++)  colBeg[j + 1] += colBeg[j];
+	colRow.resize(colBeg[n]);
+	colCoef.resize(colBeg[n]);
+	std::vector<int> fill(colBeg.begin(), colBeg.end() - 1);
+	for (int i = 0; i < m; i++)
+	{
+		const SparseVector& row = rows[i]->row;
+		const int* idx = row.idx();
+		const double* coef = row.coef();
+		for (unsigned int k = 0; k < row.size(); k++)
+		{
+			int pos = fill[idx[k]]++;
+			colRow[pos] = i;
+			colCoef[pos] = coef[k];
+		}
+	}
+	activity.assign(m, 0.0);
+	delta.assign(m, 0.0);
+}
+
+
+double Polisher::maxStep(int j, double dir, const std::vector<double>& x) const
+{
+	// bound
+	double step = (dir > 0.0) ? (ub[j] - x[j]) : (x[j] - lb[j]);
+	if (step >= POLISH_INF)  step = POLISH_INF;
+	// rows
+	for (int k = colBeg[j]; k < colBeg[j+1] && step > 0.0; k++)
+	{
+		int i = colRow[k];
+		double a = dir * colCoef[k];
+		double slack;
+		if (a > 0.0)  slack = (rowRhs[i] >= POLISH_INF) ? POLISH_INF : (rowRhs[i] - activity[i]);
+		else  slack = (rowLhs[i] <= -POLISH_INF) ? POLISH_INF : (activity[i] - rowLhs[i]);
+		if (slack >= POLISH_INF)  continue;
+		step = std::min(step, std::max(slack, 0.0) / std::fabs(a));
+	}
+	if (isInt(j))  step = std::floor(step + POLISH_EPS);
+	return std::max(step, 0.0);
+}
+
+
+void Polisher::move(int j, double step, std::vector<double>& x)
+{
+	x[j] += step;
+	for (int k = colBeg[j]; k < colBeg[j+1]; k++)  activity[colRow[k]] += colCoef[k] * step;
+}
+
+
+bool Polisher::oneOpt(int j, std::vector<double>& x)
+{
+	double dir = (obj[j] > 0.0) ? -1.0 : 1.0;
+	double step = maxStep(j, dir, x);
+	if (step < POLISH_EPS || step >= POLISH_INF)  return false;
+	move(j, dir * step, x);
+	oneOptMoves++;
+	return true;
+}
+
+
+bool Polisher::twoOpt(int j, std::vector<double>& x)
+{
+	double dj = (obj[j] > 0.0) ? -1.0 : 1.0;
+	double nx = x[j] + dj;
+	if (nx < lb[j] - POLISH_EPS || nx > ub[j] + POLISH_EPS)  return false;
+	// find the (single) row blocking a unit step of j
+	int blocking = -1;
+	for (int k = colBeg[j]; k < colBeg[j+1]; k++)
+	{
+		int i = colRow[k];
+		double newAct = activity[i] + colCoef[k] * dj;
+		if ((newAct > rowRhs[i] + POLISH_EPS) || (newAct < rowLhs[i] - POLISH_EPS))
+		{
+			if (blocking >= 0)  return false;
+			blocking = k;
+		}
+	}
+	if (blocking < 0)  return false;
+	int bi = colRow[blocking];
+	double excess = activity[bi] + colCoef[blocking] * dj;
+	// direction in which the partner must move the activity of the blocking row
+	double fixDir = (excess > rowRhs[bi]) ? -1.0 : 1.0;
+	// partner search
+	for (int k = colBeg[j]; k < colBeg[j+1]; k++)  delta[colRow[k]] = colCoef[k] * dj;
+	const SparseVector& brow = rows[bi]->row;
+	const int* idx = brow.idx();
+	const double* coef = brow.coef();
+	int bestPartner = -1;
+	double bestDir = 0.0;
+	double bestGain = std::fabs(obj[j]);
+	int tried = 0;
+	for (unsigned int p = 0; p < brow.size() && tried < MAX_2OPT_CANDIDATES; p++)
+	{
+		int h = idx[p];
+		if (h == j || !isInt(h))  continue;
+		double dh = ((coef[p] * fixDir) > 0.0) ? 1.0 : -1.0;
+		// the pair must improve the objective
+		if (obj[h] * dh >= bestGain - POLISH_EPS)  continue;
+		double nh = x[h] + dh;
+		if (nh < lb[h] - POLISH_EPS || nh > ub[h] + POLISH_EPS)  continue;
+		tried++;
+		bool feasible = true;
+		for (int k = colBeg[h]; k < colBeg[h+1] && feasible; k++)
+		{
+			int i = colRow[k];
+			double newAct = activity[i] + delta[i] + colCoef[k] * dh;
+			feasible = (newAct <= rowRhs[i] + POLISH_EPS) && (newAct >= rowLhs[i] - POLISH_EPS);
+		}
+		if (!feasible)  continue;
+		bestPartner = h;
+		bestDir = dh;
+		bestGain = obj[h] * dh;
+	}
+	for (int k = colBeg[j]; k < colBeg[j+1]; k++)  delta[colRow[k]] = 0.0;
+	if (bestPartner < 0)  return false;
+	move(j, dj, x);
+	move(bestPartner, bestDir, x);
+	twoOptMoves++;
+	return true;
+}
+
+
+double Polisher::polish(std::vector<double>& x)
+{
+	int m = rows.size();
+	int n = xType.size();
+	if (!ready() || (int)x.size() < n)  return 0.0;
+	for (int i = 0; i < m; i++)  activity[i] = dotProduct(rows[i]->row, &x[0]);
+	double before = dotProduct(&obj[0], &x[0], n);
+	for (int pass = 0; pass < MAX_POLISH_PASSES; pass++)
+	{
+		bool improved = false;
+		for (int j = 0; j < n; j++)
+		{
+			if (obj[j] == 0.0)  continue;
+			if (oneOpt(j, x))  improved = true;
+		}
+		for (int j = 0; j < n; j++)
+		{
+			if (obj[j] == 0.0 || !isInt(j))  continue;
+			if (twoOpt(j, x))  improved = true;
+		}
+		if (!improved)  break;
+	}
+	double after = dotProduct(&obj[0], &x[0], n);
+	return std::max(before - after, 0.0);
+}
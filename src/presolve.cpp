@@ -0,0 +1,477 @@
+/**
+ * @file presolve.cpp
+ * @brief Lightweight in-tree presolve (with postsolve stack)
+ */
+
+#include "feaspump/presolve.h"
+#include <cmath>
+#include <list>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include <utils/floats.h>
+#include <utils/timer.h>
+#include <utils/consolelog.h>
+#include <propagator/domain.h>
+#include <propagator/prop_engine.h>
+#include <propagator/logic_propagator.h>
+
+using namespace dominiqs;
+
+static const int MAX_PRESOLVE_ROUNDS = 10;
+static const double PRESOLVE_EPS = 1e-9;
+static const double PRESOLVE_FEASTOL = 1e-6;
+static const int MAX_PARALLEL_CMP = 16; //< max comparisons of a row against the rows with the same support
+
+
+/** row as an interval: linear expression in [lo,hi] */
+static void rowBounds(const Constraint& c, double& lo, double& hi)
+{
+	lo = -INFBOUND;
+	hi = INFBOUND;
+	if (c.sense == 'L' || c.sense == 'E' || c.sense == 'R')  hi = c.rhs;
+	if (c.sense == 'G' || c.sense == 'E')  lo = c.rhs;
+	if (c.sense == 'R')  lo = c.rhs - c.range;
+}
+
+
+/** inverse of rowBounds() (ranged rows use our convention: [rhs-range,rhs]) */
+static void setRowBounds(Constraint& c, double lo, double hi)
+{
+	c.range = 0.0;
+	if (lo <= -INFBOUND && hi >= INFBOUND)  c.sense = 'N';
+	else if (lo <= -INFBOUND)
+	{
+		c.sense = 'L';
+		c.rhs = hi;
+	}
+	else if (hi >= INFBOUND)
+	{
+		c.sense = 'G';
+		c.rhs = lo;
+	}
+	else if (isNull(hi - lo, PRESOLVE_EPS))
+	{
+		c.sense = 'E';
+		c.rhs = lo;
+	}
+	else
+	{
+		c.sense = 'R';
+		c.rhs = hi;
+		c.range = hi - lo;
+	}
+}
+
+
+/** row entries sorted by column index, scaled so that the first coefficient is 1 */
+static std::vector<std::pair<int, double>> normalizedRow(const SparseVector& row, double& scale)
+{
+	std::vector<std::pair<int, double>> entries(row.size());
+	const int* idx = row.idx();
+	const double* coef = row.coef();
+	for (unsigned int k = 0; k < row.size(); k++)  entries[k] = std::make_pair(idx[k], coef[k]);
+	std::sort(entries.begin(), entries.end());
+	scale = 1.0 / entries[0].second;
+	for (auto& e: entries)  e.second *= scale;
+	return entries;
+}
+
+
+void Presolver::clear()
+{
+	stack.clear();
+	keptCols.clear();
+	origCols = 0;
+	isInfeasible = false;
+	tightenedBounds = 0;
+	fixedCols = 0;
+	aggregatedCols = 0;
+	singletonRows = 0;
+	emptyRows = 0;
+	parallelRows = 0;
+	rounds = 0;
+	time = 0.0;
+}
+
+
+MIPModelPtr Presolver::presolve(const MIPModelI& model)
+{
+	clear();
+	StopWatch watch(true);
+	int n = model.ncols();
+	int m = model.nrows();
+	origCols = n;
+	// columns
+	std::vector<char> xType(n);
+	std::vector<double> xLb(n);
+	std::vector<double> xUb(n);
+	std::vector<double> obj(n);
+	std::vector<std::string> xNames;
+	if (n)
+	{
+		model.ctypes(&xType[0]);
+		model.lbs(&xLb[0]);
+		model.ubs(&xUb[0]);
+		model.objcoefs(&obj[0]);
+		model.colNames(xNames);
+	}
+	std::vector<bool> colRemoved(n, false);
+	double objOffset = 0.0;
+	// rows
+	std::vector<ConstraintPtr> rows(m);
+	std::vector<bool> rowRemoved(m, false);
+	std::vector<std::string> rNames;
+	if (m)  model.rowNames(rNames);
+	for (int i = 0; i < m; i++)
+	{
+		rows[i] = std::make_shared<Constraint>();
+		model.row(i, rows[i]->row, rows[i]->sense, rows[i]->rhs, rows[i]->range);
+		rows[i]->name = rNames[i];
+	}
+
+	auto isInt = [&](int j) { return xType[j] != 'C'; };
+	auto infeasible = [&](const std::string& why) -> MIPModelPtr {
+		isInfeasible = true;
+		time = watch.getTotal();
+		consoleLog("presolve: infeasible ({})", why);
+		return MIPModelPtr();
+	};
+	// new bounds for j, rounded for integer variables: false if the domain becomes empty
+	auto tightenBounds = [&](int j, double l, double u) -> bool {
+		if (isInt(j))
+		{
+			l = std::ceil(l - PRESOLVE_FEASTOL);
+			u = std::floor(u + PRESOLVE_FEASTOL);
+		}
+		if (l > xLb[j] + PRESOLVE_EPS)
+		{
+			xLb[j] = l;
+			tightenedBounds++;
+		}
+		if (u < xUb[j] - PRESOLVE_EPS)
+		{
+			xUb[j] = u;
+			tightenedBounds++;
+		}
+		if (xLb[j] > xUb[j] + PRESOLVE_FEASTOL)  return false;
+		if (xLb[j] > xUb[j])  xUb[j] = xLb[j];
+		return true;
+	};
+
+	bool changed = true;
+	while (changed && (rounds < MAX_PRESOLVE_ROUNDS))
+	{
+		changed = false;
+		rounds++;
+		int before = tightenedBounds + fixedCols + aggregatedCols + singletonRows + emptyRows + parallelRows;
+
+		// root propagation (only integer bounds are kept: implied bounds on continuous variables hurt the LP)
+		DomainPtr domain = std::make_shared<Domain>();
+		for (int j = 0; j < n; j++)  domain->pushVar(xNames[j], xType[j], xLb[j], xUb[j]);
+		PropagationEngine engine;
+		engine.setDomain(domain);
+		engine.bulkThreads = propThreads;
+		std::list<std::string> fNames;
+		PropagatorFactories::getInstance().getIDs(std::back_insert_iterator< std::list<std::string> >(fNames));
+		std::map<int, PropagatorFactoryPtr> factories;
+		for (std::string name: fNames)
+		{
+			PropagatorFactoryPtr fact(PropagatorFactories::getInstance().create(name));
+			factories[fact->getPriority()] = fact;
+		}
+		LogicFactory logic;
+		std::vector<std::pair<int, int>> equalBins;
+		for (int i = 0; i < m; i++)
+		{
+			if (rowRemoved[i] || (rows[i]->sense == 'N'))  continue;
+			// binaries found equal by the logic propagators
+			PropagatorPtr eq = logic.analyze(*domain, rows[i].get());
+			if (std::dynamic_pointer_cast<EquivProp>(eq))  equalBins.push_back(std::make_pair(rows[i]->row.idx()[0], rows[i]->row.idx()[1]));
+			for (const auto& kv: factories)
+			{
+				PropagatorPtr p = kv.second->analyze(*domain, rows[i].get());
+				if (p)
+				{
+					engine.pushPropagator(p);
+					break;
+				}
+			}
+		}
+		if (!engine.fixpoint(0))  return infeasible("root propagation");
+		for (int j = 0; j < n; j++)
+		{
+			if (colRemoved[j] || !isInt(j))  continue;
+			if (!tightenBounds(j, domain->varLb(j), domain->varUb(j)))  return infeasible("root propagation");
+		}
+
+		// aggregation of equal binaries (union-find, the representative is the smallest index)
+		std::vector<int> rep(n);
+		for (int j = 0; j < n; j++)  rep[j] = j;
+		std::function<int(int)> find = [&](int j) { return (rep[j] == j) ? j : (rep[j] = find(rep[j])); };
+		bool aggregated = false;
+		for (const auto& eq: equalBins)
+		{
+			int a = find(eq.first);
+			int b = find(eq.second);
+			if (a == b || colRemoved[a] || colRemoved[b])  continue;
+			if (a > b)  std::swap(a, b);
+			rep[b] = a;
+			aggregated = true;
+		}
+		if (aggregated)
+		{
+			for (int j = 0; j < n; j++)
+			{
+				int r = find(j);
+				if (r == j)  continue;
+				if (!tightenBounds(r, xLb[j], xUb[j]))  return infeasible("aggregation");
+				obj[r] += obj[j];
+				colRemoved[j] = true;
+				stack.push_back(PostsolveStep{PostsolveStep::Type::Aggregated, j, 0.0, r});
+				aggregatedCols++;
+			}
+		}
+
+		// fixed columns
+		std::vector<double> fixedValue(n, 0.0);
+		std::vector<bool> fixedNow(n, false);
+		for (int j = 0; j < n; j++)
+		{
+			if (colRemoved[j] || !isNull(xUb[j] - xLb[j], PRESOLVE_EPS))  continue;
+			double v = isInt(j) ? std::round(xLb[j]) : xLb[j];
+			colRemoved[j] = true;
+			fixedNow[j] = true;
+			fixedValue[j] = v;
+			objOffset += obj[j] * v;
+			stack.push_back(PostsolveStep{PostsolveStep::Type::Fixed, j, v, -1});
+			fixedCols++;
+		}
+
+		// substitute aggregated and fixed columns in the rows
+		for (int i = 0; i < m; i++)
+		{
+			if (rowRemoved[i])  continue;
+			Constraint& c = *rows[i];
+			const int* idx = c.row.idx();
+			const double* coef = c.row.coef();
+			bool touched = false;
+			for (unsigned int k = 0; k < c.row.size() && !touched; k++)  touched = colRemoved[idx[k]];
+			if (!touched)  continue;
+			std::map<int, double> entries;
+			double shift = 0.0;
+			for (unsigned int k = 0; k < c.row.size(); k++)
+			{
+				int r = find(idx[k]);
+				if (fixedNow[r])  shift += coef[k] * fixedValue[r];
+				else entries[r] += coef[k];
+			}
+			c.row.clear();
+			for (const auto& e: entries)
+			{
+				if (!isNull(e.second, PRESOLVE_EPS))  c.row.push(e.first, e.second);
+			}
+			if (c.sense != 'N')  c.rhs -= shift;
+		}
+
+		// empty, free and singleton rows
+		for (int i = 0; i < m; i++)
+		{
+			if (rowRemoved[i])  continue;
+			Constraint& c = *rows[i];
+			double lo, hi;
+			rowBounds(c, lo, hi);
+			if (c.sense == 'N' || c.row.size() == 0)
+			{
+				if ((lo > PRESOLVE_FEASTOL) || (hi < -PRESOLVE_FEASTOL))  return infeasible(c.name);
+				rowRemoved[i] = true;
+				emptyRows++;
+			}
+			else if (c.row.size() == 1)
+			{
+				int j = c.row.idx()[0];
+				double a = c.row.coef()[0];
+				double l = (a > 0.0) ? lo : hi;
+				double u = (a > 0.0) ? hi : lo;
+				l = (l <= -INFBOUND || l >= INFBOUND) ? -INFBOUND : l / a;
+				u = (u <= -INFBOUND || u >= INFBOUND) ? INFBOUND : u / a;
+				if (!tightenBounds(j, std::max(l, xLb[j]), std::min(u, xUb[j])))  return infeasible(c.name);
+				rowRemoved[i] = true;
+				singletonRows++;
+			}
+		}
+
+		// duplicate and parallel rows (same support, proportional coefficients): intersect their intervals
+		std::unordered_map<std::size_t, std::vector<int>> bySupport;
+		for (int i = 0; i < m; i++)
+		{
+			if (rowRemoved[i])  continue;
+			std::vector<int> support(rows[i]->row.idx(), rows[i]->row.idx() + rows[i]->row.size());
+			std::sort(support.begin(), support.end());
+			std::size_t h = 0;
+			hash_range(h, support.begin(), support.end());
+			bySupport[h].push_back(i);
+		}
+		for (auto& kv: bySupport)
+		{
+			std::vector<int>& bucket = kv.second;
+			for (unsigned int p = 0; p < bucket.size(); p++)
+			{
+				int r = bucket[p];
+				if (rowRemoved[r])  continue;
+				double rScale;
+				std::vector<std::pair<int, double>> rNorm = normalizedRow(rows[r]->row, rScale);
+				double rLo, rHi;
+				rowBounds(*rows[r], rLo, rHi);
+				// work in the scaled space of r
+				double lo = (rScale > 0.0) ? rLo : rHi;
+				double hi = (rScale > 0.0) ? rHi : rLo;
+				lo = (std::fabs(lo) >= INFBOUND) ? -INFBOUND : lo * rScale;
+				hi = (std::fabs(hi) >= INFBOUND) ? INFBOUND : hi * rScale;
+				bool merged = false;
+				int cmp = 0;
+				for (unsigned int q = p + 1; q < bucket.size() && cmp < MAX_PARALLEL_CMP; q++)
+				{
+					int s = bucket[q];
+					if (rowRemoved[s] || (rows[s]->row.size() != rNorm.size()))  continue;
+					cmp++;
+					double sScale;
+					std::vector<std::pair<int, double>> sNorm = normalizedRow(rows[s]->row, sScale);
+					bool parallel = true;
+					for (unsigned int k = 0; k < rNorm.size() && parallel; k++)
+					{
+						parallel = (rNorm[k].first == sNorm[k].first) && isNull(rNorm[k].second - sNorm[k].second, PRESOLVE_EPS);
+					}
+					if (!parallel)  continue;
+					double sLo, sHi;
+					rowBounds(*rows[s], sLo, sHi);
+					double l = (sScale > 0.0) ? sLo : sHi;
+					double u = (sScale > 0.0) ? sHi : sLo;
+					l = (std::fabs(l) >= INFBOUND) ? -INFBOUND : l * sScale;
+					u = (std::fabs(u) >= INFBOUND) ? INFBOUND : u * sScale;
+					lo = std::max(lo, l);
+					hi = std::min(hi, u);
+					if (lo > hi + PRESOLVE_FEASTOL)  return infeasible(rows[s]->name);
+					rowRemoved[s] = true;
+					parallelRows++;
+					merged = true;
+				}
+				if (!merged)  continue;
+				// back to the scale of r
+				double newLo = (rScale > 0.0) ? lo : hi;
+				double newHi = (rScale > 0.0) ? hi : lo;
+				newLo = (std::fabs(newLo) >= INFBOUND) ? -INFBOUND : newLo / rScale;
+				newHi = (std::fabs(newHi) >= INFBOUND) ? INFBOUND : newHi / rScale;
+				if (newLo > newHi)  newLo = newHi;
+				setRowBounds(*rows[r], newLo, newHi);
+			}
+		}
+
+		int after = tightenedBounds + fixedCols + aggregatedCols + singletonRows + emptyRows + parallelRows;
+		changed = (after > before);
+	}
+
+	if (stack.empty() && !tightenedBounds && !singletonRows && !emptyRows && !parallelRows)
+	{
+		time = watch.getTotal();
+		return MIPModelPtr();
+	}
+
+	// reduced model: edit a clone of the original one (keeps the LP solver)
+	MIPModelPtr reduced(model.clone());
+	if (m)  reduced->delRows(0, m - 1);
+	// delete the removed columns, by ranges from the last one
+	for (int j = n - 1; j >= 0; )
+	{
+		if (!colRemoved[j])
+		{
+			j--;
+			continue;
+		}
+		int last = j;
+		while ((j >= 0) && colRemoved[j])  j--;
+		reduced->delCols(j + 1, last);
+	}
+	std::vector<int> newIdx(n, -1);
+	std::vector<int> cols;
+	std::vector<double> newLb;
+	std::vector<double> newUb;
+	std::vector<double> newObj;
+	for (int j = 0; j < n; j++)
+	{
+		if (colRemoved[j])  continue;
+		newIdx[j] = keptCols.size();
+		cols.push_back(keptCols.size());
+		keptCols.push_back(j);
+		newLb.push_back(xLb[j]);
+		newUb.push_back(xUb[j]);
+		newObj.push_back(obj[j]);
+	}
+	if (cols.size())
+	{
+		reduced->lbs(cols.size(), &cols[0], &newLb[0]);
+		reduced->ubs(cols.size(), &cols[0], &newUb[0]);
+		reduced->objcoefs(cols.size(), &cols[0], &newObj[0]);
+	}
+	reduced->objOffset(model.objOffset() + objOffset);
+	// rows
+	std::vector<std::string> names;
+	std::vector<int> beg;
+	std::vector<int> idx;
+	std::vector<double> val;
+	std::vector<char> senses;
+	std::vector<double> rhss;
+	std::vector<double> rngvals;
+	for (int i = 0; i < m; i++)
+	{
+		if (rowRemoved[i])  continue;
+		const Constraint& c = *rows[i];
+		names.push_back(c.name);
+		beg.push_back(idx.size());
+		for (unsigned int k = 0; k < c.row.size(); k++)
+		{
+			DOMINIQS_ASSERT( newIdx[c.row.idx()[k]] >= 0 );
+			idx.push_back(newIdx[c.row.idx()[k]]);
+			val.push_back(c.row.coef()[k]);
+		}
+		senses.push_back(c.sense);
+		rhss.push_back(c.rhs);
+		rngvals.push_back(c.range);
+	}
+	beg.push_back(idx.size());
+	if (names.size())  reduced->addRows(names.size(), names, &beg[0], idx.empty() ? nullptr : &idx[0], val.empty() ? nullptr : &val[0], &senses[0], &rhss[0], &rngvals[0]);
+	time = watch.getTotal();
+	return reduced;
+}
+
+
+std::vector<double> Presolver::postsolve(const std::vector<double>& preX) const
+{
+	DOMINIQS_ASSERT( preX.size() == keptCols.size() );
+	std::vector<double> x(origCols, 0.0);
+	for (unsigned int k = 0; k < keptCols.size(); k++)  x[keptCols[k]] = preX[k];
+	// unwind the stack (a representative may have been fixed or aggregated after its own aggregation)
+	for (auto itr = stack.rbegin(); itr != stack.rend(); ++itr)
+	{
+		if (itr->type == PostsolveStep::Type::Fixed)  x[itr->col] = itr->value;
+		else x[itr->col] = x[itr->rep];
+	}
+	return x;
+}
+
+
+void Presolver::logStats() const
+{
+	consoleInfo("[presolve]");
+	consoleLog("presolveRounds = {}", rounds);
+	consoleLog("presolveTightenedBounds = {}", tightenedBounds);
+	consoleLog("presolveFixedCols = {}", fixedCols);
+	consoleLog("presolveAggregatedCols = {}", aggregatedCols);
+	consoleLog("presolveSingletonRows = {}", singletonRows);
+	consoleLog("presolveEmptyRows = {}", emptyRows);
+	consoleLog("presolveParallelRows = {}", parallelRows);
+	consoleLog("presolveInfeasible = {}", isInfeasible);
+	consoleLog("presolveTime = {}", time);
+}
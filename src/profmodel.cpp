@@ -0,0 +1,602 @@
+/**
+ * @file profmodel.cpp
+ * @brief Profiling decorator for MIPModelI
+ */
+
+#include "feaspump/profmodel.h"
+#include <algorithm>
+
+#include <utils/timer.h>
+#include <utils/consolelog.h>
+
+using namespace dominiqs;
+
+
+/* ModelProfile */
+ModelProfile::ModelProfile() : numCalls(NUM_TRACE_OPS, 0), totTime(NUM_TRACE_OPS, 0.0) {}
+
+
+bool ModelProfile::isOptimization(TraceOp op)
+{
+	return ((op == TraceOp::LPOpt) || (op == TraceOp::MIPOpt) || (op == TraceOp::Presolve));
+}
+
+
+uint64_t ModelProfile::optCalls() const
+{
+	uint64_t cnt = 0;
+	for (int k = 1; k < NUM_TRACE_OPS; k++)
+	{
+		if (isOptimization(static_cast<TraceOp>(k)))  cnt += numCalls[k];
+	}
+	return cnt;
+}
+
+
+double ModelProfile::optTime() const
+{
+	double t = 0.0;
+	for (int k = 1; k < NUM_TRACE_OPS; k++)
+	{
+		if (isOptimization(static_cast<TraceOp>(k)))  t += totTime[k];
+	}
+	return t;
+}
+
+
+uint64_t ModelProfile::dataCalls() const
+{
+	uint64_t cnt = 0;
+	for (int k = 1; k < NUM_TRACE_OPS; k++)
+	{
+		if (!isOptimization(static_cast<TraceOp>(k)))  cnt += numCalls[k];
+	}
+	return cnt;
+}
+
+
+double ModelProfile::dataTime() const
+{
+	double t = 0.0;
+	for (int k = 1; k < NUM_TRACE_OPS; k++)
+	{
+		if (!isOptimization(static_cast<TraceOp>(k)))  t += totTime[k];
+	}
+	return t;
+}
+
+
+void ModelProfile::print() const
+{
+	std::vector<int> order;
+	for (int k = 1; k < NUM_TRACE_OPS; k++)
+	{
+		if (numCalls[k])  order.push_back(k);
+	}
+	std::sort(order.begin(), order.end(), [this](int a, int b) { return totTime[a] > totTime[b]; });
+	consoleInfo("[model interface stats]");
+	for (int k: order)
+	{
+		consoleLog("{:<20} calls = {:>10} time = {:>12.6f} avg(us) = {:>10.3f}",
+					traceOpName(static_cast<TraceOp>(k)), numCalls[k], totTime[k], 1e6 * totTime[k] / numCalls[k]);
+	}
+	consoleLog("optCalls = {}", optCalls());
+	consoleLog("optTime = {}", optTime());
+	consoleLog("dataCalls = {}", dataCalls());
+	consoleLog("dataTime = {}", dataTime());
+	consoleLog("");
+}
+
+
+void ModelProfile::clear()
+{
+	std::fill(numCalls.begin(), numCalls.end(), 0);
+	std::fill(totTime.begin(), totTime.end(), 0.0);
+}
+
+
+/**
+ * Scoped timer: charges the time elapsed between construction and destruction to op
+ */
+
+class CallTimer
+{
+public:
+	CallTimer(ModelProfile& _profile, TraceOp _op) : profile(_profile), op(_op), watch(true) {}
+	~CallTimer()
+	{
+		watch.stop();
+		profile.add(op, watch.getPartial());
+	}
+private:
+	ModelProfile& profile;
+	TraceOp op;
+	StopWatch watch;
+};
+
+
+/* ProfiledModel */
+ProfiledModel::ProfiledModel(MIPModelPtr _model, ModelProfilePtr _profile) : model(_model), profile(_profile)
+{
+	DOMINIQS_ASSERT( model && profile );
+}
+
+
+/* Read/Write */
+void ProfiledModel::readModel(const std::string& filename)
+{
+	CallTimer timer(*profile, TraceOp::ReadModel);
+	model->readModel(filename);
+}
+
+
+void ProfiledModel::writeModel(const std::string& filename, const std::string& format) const
+{
+	CallTimer timer(*profile, TraceOp::WriteModel);
+	model->writeModel(filename, format);
+}
+
+
+void ProfiledModel::writeSol(const std::string& filename) const
+{
+	CallTimer timer(*profile, TraceOp::WriteSol);
+	model->writeSol(filename);
+}
+
+
+/* Solve */
+void ProfiledModel::lpopt(char method)
+{
+	CallTimer timer(*profile, TraceOp::LPOpt);
+	model->lpopt(method);
+}
+
+
+void ProfiledModel::mipopt()
+{
+	CallTimer timer(*profile, TraceOp::MIPOpt);
+	model->mipopt();
+}
+
+
+/* Presolve/postsolve */
+void ProfiledModel::presolve()
+{
+	CallTimer timer(*profile, TraceOp::Presolve);
+	model->presolve();
+}
+
+
+void ProfiledModel::postsolve()
+{
+	CallTimer timer(*profile, TraceOp::Postsolve);
+	model->postsolve();
+}
+
+
+std::vector<double> ProfiledModel::postsolveSolution(const std::vector<double>& preX) const
+{
+	CallTimer timer(*profile, TraceOp::PostsolveSolution);
+	return model->postsolveSolution(preX);
+}
+
+
+/* Get solution */
+double ProfiledModel::objval() const
+{
+	CallTimer timer(*profile, TraceOp::ObjVal);
+	return model->objval();
+}
+
+
+void ProfiledModel::sol(double* x, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::Sol);
+	model->sol(x, first, last);
+}
+
+
+bool ProfiledModel::isPrimalFeas() const
+{
+	CallTimer timer(*profile, TraceOp::IsPrimalFeas);
+	return model->isPrimalFeas();
+}
+
+
+/* Basis */
+bool ProfiledModel::getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const
+{
+	CallTimer timer(*profile, TraceOp::GetBasis);
+	return model->getBasis(cstat, rstat);
+}
+
+
+void ProfiledModel::setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat)
+{
+	CallTimer timer(*profile, TraceOp::SetBasis);
+	model->setBasis(cstat, rstat);
+}
+
+
+/* Parameters */
+void ProfiledModel::handleCtrlC(bool flag)
+{
+	CallTimer timer(*profile, TraceOp::HandleCtrlC);
+	model->handleCtrlC(flag);
+}
+
+
+bool ProfiledModel::aborted() const
+{
+	CallTimer timer(*profile, TraceOp::Aborted);
+	return model->aborted();
+}
+
+
+void ProfiledModel::interrupt()
+{
+	// called from another thread while a solve is being timed: not profiled
+	model->interrupt();
+}
+
+
+void ProfiledModel::armInterrupt()
+{
+	// goes with interrupt(): not profiled
+	model->armInterrupt();
+}
+
+
+void ProfiledModel::seed(int seed)
+{
+	CallTimer timer(*profile, TraceOp::Seed);
+	model->seed(seed);
+}
+
+
+void ProfiledModel::logging(bool log)
+{
+	CallTimer timer(*profile, TraceOp::Logging);
+	model->logging(log);
+}
+
+
+int ProfiledModel::intParam(IntParam which) const
+{
+	CallTimer timer(*profile, TraceOp::GetIntParam);
+	return model->intParam(which);
+}
+
+
+void ProfiledModel::intParam(IntParam which, int value)
+{
+	CallTimer timer(*profile, TraceOp::SetIntParam);
+	model->intParam(which, value);
+}
+
+
+double ProfiledModel::dblParam(DblParam which) const
+{
+	CallTimer timer(*profile, TraceOp::GetDblParam);
+	return model->dblParam(which);
+}
+
+
+void ProfiledModel::dblParam(DblParam which, double value)
+{
+	CallTimer timer(*profile, TraceOp::SetDblParam);
+	model->dblParam(which, value);
+}
+
+
+int ProfiledModel::intAttr(IntAttr which) const
+{
+	CallTimer timer(*profile, TraceOp::IntAttr);
+	return model->intAttr(which);
+}
+
+
+double ProfiledModel::dblAttr(DblAttr which) const
+{
+	CallTimer timer(*profile, TraceOp::DblAttr);
+	return model->dblAttr(which);
+}
+
+
+/* Access model data */
+int ProfiledModel::nrows() const
+{
+	CallTimer timer(*profile, TraceOp::NRows);
+	return model->nrows();
+}
+
+
+int ProfiledModel::ncols() const
+{
+	CallTimer timer(*profile, TraceOp::NCols);
+	return model->ncols();
+}
+
+
+int ProfiledModel::nnz() const
+{
+	CallTimer timer(*profile, TraceOp::NNZ);
+	return model->nnz();
+}
+
+
+double ProfiledModel::objOffset() const
+{
+	CallTimer timer(*profile, TraceOp::GetObjOffset);
+	return model->objOffset();
+}
+
+
+ObjSense ProfiledModel::objSense() const
+{
+	CallTimer timer(*profile, TraceOp::GetObjSense);
+	return model->objSense();
+}
+
+
+void ProfiledModel::lbs(double* lb, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::GetLbs);
+	model->lbs(lb, first, last);
+}
+
+
+void ProfiledModel::ubs(double* ub, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::GetUbs);
+	model->ubs(ub, first, last);
+}
+
+
+void ProfiledModel::objcoefs(double* obj, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::GetObjCoefs);
+	model->objcoefs(obj, first, last);
+}
+
+
+void ProfiledModel::ctypes(char* ctype, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::GetCTypes);
+	model->ctypes(ctype, first, last);
+}
+
+
+void ProfiledModel::sense(char* sense, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::Sense);
+	model->sense(sense, first, last);
+}
+
+
+void ProfiledModel::rhs(double* rhs, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::Rhs);
+	model->rhs(rhs, first, last);
+}
+
+
+void ProfiledModel::row(int ridx, SparseVector& row, char& sense, double& rhs, double& rngval) const
+{
+	CallTimer timer(*profile, TraceOp::Row);
+	model->row(ridx, row, sense, rhs, rngval);
+}
+
+
+void ProfiledModel::rows(SparseMatrix& matrix) const
+{
+	CallTimer timer(*profile, TraceOp::Rows);
+	model->rows(matrix);
+}
+
+
+void ProfiledModel::col(int cidx, SparseVector& col, char& type, double& lb, double& ub, double& obj) const
+{
+	CallTimer timer(*profile, TraceOp::Col);
+	model->col(cidx, col, type, lb, ub, obj);
+}
+
+
+void ProfiledModel::cols(SparseMatrix& matrix) const
+{
+	CallTimer timer(*profile, TraceOp::Cols);
+	model->cols(matrix);
+}
+
+
+void ProfiledModel::colNames(std::vector<std::string>& names, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::ColNames);
+	model->colNames(names, first, last);
+}
+
+
+void ProfiledModel::rowNames(std::vector<std::string>& names, int first, int last) const
+{
+	CallTimer timer(*profile, TraceOp::RowNames);
+	model->rowNames(names, first, last);
+}
+
+
+/* Data modifications */
+void ProfiledModel::addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj)
+{
+	CallTimer timer(*profile, TraceOp::AddEmptyCol);
+	model->addEmptyCol(name, ctype, lb, ub, obj);
+}
+
+
+void ProfiledModel::addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj)
+{
+	CallTimer timer(*profile, TraceOp::AddCol);
+	model->addCol(name, idx, val, cnt, ctype, lb, ub, obj);
+}
+
+
+void ProfiledModel::addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval)
+{
+	CallTimer timer(*profile, TraceOp::AddRow);
+	model->addRow(name, idx, val, cnt, sense, rhs, rngval);
+}
+
+
+void ProfiledModel::addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs)
+{
+	CallTimer timer(*profile, TraceOp::AddEmptyCols);
+	model->addEmptyCols(cnt, names, ctypes, lbs, ubs, objs);
+}
+
+
+void ProfiledModel::addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals)
+{
+	CallTimer timer(*profile, TraceOp::AddRows);
+	model->addRows(cnt, names, beg, idx, val, senses, rhss, rngvals);
+}
+
+
+void ProfiledModel::delRow(int ridx)
+{
+	CallTimer timer(*profile, TraceOp::DelRow);
+	model->delRow(ridx);
+}
+
+
+void ProfiledModel::delCol(int cidx)
+{
+	CallTimer timer(*profile, TraceOp::DelCol);
+	model->delCol(cidx);
+}
+
+
+void ProfiledModel::delRows(int first, int last)
+{
+	CallTimer timer(*profile, TraceOp::DelRows);
+	model->delRows(first, last);
+}
+
+
+void ProfiledModel::delCols(int first, int last)
+{
+	CallTimer timer(*profile, TraceOp::DelCols);
+	model->delCols(first, last);
+}
+
+
+void ProfiledModel::delRowSet(int cnt, const int* rows)
+{
+	CallTimer timer(*profile, TraceOp::DelRowSet);
+	model->delRowSet(cnt, rows);
+}
+
+
+void ProfiledModel::objSense(ObjSense objsen)
+{
+	CallTimer timer(*profile, TraceOp::SetObjSense);
+	model->objSense(objsen);
+}
+
+
+void ProfiledModel::objOffset(double val)
+{
+	CallTimer timer(*profile, TraceOp::SetObjOffset);
+	model->objOffset(val);
+}
+
+
+void ProfiledModel::lb(int cidx, double val)
+{
+	CallTimer timer(*profile, TraceOp::SetLb);
+	model->lb(cidx, val);
+}
+
+
+void ProfiledModel::lbs(int cnt, const int* cols, const double* values)
+{
+	CallTimer timer(*profile, TraceOp::SetLbs);
+	model->lbs(cnt, cols, values);
+}
+
+
+void ProfiledModel::ub(int cidx, double val)
+{
+	CallTimer timer(*profile, TraceOp::SetUb);
+	model->ub(cidx, val);
+}
+
+
+void ProfiledModel::ubs(int cnt, const int* cols, const double* values)
+{
+	CallTimer timer(*profile, TraceOp::SetUbs);
+	model->ubs(cnt, cols, values);
+}
+
+
+void ProfiledModel::fixCol(int cidx, double val)
+{
+	CallTimer timer(*profile, TraceOp::FixCol);
+	model->fixCol(cidx, val);
+}
+
+
+void ProfiledModel::objcoef(int cidx, double val)
+{
+	CallTimer timer(*profile, TraceOp::SetObjCoef);
+	model->objcoef(cidx, val);
+}
+
+
+void ProfiledModel::objcoefs(int cnt, const int* cols, const double* values)
+{
+	CallTimer timer(*profile, TraceOp::SetObjCoefs);
+	model->objcoefs(cnt, cols, values);
+}
+
+
+void ProfiledModel::rhs(int cnt, const int* rows, const double* values)
+{
+	CallTimer timer(*profile, TraceOp::SetRhs);
+	model->rhs(cnt, rows, values);
+}
+
+
+void ProfiledModel::ctype(int cidx, char val)
+{
+	CallTimer timer(*profile, TraceOp::SetCType);
+	model->ctype(cidx, val);
+}
+
+
+void ProfiledModel::ctypes(int cnt, const int* cols, const char* values)
+{
+	CallTimer timer(*profile, TraceOp::SetCTypes);
+	model->ctypes(cnt, cols, values);
+}
+
+
+void ProfiledModel::switchToLP()
+{
+	CallTimer timer(*profile, TraceOp::SwitchToLP);
+	model->switchToLP();
+}
+
+
+/* Private interface */
+ProfiledModel* ProfiledModel::clone_impl() const
+{
+	CallTimer timer(*profile, TraceOp::Clone);
+	return new ProfiledModel(MIPModelPtr(model->clone()), profile);
+}
+
+
+ProfiledModel* ProfiledModel::presolvedmodel_impl()
+{
+	CallTimer timer(*profile, TraceOp::PresolvedModel);
+	MIPModelPtr premodel(model->presolvedModel());
+	if (!premodel)  return nullptr;
+	return new ProfiledModel(premodel, profile);
+}
@@ -0,0 +1,162 @@
+/**
+ * @file prop_bench.cpp
+ * @brief Propagation engine microbenchmark on synthetic models (no LP solver needed)
+ */
+
+#include <iostream>
+#include <cmath>
+
+#include <utils/args_parser.h>
+#include <utils/fileconfig.h>
+#include <utils/str_utils.h>
+#include <utils/timer.h>
+#include <utils/randgen.h>
+#include <utils/consolelog.h>
+
+#include "feaspump/transformers.h"
+#include "feaspump/instgen.h"
+#include "feaspump/version.h"
+#include <fmt/format.h>
+
+
+// macro type savers
+#define LOG_ITEM(name, value) consoleLog("{} = {}", name, value)
+
+using namespace dominiqs;
+
+static const uint64_t DEF_SEED = 0;
+
+
+/**
+ * PropagatorRounding with access to the engine internals needed by the benchmark
+ */
+
+class BenchRounding : public PropagatorRounding
+{
+public:
+	const PropagationStats& stats() const { return prop.getStats(); }
+	void resetStats() { prop.resetStats(); }
+	void restoreState() { state->restore(); }
+	int numIntegers() const { return integers.size(); }
+};
+
+
+/**
+ * Generate a random point within the bounds of the model:
+ * each integer variable is fractional with probability fracRatio, integral otherwise
+ */
+static void randomPoint(const std::vector<double>& xLb, const std::vector<double>& xUb, const std::vector<char>& xType,
+						double fracRatio, RandGen& gen, std::vector<double>& x)
+{
+	int n = xType.size();
+	x.resize(n);
+	for (int j = 0; j < n; j++)
+	{
+		double v = xLb[j] + gen.getFloat() * (xUb[j] - xLb[j]);
+		if ((xType[j] != 'C') && (gen.getFloat() >= fracRatio))  v = std::min(floor(v + 0.5), xUb[j]);
+		x[j] = v;
+	}
+}
+
+
+int main (int argc, char const *argv[])
+{
+	// config/options
+	ArgsParser args;
+	args.parse(argc, argv);
+	mergeConfig(args, gConfig());
+	std::string families = gConfig().get("bench.families", std::string("setcover,knapsack,varbound,mixedint"));
+	InstGenParams params;
+	params.nrows = gConfig().get("bench.nrows", params.nrows);
+	params.ncols = gConfig().get("bench.ncols", params.ncols);
+	params.rowNnz = gConfig().get("bench.rowNnz", params.rowNnz);
+	int dives = gConfig().get("bench.dives", 1000);
+	int numPoints = gConfig().get("bench.points", 100);
+	double fracRatio = gConfig().get("bench.fracRatio", 0.2);
+	bool ignoreGeneralInt = gConfig().get("bench.ignoreGeneralInt", false);
+	uint64_t seed = gConfig().get<uint64_t>("seed", DEF_SEED);
+	params.seed = seed;
+	// logger
+	consoleInfo("Timestamp: {}", currentDateTime());
+	consoleInfo("[config]");
+	LOG_ITEM("bench.families", families);
+	LOG_ITEM("bench.nrows", params.nrows);
+	LOG_ITEM("bench.ncols", params.ncols);
+	LOG_ITEM("bench.rowNnz", params.rowNnz);
+	LOG_ITEM("bench.dives", dives);
+	LOG_ITEM("bench.points", numPoints);
+	LOG_ITEM("bench.fracRatio", fracRatio);
+	LOG_ITEM("bench.ignoreGeneralInt", ignoreGeneralInt);
+	LOG_ITEM("gitHash", FP_GIT_HASH);
+	LOG_ITEM("fpVersion", FP_VERSION);
+	LOG_ITEM("seed", seed);
+	gConfig().set<uint64_t>("seed", generateSeed(seed));
+
+	try
+	{
+		for (const std::string& family: split<std::string>(families, ","))
+		{
+			std::shared_ptr<MemModel> model = generateInstance(family, params);
+			consoleInfo("[{}]", family);
+			consoleLog("problem: #rows={} #cols={} #nnz={}", model->nrows(), model->ncols(), model->nnz());
+
+			// setup rounder
+			StopWatch initWatch(true);
+			BenchRounding rounder;
+			rounder.readConfig();
+			rounder.init(model, ignoreGeneralInt);
+			initWatch.stop();
+
+			// random fractional points (generated upfront so that they do not pollute timings)
+			int n = model->ncols();
+			std::vector<double> xLb(n);
+			std::vector<double> xUb(n);
+			std::vector<char> xType(n);
+			model->lbs(&xLb[0]);
+			model->ubs(&xUb[0]);
+			model->ctypes(&xType[0]);
+			RandGen gen(seed);
+			gen.warmUp();
+			std::vector< std::vector<double> > points(std::max(1, numPoints));
+			for (std::vector<double>& x: points)  randomPoint(xLb, xUb, xType, fracRatio, gen, x);
+			std::vector<double> out(n);
+
+			// dives
+			rounder.resetStats();
+			StopWatch diveWatch(true);
+			for (int d = 0; d < dives; d++)  rounder.apply(points[d % points.size()], out);
+			diveWatch.stop();
+			PropagationStats stats = rounder.stats();
+
+			// restore cost (restore after a full dive, as done at the beginning of apply)
+			StopWatch restoreWatch;
+			for (int d = 0; d < dives; d++)
+			{
+				rounder.apply(points[d % points.size()], out);
+				restoreWatch.start();
+				rounder.restoreState();
+				restoreWatch.stop();
+			}
+			double restoreTime = restoreWatch.getTotal();
+
+			double diveTime = std::max(diveWatch.getTotal(), 1e-9);
+			consoleInfo("[results]");
+			LOG_ITEM("integers", rounder.numIntegers());
+			LOG_ITEM("initTime", initWatch.getTotal());
+			LOG_ITEM("diveTime", diveTime);
+			LOG_ITEM("dives/sec", dives / diveTime);
+			LOG_ITEM("decisions/dive", (double)stats.decisions / std::max(dives, 1));
+			LOG_ITEM("decisions/sec", stats.decisions / diveTime);
+			LOG_ITEM("propagatorCalls/sec", stats.propagatorCalls / diveTime);
+			LOG_ITEM("advisorEvents/sec", stats.advisorEvents / diveTime);
+			LOG_ITEM("restoreTime/restore(us)", 1e6 * restoreTime / std::max(dives, 1));
+			consoleLog("");
+		}
+	}
+	catch(std::exception& e)
+	{
+		consoleError(e.what());
+		return -1;
+	}
+	return 0;
+}
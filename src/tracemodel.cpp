@@ -0,0 +1,898 @@
+/**
+ * @file tracemodel.cpp
+ * @brief Recording/replaying decorator for MIPModelI
+ */
+
+#include "feaspump/tracemodel.h"
+#include <fstream>
+#include <stdexcept>
+
+#include <utils/compress.h>
+#include <utils/str_utils.h>
+#include <fmt/format.h>
+
+using namespace dominiqs;
+
+static const char TRACE_MAGIC[8] = {'F', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+
+static const char* TRACE_OP_NAMES[NUM_TRACE_OPS] = {
+	"unknown",
+	"readModel",
+	"writeModel",
+	"writeSol",
+	"lpopt",
+	"mipopt",
+	"presolve",
+	"postsolve",
+	"presolvedModel",
+	"postsolveSolution",
+	"objval",
+	"sol",
+	"isPrimalFeas",
+	"handleCtrlC",
+	"aborted",
+	"seed",
+	"logging",
+	"intParam(get)",
+	"intParam(set)",
+	"dblParam(get)",
+	"dblParam(set)",
+	"intAttr",
+	"dblAttr",
+	"nrows",
+	"ncols",
+	"nnz",
+	"objOffset(get)",
+	"objSense(get)",
+	"lbs(get)",
+	"ubs(get)",
+	"objcoefs(get)",
+	"ctypes(get)",
+	"sense",
+	"rhs",
+	"row",
+	"rows",
+	"col",
+	"cols",
+	"colNames",
+	"rowNames",
+	"addEmptyCol",
+	"addCol",
+	"addRow",
+	"addEmptyCols",
+	"addRows",
+	"delRow",
+	"delCol",
+	"delRows",
+	"delCols",
+	"objSense(set)",
+	"objOffset(set)",
+	"lb",
+	"lbs(set)",
+	"ub",
+	"ubs(set)",
+	"fixCol",
+	"objcoef",
+	"objcoefs(set)",
+	"ctype",
+	"ctypes(set)",
+	"switchToLP",
+	"clone",
+	"getBasis",
+	"setBasis",
+	"rhs(set)",
+	"delRowSet"
+};
+
+
+const char* traceOpName(TraceOp op)
+{
+	int code = static_cast<int>(op);
+	if ((code <= 0) || (code >= NUM_TRACE_OPS))  return TRACE_OP_NAMES[0];
+	return TRACE_OP_NAMES[code];
+}
+
+
+/* Trace */
+Trace::Trace(const std::string& _filename, Mode mode) : traceMode(mode), filename(_filename)
+{
+	bool compressed = ends_with(filename, ".gz");
+	if (recording())
+	{
+		if (compressed)  out = new ogzstream(filename.c_str());
+		else  out = new std::ofstream(filename.c_str(), std::ios::binary);
+		if (!(*out))  throw std::runtime_error(fmt::format("Cannot open trace file {}", filename));
+		write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	}
+	else
+	{
+		if (compressed)  in = new igzstream(filename.c_str());
+		else  in = new std::ifstream(filename.c_str(), std::ios::binary);
+		if (!(*in))  throw std::runtime_error(fmt::format("Cannot open trace file {}", filename));
+		char magic[sizeof(TRACE_MAGIC)];
+		read(magic, sizeof(magic));
+		if (!std::equal(magic, magic + sizeof(magic), TRACE_MAGIC))
+		{
+			throw std::runtime_error(fmt::format("{} is not a valid trace file", filename));
+		}
+	}
+}
+
+
+Trace::~Trace()
+{
+	if (out)  out->flush();
+	delete out;
+	delete in;
+}
+
+
+void Trace::begin(TraceOp op, int modelId)
+{
+	uint8_t code = static_cast<uint8_t>(op);
+	if (recording())
+	{
+		io(code);
+		io(modelId);
+	}
+	else
+	{
+		uint8_t otherCode;
+		int otherId;
+		io(otherCode);
+		io(otherId);
+		if ((otherCode != code) || (otherId != modelId))
+		{
+			throw std::runtime_error(fmt::format("Trace mismatch at record {}: expected {} on model {}, found {} on model {}",
+									numRecords, traceOpName(op), modelId, traceOpName(static_cast<TraceOp>(otherCode)), otherId));
+		}
+	}
+	numRecords++;
+}
+
+
+void Trace::io(std::string& s)
+{
+	int n = s.size();
+	io(n);
+	s.resize(n);
+	if (n)  ioArray(&s[0], n);
+}
+
+
+void Trace::io(std::vector<std::string>& v)
+{
+	int n = v.size();
+	io(n);
+	v.resize(n);
+	for (std::string& s: v)  io(s);
+}
+
+
+void Trace::io(SparseVector& v)
+{
+	int n = v.size();
+	io(n);
+	if (!recording())  v.resize(n);
+	ioArray(v.idx(), n);
+	ioArray(v.coef(), n);
+}
+
+
+void Trace::io(SparseMatrix& m)
+{
+	io(m.k);
+	io(m.nnz);
+	ioVector(m.matbeg);
+	ioVector(m.matind);
+	ioVector(m.matval);
+}
+
+
+void Trace::ioOutcome(const std::exception* e)
+{
+	std::string msg;
+	uint8_t failed = 0;
+	if (recording() && e)
+	{
+		failed = 1;
+		msg = e->what();
+	}
+	io(failed);
+	if (failed)
+	{
+		io(msg);
+		if (!recording())  throw std::runtime_error(msg);
+	}
+}
+
+
+void Trace::write(const void* data, size_t size)
+{
+	DOMINIQS_ASSERT( out );
+	out->write(static_cast<const char*>(data), size);
+}
+
+
+void Trace::read(void* data, size_t size)
+{
+	DOMINIQS_ASSERT( in );
+	in->read(static_cast<char*>(data), size);
+	if (!(*in))  throw std::runtime_error(fmt::format("Unexpected end of trace file {} at record {}", filename, numRecords));
+}
+
+
+void Trace::mismatch(const std::string& what)
+{
+	throw std::runtime_error(fmt::format("Trace mismatch at record {}: different {}", numRecords, what));
+}
+
+
+/* TraceModel */
+TraceModel::TraceModel(MIPModelPtr _model, TracePtr _trace) : model(_model), trace(_trace)
+{
+	DOMINIQS_ASSERT( model && trace );
+	if (!recording())  throw std::runtime_error("TraceModel: wrapping a model requires a trace in record mode");
+	id = trace->newModelId();
+}
+
+
+TraceModel::TraceModel(TracePtr _trace) : trace(_trace)
+{
+	DOMINIQS_ASSERT( trace );
+	if (recording())  throw std::runtime_error("TraceModel: recording requires a model to wrap");
+	id = trace->newModelId();
+}
+
+
+int TraceModel::rangeSize(int first, int last, bool onRows) const
+{
+	int n = 0;
+	if (recording())
+	{
+		if (last == -1)  last = (onRows ? model->nrows() : model->ncols()) - 1;
+		n = last - first + 1;
+	}
+	trace->io(n);
+	return n;
+}
+
+
+/* Read/Write */
+void TraceModel::readModel(const std::string& filename)
+{
+	begin(TraceOp::ReadModel);
+	if (recording())
+	{
+		try { model->readModel(filename); }
+		catch (std::exception& e) { trace->ioOutcome(&e); throw; }
+	}
+	trace->ioOutcome(nullptr);
+}
+
+
+void TraceModel::writeModel(const std::string& filename, const std::string& format) const
+{
+	begin(TraceOp::WriteModel);
+	if (recording())  model->writeModel(filename, format);
+}
+
+
+void TraceModel::writeSol(const std::string& filename) const
+{
+	begin(TraceOp::WriteSol);
+	if (recording())  model->writeSol(filename);
+}
+
+
+/* Solve */
+void TraceModel::lpopt(char method)
+{
+	begin(TraceOp::LPOpt);
+	trace->check(method);
+	if (recording())
+	{
+		try { model->lpopt(method); }
+		catch (std::exception& e) { trace->ioOutcome(&e); throw; }
+	}
+	trace->ioOutcome(nullptr);
+}
+
+
+void TraceModel::mipopt()
+{
+	begin(TraceOp::MIPOpt);
+	if (recording())
+	{
+		try { model->mipopt(); }
+		catch (std::exception& e) { trace->ioOutcome(&e); throw; }
+	}
+	trace->ioOutcome(nullptr);
+}
+
+
+/* Presolve/postsolve */
+void TraceModel::presolve()
+{
+	begin(TraceOp::Presolve);
+	if (recording())
+	{
+		try { model->presolve(); }
+		catch (std::exception& e) { trace->ioOutcome(&e); throw; }
+	}
+	trace->ioOutcome(nullptr);
+}
+
+
+void TraceModel::postsolve()
+{
+	begin(TraceOp::Postsolve);
+	if (recording())  model->postsolve();
+}
+
+
+std::vector<double> TraceModel::postsolveSolution(const std::vector<double>& preX) const
+{
+	begin(TraceOp::PostsolveSolution);
+	std::vector<double> x;
+	if (recording())  x = model->postsolveSolution(preX);
+	trace->ioVector(x);
+	return x;
+}
+
+
+/* Get solution */
+double TraceModel::objval() const
+{
+	begin(TraceOp::ObjVal);
+	double res = recording() ? model->objval() : 0.0;
+	trace->io(res);
+	return res;
+}
+
+
+void TraceModel::sol(double* x, int first, int last) const
+{
+	begin(TraceOp::Sol);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, false);
+	if (recording())  model->sol(x, first, last);
+	trace->ioArray(x, n);
+}
+
+
+bool TraceModel::isPrimalFeas() const
+{
+	begin(TraceOp::IsPrimalFeas);
+	bool res = recording() ? model->isPrimalFeas() : false;
+	trace->io(res);
+	return res;
+}
+
+
+/* Basis */
+bool TraceModel::getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const
+{
+	begin(TraceOp::GetBasis);
+	bool res = recording() ? model->getBasis(cstat, rstat) : false;
+	trace->io(res);
+	if (res)
+	{
+		trace->ioVector(cstat);
+		trace->ioVector(rstat);
+	}
+	return res;
+}
+
+
+void TraceModel::setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat)
+{
+	begin(TraceOp::SetBasis);
+	trace->check((int)cstat.size());
+	trace->check((int)rstat.size());
+	if (recording())  model->setBasis(cstat, rstat);
+}
+
+
+/* Parameters */
+void TraceModel::handleCtrlC(bool flag)
+{
+	begin(TraceOp::HandleCtrlC);
+	trace->check(flag);
+	if (recording())  model->handleCtrlC(flag);
+}
+
+
+bool TraceModel::aborted() const
+{
+	begin(TraceOp::Aborted);
+	bool res = recording() ? model->aborted() : false;
+	trace->io(res);
+	return res;
+}
+
+
+void TraceModel::interrupt()
+{
+	// asynchronous by nature (and called from another thread): not traced
+	if (recording())  model->interrupt();
+}
+
+
+void TraceModel::armInterrupt()
+{
+	// goes with interrupt(): not traced
+	if (recording())  model->armInterrupt();
+}
+
+
+void TraceModel::seed(int seed)
+{
+	begin(TraceOp::Seed);
+	trace->check(seed);
+	if (recording())  model->seed(seed);
+}
+
+
+void TraceModel::logging(bool log)
+{
+	begin(TraceOp::Logging);
+	trace->check(log);
+	if (recording())  model->logging(log);
+}
+
+
+int TraceModel::intParam(IntParam which) const
+{
+	begin(TraceOp::GetIntParam);
+	trace->check(which);
+	int res = recording() ? model->intParam(which) : 0;
+	trace->io(res);
+	return res;
+}
+
+
+void TraceModel::intParam(IntParam which, int value)
+{
+	begin(TraceOp::SetIntParam);
+	trace->check(which);
+	trace->check(value);
+	if (recording())  model->intParam(which, value);
+}
+
+
+double TraceModel::dblParam(DblParam which) const
+{
+	begin(TraceOp::GetDblParam);
+	trace->check(which);
+	double res = recording() ? model->dblParam(which) : 0.0;
+	trace->io(res);
+	return res;
+}
+
+
+void TraceModel::dblParam(DblParam which, double value)
+{
+	begin(TraceOp::SetDblParam);
+	trace->check(which);
+	trace->check(value);
+	if (recording())  model->dblParam(which, value);
+}
+
+
+int TraceModel::intAttr(IntAttr which) const
+{
+	begin(TraceOp::IntAttr);
+	trace->check(which);
+	int res = recording() ? model->intAttr(which) : 0;
+	trace->io(res);
+	return res;
+}
+
+
+double TraceModel::dblAttr(DblAttr which) const
+{
+	begin(TraceOp::DblAttr);
+	trace->check(which);
+	double res = recording() ? model->dblAttr(which) : 0.0;
+	trace->io(res);
+	return res;
+}
+
+
+/* Access model data */
+int TraceModel::nrows() const
+{
+	begin(TraceOp::NRows);
+	int res = recording() ? model->nrows() : 0;
+	trace->io(res);
+	return res;
+}
+
+
+int TraceModel::ncols() const
+{
+	begin(TraceOp::NCols);
+	int res = recording() ? model->ncols() : 0;
+	trace->io(res);
+	return res;
+}
+
+
+int TraceModel::nnz() const
+{
+	begin(TraceOp::NNZ);
+	int res = recording() ? model->nnz() : 0;
+	trace->io(res);
+	return res;
+}
+
+
+double TraceModel::objOffset() const
+{
+	begin(TraceOp::GetObjOffset);
+	double res = recording() ? model->objOffset() : 0.0;
+	trace->io(res);
+	return res;
+}
+
+
+ObjSense TraceModel::objSense() const
+{
+	begin(TraceOp::GetObjSense);
+	ObjSense res = recording() ? model->objSense() : ObjSense::MIN;
+	trace->io(res);
+	return res;
+}
+
+
+void TraceModel::lbs(double* lb, int first, int last) const
+{
+	begin(TraceOp::GetLbs);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, false);
+	if (recording())  model->lbs(lb, first, last);
+	trace->ioArray(lb, n);
+}
+
+
+void TraceModel::ubs(double* ub, int first, int last) const
+{
+	begin(TraceOp::GetUbs);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, false);
+	if (recording())  model->ubs(ub, first, last);
+	trace->ioArray(ub, n);
+}
+
+
+void TraceModel::objcoefs(double* obj, int first, int last) const
+{
+	begin(TraceOp::GetObjCoefs);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, false);
+	if (recording())  model->objcoefs(obj, first, last);
+	trace->ioArray(obj, n);
+}
+
+
+void TraceModel::ctypes(char* ctype, int first, int last) const
+{
+	begin(TraceOp::GetCTypes);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, false);
+	if (recording())  model->ctypes(ctype, first, last);
+	trace->ioArray(ctype, n);
+}
+
+
+void TraceModel::sense(char* sense, int first, int last) const
+{
+	begin(TraceOp::Sense);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, true);
+	if (recording())  model->sense(sense, first, last);
+	trace->ioArray(sense, n);
+}
+
+
+void TraceModel::rhs(double* rhs, int first, int last) const
+{
+	begin(TraceOp::Rhs);
+	trace->check(first);
+	trace->check(last);
+	int n = rangeSize(first, last, true);
+	if (recording())  model->rhs(rhs, first, last);
+	trace->ioArray(rhs, n);
+}
+
+
+void TraceModel::row(int ridx, SparseVector& row, char& sense, double& rhs, double& rngval) const
+{
+	begin(TraceOp::Row);
+	trace->check(ridx);
+	if (recording())  model->row(ridx, row, sense, rhs, rngval);
+	trace->io(row);
+	trace->io(sense);
+	trace->io(rhs);
+	trace->io(rngval);
+}
+
+
+void TraceModel::rows(SparseMatrix& matrix) const
+{
+	begin(TraceOp::Rows);
+	if (recording())  model->rows(matrix);
+	trace->io(matrix);
+}
+
+
+void TraceModel::col(int cidx, SparseVector& col, char& type, double& lb, double& ub, double& obj) const
+{
+	begin(TraceOp::Col);
+	trace->check(cidx);
+	if (recording())  model->col(cidx, col, type, lb, ub, obj);
+	trace->io(col);
+	trace->io(type);
+	trace->io(lb);
+	trace->io(ub);
+	trace->io(obj);
+}
+
+
+void TraceModel::cols(SparseMatrix& matrix) const
+{
+	begin(TraceOp::Cols);
+	if (recording())  model->cols(matrix);
+	trace->io(matrix);
+}
+
+
+void TraceModel::colNames(std::vector<std::string>& names, int first, int last) const
+{
+	begin(TraceOp::ColNames);
+	trace->check(first);
+	trace->check(last);
+	if (recording())  model->colNames(names, first, last);
+	trace->io(names);
+}
+
+
+void TraceModel::rowNames(std::vector<std::string>& names, int first, int last) const
+{
+	begin(TraceOp::RowNames);
+	trace->check(first);
+	trace->check(last);
+	if (recording())  model->rowNames(names, first, last);
+	trace->io(names);
+}
+
+
+/* Data modifications */
+void TraceModel::addEmptyCol(const std::string& name, char ctype, double lb, double ub, double obj)
+{
+	begin(TraceOp::AddEmptyCol);
+	trace->check(ctype);
+	trace->check(lb);
+	trace->check(ub);
+	trace->check(obj);
+	if (recording())  model->addEmptyCol(name, ctype, lb, ub, obj);
+}
+
+
+void TraceModel::addCol(const std::string& name, const int* idx, const double* val, int cnt, char ctype, double lb, double ub, double obj)
+{
+	begin(TraceOp::AddCol);
+	trace->check(cnt);
+	trace->check(ctype);
+	trace->check(lb);
+	trace->check(ub);
+	trace->check(obj);
+	if (recording())  model->addCol(name, idx, val, cnt, ctype, lb, ub, obj);
+}
+
+
+void TraceModel::addRow(const std::string& name, const int* idx, const double* val, int cnt, char sense, double rhs, double rngval)
+{
+	begin(TraceOp::AddRow);
+	trace->check(cnt);
+	trace->check(sense);
+	trace->check(rhs);
+	trace->check(rngval);
+	if (recording())  model->addRow(name, idx, val, cnt, sense, rhs, rngval);
+}
+
+
+void TraceModel::addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs)
+{
+	begin(TraceOp::AddEmptyCols);
+	trace->check(cnt);
+	if (recording())  model->addEmptyCols(cnt, names, ctypes, lbs, ubs, objs);
+}
+
+
+void TraceModel::addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals)
+{
+	begin(TraceOp::AddRows);
+	trace->check(cnt);
+	if (cnt > 0)  trace->check(beg[cnt]);
+	if (recording())  model->addRows(cnt, names, beg, idx, val, senses, rhss, rngvals);
+}
+
+
+void TraceModel::delRow(int ridx)
+{
+	begin(TraceOp::DelRow);
+	trace->check(ridx);
+	if (recording())  model->delRow(ridx);
+}
+
+
+void TraceModel::delCol(int cidx)
+{
+	begin(TraceOp::DelCol);
+	trace->check(cidx);
+	if (recording())  model->delCol(cidx);
+}
+
+
+void TraceModel::delRows(int first, int last)
+{
+	begin(TraceOp::DelRows);
+	trace->check(first);
+	trace->check(last);
+	if (recording())  model->delRows(first, last);
+}
+
+
+void TraceModel::delCols(int first, int last)
+{
+	begin(TraceOp::DelCols);
+	trace->check(first);
+	trace->check(last);
+	if (recording())  model->delCols(first, last);
+}
+
+
+void TraceModel::delRowSet(int cnt, const int* rows)
+{
+	begin(TraceOp::DelRowSet);
+	trace->check(cnt);
+	if (recording())  model->delRowSet(cnt, rows);
+}
+
+
+void TraceModel::objSense(ObjSense objsen)
+{
+	begin(TraceOp::SetObjSense);
+	trace->check(objsen);
+	if (recording())  model->objSense(objsen);
+}
+
+
+void TraceModel::objOffset(double val)
+{
+	begin(TraceOp::SetObjOffset);
+	trace->check(val);
+	if (recording())  model->objOffset(val);
+}
+
+
+void TraceModel::lb(int cidx, double val)
+{
+	begin(TraceOp::SetLb);
+	trace->check(cidx);
+	trace->check(val);
+	if (recording())  model->lb(cidx, val);
+}
+
+
+void TraceModel::lbs(int cnt, const int* cols, const double* values)
+{
+	begin(TraceOp::SetLbs);
+	trace->check(cnt);
+	if (recording())  model->lbs(cnt, cols, values);
+}
+
+
+void TraceModel::ub(int cidx, double val)
+{
+	begin(TraceOp::SetUb);
+	trace->check(cidx);
+	trace->check(val);
+	if (recording())  model->ub(cidx, val);
+}
+
+
+void TraceModel::ubs(int cnt, const int* cols, const double* values)
+{
+	begin(TraceOp::SetUbs);
+	trace->check(cnt);
+	if (recording())  model->ubs(cnt, cols, values);
+}
+
+
+void TraceModel::fixCol(int cidx, double val)
+{
+	begin(TraceOp::FixCol);
+	trace->check(cidx);
+	trace->check(val);
+	if (recording())  model->fixCol(cidx, val);
+}
+
+
+void TraceModel::objcoef(int cidx, double val)
+{
+	begin(TraceOp::SetObjCoef);
+	trace->check(cidx);
+	trace->check(val);
+	if (recording())  model->objcoef(cidx, val);
+}
+
+
+void TraceModel::objcoefs(int cnt, const int* cols, const double* values)
+{
+	begin(TraceOp::SetObjCoefs);
+	trace->check(cnt);
+	if (recording())  model->objcoefs(cnt, cols, values);
+}
+
+
+void TraceModel::rhs(int cnt, const int* rows, const double* values)
+{
+	begin(TraceOp::SetRhs);
+	trace->check(cnt);
+	if (recording())  model->rhs(cnt, rows, values);
+}
+
+
+void TraceModel::ctype(int cidx, char val)
+{
+	begin(TraceOp::SetCType);
+	trace->check(cidx);
+	trace->check(val);
+	if (recording())  model->ctype(cidx, val);
+}
+
+
+void TraceModel::ctypes(int cnt, const int* cols, const char* values)
+{
+	begin(TraceOp::SetCTypes);
+	trace->check(cnt);
+	if (recording())  model->ctypes(cnt, cols, values);
+}
+
+
+void TraceModel::switchToLP()
+{
+	begin(TraceOp::SwitchToLP);
+	if (recording())  model->switchToLP();
+}
+
+
+/* Private interface */
+TraceModel* TraceModel::clone_impl() const
+{
+	begin(TraceOp::Clone);
+	if (recording())  return new TraceModel(MIPModelPtr(model->clone()), trace);
+	return new TraceModel(trace);
+}
+
+
+TraceModel* TraceModel::presolvedmodel_impl()
+{
+	begin(TraceOp::PresolvedModel);
+	MIPModelPtr premodel;
+	if (recording())  premodel = MIPModelPtr(model->presolvedModel());
+	bool hasPresolved = (premodel != nullptr);
+	trace->io(hasPresolved);
+	if (!hasPresolved)  return nullptr;
+	if (recording())  return new TraceModel(premodel, trace);
+	return new TraceModel(trace);
+}
@@ -18,6 +18,7 @@
 #include <utils/floats.h>
 #include <utils/fileconfig.h>
 #include <utils/consolelog.h>
+#include <utils/timer.h>
 
 #include "feaspump/transformers.h"
 
@@ -35,7 +36,7 @@ static bool DEF_RANDOMIZED_ROUNDING = true;
 static bool DEF_LOG_DETAILS = false;
 static uint64_t DEF_SEED = 0;
 
-SimpleRounding::SimpleRounding() : randomizedRounding(DEF_RANDOMIZED_ROUNDING), logDetails(DEF_LOG_DETAILS)
+SimpleRounding::SimpleRounding() : ignoreGInt(true), randomizedRounding(DEF_RANDOMIZED_ROUNDING), logDetails(DEF_LOG_DETAILS), verbose(true)
 {
 }
 
@@ -43,9 +44,12 @@ void SimpleRounding::readConfig()
 {
 	READ_FROM_CONFIG( randomizedRounding, DEF_RANDOMIZED_ROUNDING );
 	READ_FROM_CONFIG( logDetails, DEF_LOG_DETAILS );
-	consoleInfo("[config rounder]");
-	LOG_CONFIG( randomizedRounding );
-	LOG_CONFIG( logDetails );
+	if (verbose)
+	{
+		consoleInfo("[config rounder]");
+		LOG_CONFIG( randomizedRounding );
+		LOG_CONFIG( logDetails );
+	}
 	uint64_t seed = gConfig().get<uint64_t>("seed", DEF_SEED);
 	roundGen.setSeed(seed);
 	roundGen.warmUp();
@@ -53,16 +57,49 @@ void SimpleRounding::readConfig()
 
 void SimpleRounding::init(MIPModelPtr model, bool ignoreGeneralInt)
 {
-	binaries.clear();
-	gintegers.clear();
-	integers.clear();
 	int ncols = model->ncols();
-	std::vector<double> xLb(ncols);
-	std::vector<double> xUb(ncols);
-	std::vector<char> xType(ncols);
+	xLb.resize(ncols);
+	xUb.resize(ncols);
+	xType.resize(ncols);
 	model->lbs(&xLb[0]);
 	model->ubs(&xUb[0]);
 	model->ctypes(&xType[0]);
+	classifyColumns();
+	ignoreGeneralIntegers(ignoreGeneralInt);
+}
+
+bool SimpleRounding::update(const ModelChanges& changes)
+{
+	// the integer lists change only if some variable gets fixed or unfixed
+	bool fixingsChanged = false;
+	for (unsigned int k = 0; k < changes.lbCols.size(); k++)
+	{
+		int j = changes.lbCols[k];
+		bool wasFixed = !different(xLb[j], xUb[j]);
+		xLb[j] = changes.lbValues[k];
+		fixingsChanged |= (wasFixed == different(xLb[j], xUb[j]));
+	}
+	for (unsigned int k = 0; k < changes.ubCols.size(); k++)
+	{
+		int j = changes.ubCols[k];
+		bool wasFixed = !different(xLb[j], xUb[j]);
+		xUb[j] = changes.ubValues[k];
+		fixingsChanged |= (wasFixed == different(xLb[j], xUb[j]));
+	}
+	if (fixingsChanged)
+	{
+		classifyColumns();
+		ignoreGeneralIntegers(ignoreGInt);
+	}
+	return true;
+}
+
+void SimpleRounding::classifyColumns()
+{
+	binaries.clear();
+	gintegers.clear();
+	integers.clear();
+	int ncols = xType.size();
 	for (int j = 0; j < ncols; j++)
 	{
 		if (different(xLb[j], xUb[j]))
@@ -71,11 +108,11 @@ void SimpleRounding::init(MIPModelPtr model, bool ignoreGeneralInt)
 			if (xType[j] == 'I') gintegers.push_back(j);
 		}
 	}
-	ignoreGeneralIntegers(ignoreGeneralInt);
 }
 
 void SimpleRounding::ignoreGeneralIntegers(bool flag)
 {
+	ignoreGInt = flag;
 	if (flag) integers = binaries;
 	else
 	{
@@ -109,15 +146,43 @@ void PropagatorRounding::readConfig()
 	SimpleRounding::readConfig();
 	std::string rankerName = gConfig().get("fp.ranker", std::string("FRAC"));
 	filterConstraints = gConfig().get("fp.filterConstraints", true);
-	consoleInfo("[config rounder]");
-	LOG_ITEM("fp.ranker", rankerName);
-	LOG_ITEM("fp.filterConstraints", filterConstraints);
+	rootPropWork = gConfig().get("fp.rootPropWork", 10);
+	prop.bulkThreads = gConfig().get("fp.propThreads", 1);
+	if (verbose)
+	{
+		consoleInfo("[config rounder]");
+		LOG_ITEM("fp.ranker", rankerName);
+		LOG_ITEM("fp.filterConstraints", filterConstraints);
+		LOG_ITEM("fp.rootPropWork", rootPropWork);
+		LOG_ITEM("fp.propThreads", prop.bulkThreads);
+	}
 	ranker = RankerPtr(RankerFactory::getInstance().create(rankerName));
 	ranker->readConfig();
+	// operators
+	std::list<std::string> rNames;
+	RankerFactory::getInstance().getIDs(std::back_insert_iterator< std::list<std::string> >(rNames));
+	rNames.remove(rankerName);
+	rNames.push_front(rankerName);
+	opRankers.assign(rNames.begin(), rNames.end());
+	opRankers.push_back("");
+	rankers.assign(opRankers.size(), nullptr);
+	rankers[0] = ranker;
+	for (unsigned int op = 1; op < opRankers.size(); op++)
+	{
+		if (opRankers[op].empty())  continue;
+		rankers[op] = RankerPtr(RankerFactory::getInstance().create(opRankers[op]));
+		rankers[op]->readConfig();
+	}
+	curOp = 0;
 }
 
 void PropagatorRounding::init(MIPModelPtr model, bool ignoreGeneralInt)
 {
+	// back to the configured operator (the others are initialized again on first use)
+	ranker = rankers[0];
+	curOp = 0;
+	rankerReady.assign(rankers.size(), false);
+	rankerReady[0] = true;
 	SimpleRounding::init(model, ignoreGeneralInt);
 	domain = std::make_shared<Domain>();
 	// add vars to domain
@@ -144,75 +209,246 @@ void PropagatorRounding::init(MIPModelPtr model, bool ignoreGeneralInt)
 	}
 
 	int filteredOut = 0;
-	for (int i = 0; i < model->nrows(); i++)
+	int nrows = model->nrows();
+	rows.resize(nrows);
+	cutoffRow = -1;
+	rowProp.assign(nrows, -1);
+	propRow.clear();
+	for (int i = 0; i < nrows; i++)
 	{
-		std::map<int, PropagatorFactoryPtr>::iterator itr = factories.begin();
-		std::map<int, PropagatorFactoryPtr>::iterator end = factories.end();
 		ConstraintPtr c = std::make_shared<Constraint>();
 		model->row(i, c->row, c->sense, c->rhs, c->range);
+		rows[i] = c;
 		// ignore nonbinding constraints
 		if (c->sense == 'N')  continue;
 		// constraint filter
-		if (filterConstraints)
+		if (filterConstraints && isFiltered(*c))
 		{
-			const int* idx = c->row.idx();
-			const double* coef = c->row.coef();
-			unsigned int size = c->row.size();
-			bool allCont = true;
-			double largest = std::numeric_limits<double>::min();
-			double smallest = std::numeric_limits<double>::max();
-			for (unsigned int k = 0; k < size; k++)
-			{
-				if (!domain->isVarFixed(idx[k]) && (domain->varType(idx[k]) != 'C'))
-				{
-					allCont = false;
-					break;
-				}
-				double tmp = fabs(coef[k]);
-				largest = std::max(largest, tmp);
-				smallest = std::min(smallest, tmp);
-			}
-			double dynamism = (largest / smallest);
-			if ((allCont && greaterThan(dynamism, 10.0)) || greaterThan(dynamism, 1000.0))
-			{
-				filteredOut++;
-				continue;
-			}
+			filteredOut++;
+			continue;
 		}
 		// try analyzers
-		while (itr != end)
-		{
-			PropagatorPtr p = itr->second->analyze(*(domain.get()), c.get());
-			if (p)
-			{
-				prop.pushPropagator(p);
-				break;
-			}
-			itr++;
-		}
+		setRowPropagator(i, createPropagator(c.get()));
 	}
 	// log prop stats
-	consoleInfo("[propagator stats]");
-	for (const auto& kv: factories)
+	if (verbose)
 	{
-		consoleLog("{}: {}", kv.second->getName(), kv.second->created());
+		consoleInfo("[propagator stats]");
+		for (const auto& kv: factories)
+		{
+			consoleLog("{}: {}", kv.second->getName(), kv.second->created());
+		}
+		consoleLog("#filtered out: {}\n", filteredOut);
 	}
-	consoleLog("#filtered out: {}\n", filteredOut);
 
-	// no initial propagation
-	// prop.propagate();
+	// root fixpoint: the dives start from there
+	if (rootFixpoint())  ranker->init(domain, ignoreGeneralInt);
 	state = prop.getStateMgr();
 	state->dump();
 }
 
+bool PropagatorRounding::update(const ModelChanges& changes)
+{
+	// back to the domain before the root propagation: a relaxing edit can invalidate the bounds it implied
+	bool fixingsChanged = false;
+	if (preRootState)
+	{
+		preRootState->restore();
+		// as on a fresh init, the root propagation starts from all the propagators
+		prop.schedulePropagators();
+		auto revert = [&](int j) {
+			bool wasFixed = !different(xLb[j], xUb[j]);
+			xLb[j] = domain->varLb(j);
+			xUb[j] = domain->varUb(j);
+			fixingsChanged |= (wasFixed == different(xLb[j], xUb[j]));
+		};
+		for (int j: rootChanges.lbCols)  revert(j);
+		for (int j: rootChanges.ubCols)  revert(j);
+		rootChanges.clear();
+		if (fixingsChanged)
+		{
+			classifyColumns();
+			ignoreGeneralIntegers(ignoreGInt);
+		}
+	}
+	else state->restore();
+	SimpleRounding::update(changes);
+	// patch the domain and collect the rows whose propagators must be rebuilt
+	// (propagators cache activities computed from the bounds at creation time)
+	std::vector<int> dirtyRows;
+	// the cutoff propagator (if any) was created after the root propagation
+	if (preRootState && (cutoffRow >= 0))  dirtyRows.push_back(cutoffRow);
+	auto touchVar = [&](int j, double l, double u) {
+		bool wasFixed = domain->isVarFixed(j);
+		domain->resetBounds(j, l, u);
+		fixingsChanged |= (wasFixed != domain->isVarFixed(j));
+		for (const AdvisorPtr& adv: prop.getAdvisors(j))  dirtyRows.push_back(propRow[adv->getPropagator().getID()]);
+	};
+	for (unsigned int k = 0; k < changes.lbCols.size(); k++)
+	{
+		int j = changes.lbCols[k];
+		touchVar(j, changes.lbValues[k], domain->varUb(j));
+	}
+	for (unsigned int k = 0; k < changes.ubCols.size(); k++)
+	{
+		int j = changes.ubCols[k];
+		touchVar(j, domain->varLb(j), changes.ubValues[k]);
+	}
+	for (unsigned int k = 0; k < changes.rhsRows.size(); k++)
+	{
+		int i = changes.rhsRows[k];
+		rows[i]->rhs = changes.rhsValues[k];
+		dirtyRows.push_back(i);
+	}
+	std::sort(dirtyRows.begin(), dirtyRows.end());
+	dirtyRows.erase(std::unique(dirtyRows.begin(), dirtyRows.end()), dirtyRows.end());
+	// rebuild the affected propagators (the analyzer might change as well)
+	// note: the constraint filter is re-evaluated only for the affected rows
+	for (int i: dirtyRows)
+	{
+		Constraint* c = rows[i].get();
+		PropagatorPtr p;
+		if ((c->sense != 'N') && !(filterConstraints && isFiltered(*c)))  p = createPropagator(c);
+		setRowPropagator(i, p);
+	}
+	fixingsChanged |= rootFixpoint();
+	if (fixingsChanged)
+	{
+		for (unsigned int op = 0; op < rankers.size(); op++)
+		{
+			if (rankerReady[op])  rankers[op]->init(domain, ignoreGInt);
+		}
+	}
+	consoleDebug(DebugLevel::Verbose, "propround update: #rebuilt={}", dirtyRows.size());
+	// new root state
+	state = prop.getStateMgr();
+	state->dump();
+	return true;
+}
+
+bool PropagatorRounding::rootFixpoint()
+{
+	rootChanges.clear();
+	preRootState.reset();
+	if (rootPropWork <= 0)  return false;
+	StopWatch watch(true);
+	StatePtr before = prop.getStateMgr();
+	before->dump();
+	uint64_t calls = prop.getStats().propagatorCalls;
+	uint64_t workLimit = (uint64_t)rootPropWork * std::max((int)propRow.size(), 1);
+	if (!prop.fixpoint(workLimit))
+	{
+		// infeasible: keep the original bounds and let the dives (and the LP) find out
+		before->restore();
+		consoleDebug(DebugLevel::Verbose, "propround rootFixpoint: infeasible");
+		return false;
+	}
+	calls = prop.getStats().propagatorCalls - calls;
+	preRootState = before;
+	// integer bounds only: implied bounds on continuous variables are not worth the LP degeneracy
+	bool fixingsChanged = false;
+	int ncols = xType.size();
+	for (int j = 0; j < ncols; j++)
+	{
+		if (xType[j] == 'C')  continue;
+		bool wasFixed = !different(xLb[j], xUb[j]);
+		if (greaterThan(domain->varLb(j), xLb[j]))
+		{
+			xLb[j] = domain->varLb(j);
+			rootChanges.lb(j, xLb[j]);
+		}
+		if (lessThan(domain->varUb(j), xUb[j]))
+		{
+			xUb[j] = domain->varUb(j);
+			rootChanges.ub(j, xUb[j]);
+		}
+		fixingsChanged |= (wasFixed == different(xLb[j], xUb[j]));
+	}
+	if (fixingsChanged)
+	{
+		classifyColumns();
+		ignoreGeneralIntegers(ignoreGInt);
+	}
+	if (verbose)
+	{
+		consoleLog("rootPropCalls = {} rootPropLimitHit = {}", calls, (calls >= workLimit));
+		consoleLog("rootTightenedLbs = {} rootTightenedUbs = {}", rootChanges.lbCols.size(), rootChanges.ubCols.size());
+		consoleLog("rootPropTime = {}", watch.getTotal());
+	}
+	return fixingsChanged;
+}
+
+bool PropagatorRounding::isFiltered(const Constraint& c) const
+{
+	// filter out constraints with a large dynamism (and all continuous ones with a moderate one)
+	const int* idx = c.row.idx();
+	const double* coef = c.row.coef();
+	unsigned int size = c.row.size();
+	bool allCont = true;
+	double largest = std::numeric_limits<double>::min();
+	double smallest = std::numeric_limits<double>::max();
+	for (unsigned int k = 0; k < size; k++)
+	{
+		if (!domain->isVarFixed(idx[k]) && (domain->varType(idx[k]) != 'C'))
+		{
+			allCont = false;
+			break;
+		}
+		double tmp = fabs(coef[k]);
+		largest = std::max(largest, tmp);
+		smallest = std::min(smallest, tmp);
+	}
+	double dynamism = (largest / smallest);
+	return ((allCont && greaterThan(dynamism, 10.0)) || greaterThan(dynamism, 1000.0));
+}
+
+PropagatorPtr PropagatorRounding::createPropagator(Constraint* c)
+{
+	// try analyzers in order of priority
+	for (const auto& kv: factories)
+	{
+		PropagatorPtr p = kv.second->analyze(*(domain.get()), c);
+		if (p)  return p;
+	}
+	return nullptr;
+}
+
+void PropagatorRounding::setRowPropagator(int i, PropagatorPtr p)
+{
+	int id = rowProp[i];
+	if (id >= 0)
+	{
+		prop.replacePropagator(id, p);
+		if (!p)
+		{
+			propRow[id] = -1;
+			rowProp[i] = -1;
+		}
+	}
+	else if (p)
+	{
+		prop.pushPropagator(p);
+		rowProp[i] = p->getID();
+		propRow.push_back(i);
+	}
+}
+
 void PropagatorRounding::ignoreGeneralIntegers(bool flag)
 {
 	SimpleRounding::ignoreGeneralIntegers(flag);
-	ranker->ignoreGeneralIntegers(flag);
+	for (unsigned int op = 0; op < rankers.size(); op++)
+	{
+		if (rankerReady[op])  rankers[op]->ignoreGeneralIntegers(flag);
+	}
 }
 
 void PropagatorRounding::apply(const std::vector<double>& in, std::vector<double>& out)
 {
+	if (!ranker)
+	{
+		SimpleRounding::apply(in, out);
+		return;
+	}
 	copy(in.begin(), in.end(), out.begin());
 	state->restore();
 	double t = getRoundingThreshold(randomizedRounding, roundGen);
@@ -239,12 +475,61 @@ void PropagatorRounding::apply(const std::vector<double>& in, std::vector<double
 	}
 }
 
+void PropagatorRounding::objectiveCutoff(ConstraintPtr cutoff)
+{
+	if ((cutoffRow < 0) && !cutoff)  return;
+	// back to the root domain
+	state->restore();
+	if (cutoffRow < 0)
+	{
+		rows.push_back(cutoff);
+		rowProp.push_back(-1);
+		cutoffRow = rows.size() - 1;
+	}
+	// the cutoff is never filtered out: it is the only way to steer the rounding towards better solutions
+	setRowPropagator(cutoffRow, cutoff ? createPropagator(cutoff.get()) : nullptr);
+	if (cutoff)  rows[cutoffRow] = cutoff;
+	else
+	{
+		rows.pop_back();
+		rowProp.pop_back();
+		cutoffRow = -1;
+	}
+	// new root state
+	state = prop.getStateMgr();
+	state->dump();
+}
+
+std::string PropagatorRounding::operatorName(int op) const
+{
+	DOMINIQS_ASSERT( (op >= 0) && (op < (int)opRankers.size()) );
+	return opRankers[op].empty() ? std::string("std") : ("prop" + opRankers[op]);
+}
+
+void PropagatorRounding::setOperator(int op)
+{
+	DOMINIQS_ASSERT( (op >= 0) && (op < (int)opRankers.size()) );
+	curOp = op;
+	ranker = rankers[op];
+	if (ranker && !rankerReady[op])
+	{
+		ranker->init(domain, ignoreGInt);
+		rankerReady[op] = true;
+	}
+}
+
 void PropagatorRounding::clear()
 {
 	// clear
 	// delete state;
 	prop.clear();
 	factories.clear();
+	rows.clear();
+	rowProp.clear();
+	propRow.clear();
+	cutoffRow = -1;
+	preRootState.reset();
+	rootChanges.clear();
 }
 
 // auto registration
@@ -0,0 +1,195 @@
+/**
+ * @file wscache.cpp
+ * @brief Persistent on-disk cache of warm start information
+ */
+
+#include "feaspump/wscache.h"
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <functional>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include <utils/maths.h>
+#include <utils/path.h>
+#include <fmt/format.h>
+
+using namespace dominiqs;
+
+static const char WS_MAGIC[] = "FPWS0001";
+static const size_t WS_MAGIC_LEN = 8;
+static const char WS_EXT[] = ".ws";
+
+
+void WarmStart::clear()
+{
+	cstat.clear();
+	rstat.clear();
+	closestPoint.clear();
+	incumbent.clear();
+}
+
+
+uint64_t modelSignature(const MIPModelI& model)
+{
+	int n = model.ncols();
+	int m = model.nrows();
+	std::size_t seed = 0;
+	hash_combine(seed, n);
+	hash_combine(seed, m);
+	if (n)
+	{
+		std::vector<char> ctype(n);
+		model.ctypes(&ctype[0]);
+		hash_range(seed, ctype.begin(), ctype.end());
+	}
+	if (m)
+	{
+		std::vector<char> sense(m);
+		model.sense(&sense[0]);
+		hash_range(seed, sense.begin(), sense.end());
+		SparseMatrix matrix;
+		model.rows(matrix);
+		hash_range(seed, matrix.matbeg.begin(), matrix.matbeg.begin() + matrix.k);
+		hash_range(seed, matrix.matind.begin(), matrix.matind.begin() + matrix.nnz);
+	}
+	return seed;
+}
+
+
+template<typename T>
+static void writeVector(std::ostream& out, const std::vector<T>& v)
+{
+	int n = v.size();
+	out.write((const char*)&n, sizeof(int));
+	if (n)  out.write((const char*)v.data(), sizeof(T) * n);
+}
+
+template<typename T>
+static bool readVector(std::istream& in, std::vector<T>& v, int expected)
+{
+	int n = 0;
+	in.read((char*)&n, sizeof(int));
+	if (!in || ((n != 0) && (n != expected)))  return false;
+	v.resize(n);
+	if (n)  in.read((char*)v.data(), sizeof(T) * n);
+	return (bool)in;
+}
+
+
+WarmStartCache::WarmStartCache(const std::string& _dir, uint64_t _maxSize) : dir(_dir), maxSize(_maxSize)
+{
+	Path(dir).mkdir(true);
+}
+
+
+bool WarmStartCache::load(uint64_t key, int ncols, int nrows, WarmStart& ws) const
+{
+	ws.clear();
+	std::string path = entryPath(key);
+	std::ifstream in(path, std::ios::binary);
+	if (!in)  return false;
+	char magic[WS_MAGIC_LEN];
+	in.read(magic, WS_MAGIC_LEN);
+	if (!in || strncmp(magic, WS_MAGIC, WS_MAGIC_LEN))  return false;
+	int n = 0;
+	int m = 0;
+	in.read((char*)&n, sizeof(int));
+	in.read((char*)&m, sizeof(int));
+	// hash collision or corrupted entry
+	if (!in || (n != ncols) || (m != nrows))  return false;
+	if (!readVector(in, ws.cstat, n) || !readVector(in, ws.rstat, m)
+		|| !readVector(in, ws.closestPoint, n) || !readVector(in, ws.incumbent, n))
+	{
+		ws.clear();
+		return false;
+	}
+	// a basis is either complete or absent
+	if (ws.cstat.empty() != ws.rstat.empty())
+	{
+		ws.cstat.clear();
+		ws.rstat.clear();
+	}
+	// mark as recently used
+	utime(path.c_str(), nullptr);
+	return true;
+}
+
+
+void WarmStartCache::store(uint64_t key, int ncols, int nrows, const WarmStart& ws)
+{
+	std::string path = entryPath(key);
+	// unique per process and thread: concurrent stores of the same key (e.g., in fp_batch) do not share it
+	std::string tmpPath = fmt::format("{}.{}.{:x}.tmp", path, getpid(), std::hash<std::thread::id>()(std::this_thread::get_id()));
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out)  throw std::runtime_error(fmt::format("Cannot write warm start cache entry {}", tmpPath));
+		out.write(WS_MAGIC, WS_MAGIC_LEN);
+		out.write((const char*)&ncols, sizeof(int));
+		out.write((const char*)&nrows, sizeof(int));
+		writeVector(out, ws.cstat);
+		writeVector(out, ws.rstat);
+		writeVector(out, ws.closestPoint);
+		writeVector(out, ws.incumbent);
+		// a short write (e.g., disk full) must not replace a good entry
+		out.close();
+		if (!out.good())
+		{
+			unlink(tmpPath.c_str());
+			throw std::runtime_error(fmt::format("Cannot write warm start cache entry {}", tmpPath));
+		}
+	}
+	// atomic replace
+	if (rename(tmpPath.c_str(), path.c_str()))
+	{
+		unlink(tmpPath.c_str());
+		throw std::runtime_error(fmt::format("Cannot write warm start cache entry {}", path));
+	}
+	evict();
+}
+
+
+std::string WarmStartCache::entryPath(uint64_t key) const
+{
+	return fmt::format("{}/{:016x}{}", dir, key, WS_EXT);
+}
+
+
+void WarmStartCache::evict()
+{
+	struct Entry
+	{
+		std::string path;
+		uint64_t size;
+		time_t lastUse;
+	};
+	std::vector<Entry> entries;
+	uint64_t totSize = 0;
+	DIR* d = opendir(dir.c_str());
+	if (!d)  return;
+	size_t extLen = strlen(WS_EXT);
+	while (struct dirent* e = readdir(d))
+	{
+		std::string name = e->d_name;
+		if ((name.size() <= extLen) || name.compare(name.size() - extLen, extLen, WS_EXT))  continue;
+		std::string path = dir + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st))  continue;
+		entries.push_back(Entry{path, (uint64_t)st.st_size, st.st_mtime});
+		totSize += st.st_size;
+	}
+	closedir(d);
+	if (totSize <= maxSize)  return;
+	// least recently used first
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+	for (const Entry& e: entries)
+	{
+		if (totSize <= maxSize)  break;
+		if (!unlink(e.path.c_str()))  totSize -= e.size;
+	}
+}
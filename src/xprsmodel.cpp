@@ -11,10 +11,13 @@
 #include <cstring>
 #include <climits>
 #include <numeric>
+#include <atomic>
 #include <fmt/format.h>
+#include <utils/consolelog.h>
 
 
 XPRSprob probSignalHandler = nullptr;
+static std::atomic<bool> objLowerLimitWarned(false);
 
 static void userSignalBreak(int signum)
 {
@@ -111,6 +114,7 @@ void XPRSModel::writeSol(const std::string& filename) const
 void XPRSModel::lpopt(char method)
 {
 	DOMINIQS_ASSERT(prob);
+	if (skipInterrupted())  return;
 	switch(method)
 	{
 		case 'S': XPRS_CALL(XPRSlpoptimize, prob, "pdn"); break;
@@ -125,6 +129,7 @@ void XPRSModel::lpopt(char method)
 void XPRSModel::mipopt()
 {
 	DOMINIQS_ASSERT(prob);
+	if (skipInterrupted())  return;
 	XPRS_CALL(XPRSmipoptimize, prob, "");
 }
 
@@ -239,6 +244,29 @@ bool XPRSModel::isPrimalFeas() const
 }
 
 
+/* Basis */
+bool XPRSModel::getBasis(std::vector<int>& cstat, std::vector<int>& rstat) const
+{
+	DOMINIQS_ASSERT(prob);
+	int lpstat = 0;
+	XPRS_CALL(XPRSgetintattrib, prob, XPRS_LPSTATUS, &lpstat);
+	if (lpstat == XPRS_LP_UNSTARTED)  return false;
+	// XPRESS status codes (lower, basic, upper, superbasic) match ours
+	cstat.resize(ncols());
+	rstat.resize(nrows());
+	XPRS_CALL(XPRSgetbasis, prob, rstat.data(), cstat.data());
+	return true;
+}
+
+
+void XPRSModel::setBasis(const std::vector<int>& cstat, const std::vector<int>& rstat)
+{
+	DOMINIQS_ASSERT(prob);
+	DOMINIQS_ASSERT((int)cstat.size() == ncols() && (int)rstat.size() == nrows());
+	XPRS_CALL(XPRSloadbasis, prob, rstat.data(), cstat.data());
+}
+
+
 /* Parameters */
 void XPRSModel::handleCtrlC(bool flag)
 {
@@ -268,6 +296,31 @@ bool XPRSModel::aborted() const
 }
 
 
+void XPRSModel::interrupt()
+{
+	DOMINIQS_ASSERT(prob);
+	interrupted = true;
+	XPRSinterrupt(prob, XPRS_STOP_USER);
+}
+
+
+void XPRSModel::armInterrupt()
+{
+	interrupted = false;
+	armed = true;
+}
+
+
+bool XPRSModel::skipInterrupted()
+{
+	// XPRSinterrupt() has no effect on a solve that has not started yet: an interrupt
+	// received after armInterrupt() skips the solve instead
+	bool skip = armed && interrupted;
+	armed = false;
+	return skip;
+}
+
+
 void XPRSModel::seed(int seed)
 {
 	DOMINIQS_ASSERT(prob);
@@ -302,6 +355,10 @@ int XPRSModel::intParam(IntParam which) const
 		case IntParam::IterLimit:
 			XPRS_CALL(XPRSgetintcontrol, prob, XPRS_LPITERLIMIT, &value);
 			break;
+		case IntParam::Crossover:
+			XPRS_CALL(XPRSgetintcontrol, prob, XPRS_CROSSOVER, &value);
+			value = (value != 0);
+			break;
 		default:
 			throw std::runtime_error("Unknown integer parameter");
 	}
@@ -328,6 +385,10 @@ void XPRSModel::intParam(IntParam which, int value)
 		case IntParam::IterLimit:
 			XPRS_CALL(XPRSsetintcontrol, prob, XPRS_LPITERLIMIT, value);
 			break;
+		case IntParam::Crossover:
+			// -1 = automatic (default), 0 = no crossover
+			XPRS_CALL(XPRSsetintcontrol, prob, XPRS_CROSSOVER, value ? -1 : 0);
+			break;
 		default:
 			throw std::runtime_error("Unknown integer parameter");
 	}
@@ -352,6 +413,12 @@ double XPRSModel::dblParam(DblParam which) const
 		case DblParam::IntegralityTolerance:
 			XPRS_CALL(XPRSgetdblcontrol, prob, XPRS_MIPTOL, &value);
 			break;
+		case DblParam::ObjLowerLimit:
+			value = objLowerLimit;
+			break;
+		case DblParam::ObjUpperLimit:
+			XPRS_CALL(XPRSgetdblcontrol, prob, XPRS_MIPABSCUTOFF, &value);
+			break;
 		default:
 			throw std::runtime_error("Unknown double parameter");
 	}
@@ -377,6 +444,18 @@ void XPRSModel::dblParam(DblParam which, double value)
 		case DblParam::IntegralityTolerance:
 			XPRS_CALL(XPRSsetdblcontrol, prob, XPRS_MIPTOL, value);
 			break;
+		case DblParam::ObjLowerLimit:
+			// no equivalent control in Xpress: the value is only stored, and the LPs do not stop early
+			objLowerLimit = value;
+			if ((value > -1e20) && !objLowerLimitWarned.exchange(true))
+			{
+				dominiqs::consoleWarn("ObjLowerLimit is not supported by Xpress: LPs will not stop at the lower limit");
+			}
+			break;
+		case DblParam::ObjUpperLimit:
+			// the cutoff also stops the dual simplex (LP status "cutoff in dual")
+			XPRS_CALL(XPRSsetdblcontrol, prob, XPRS_MIPABSCUTOFF, value);
+			break;
 		default:
 			throw std::runtime_error("Unknown double parameter");
 	}
@@ -781,6 +860,52 @@ void XPRSModel::addRow(const std::string& name, const int* idx, const double* va
 }
 
 
+void XPRSModel::addEmptyCols(int cnt, const std::vector<std::string>& names, const char* ctypes, const double* lbs, const double* ubs, const double* objs)
+{
+	DOMINIQS_ASSERT(prob);
+	if (cnt <= 0)  return;
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	int first = ncols();
+	std::vector<int> matbeg(cnt, 0);
+	XPRS_CALL(XPRSaddcols, prob, cnt, 0, objs, &matbeg[0], nullptr, nullptr, lbs, ubs);
+
+	std::vector<int> intIdx;
+	std::vector<char> intType;
+	for (int k = 0; k < cnt; k++)
+	{
+		if (ctypes[k] == 'C')  continue;
+		intIdx.push_back(first + k);
+		intType.push_back(ctypes[k]);
+	}
+	if (intIdx.size())  XPRS_CALL(XPRSchgcoltype, prob, intIdx.size(), &intIdx[0], &intType[0]);
+
+	if (names.size())
+	{
+		// names are passed as a single buffer of null terminated strings
+		std::vector<char> buffer;
+		for (const std::string& name: names)  buffer.insert(buffer.end(), name.c_str(), name.c_str() + name.size() + 1);
+		XPRS_CALL(XPRSaddnames, prob, 2, &buffer[0], first, first + cnt - 1);
+	}
+}
+
+
+void XPRSModel::addRows(int cnt, const std::vector<std::string>& names, const int* beg, const int* idx, const double* val, const char* senses, const double* rhss, const double* rngvals)
+{
+	DOMINIQS_ASSERT(prob);
+	if (cnt <= 0)  return;
+	DOMINIQS_ASSERT(names.empty() || ((int)names.size() == cnt));
+	int first = nrows();
+	XPRS_CALL(XPRSaddrows, prob, cnt, beg[cnt], senses, rhss, rngvals, beg, idx, val);
+
+	if (names.size())
+	{
+		std::vector<char> buffer;
+		for (const std::string& name: names)  buffer.insert(buffer.end(), name.c_str(), name.c_str() + name.size() + 1);
+		XPRS_CALL(XPRSaddnames, prob, 1, &buffer[0], first, first + cnt - 1);
+	}
+}
+
+
 void XPRSModel::delRow(int ridx)
 {
 	DOMINIQS_ASSERT(prob);
@@ -823,6 +948,14 @@ void XPRSModel::delCols(int first, int last)
 }
 
 
+void XPRSModel::delRowSet(int cnt, const int* rows)
+{
+	DOMINIQS_ASSERT(prob);
+	if (cnt <= 0)  return;
+	XPRS_CALL(XPRSdelrows, prob, cnt, rows);
+}
+
+
 void XPRSModel::objSense(ObjSense objsen)
 {
 	DOMINIQS_ASSERT(prob);
@@ -897,6 +1030,14 @@ void XPRSModel::objcoefs(int cnt, const int* cols, const double* values)
 }
 
 
+void XPRSModel::rhs(int cnt, const int* rows, const double* values)
+{
+	DOMINIQS_ASSERT(prob);
+	// XPRESS ranged rows are [rhs-range,rhs] and changing the rhs keeps the range
+	XPRS_CALL(XPRSchgrhs, prob, cnt, rows, values);
+}
+
+
 void XPRSModel::ctype(int cidx, char val)
 {
 	DOMINIQS_ASSERT(prob);
@@ -927,10 +1068,18 @@ XPRSModel* XPRSModel::clone_impl() const
 	std::unique_ptr<XPRSModel> cloned(new XPRSModel());
 	XPRS_CALL(XPRScopyprob, cloned->prob, prob, "cloned");
 	XPRS_CALL(XPRScopycontrols, cloned->prob, prob);
+	cloned->objLowerLimit = objLowerLimit;
 	return cloned.release();
 }
 
 
+XPRSModel* XPRSModel::concurrentclone_impl() const
+{
+	// every problem has its own controls and interrupt: a plain clone can run concurrently
+	return clone_impl();
+}
+
+
 XPRSModel* XPRSModel::presolvedmodel_impl()
 {
 	DOMINIQS_ASSERT(prob);